@@ -44,6 +44,7 @@ www.navitia.io
 #include "type/geographical_coord.h"
 #include "type/fwd_type.h"
 #include "utils/functions.h"
+#include "autocomplete/dictionary.h"
 
 namespace navitia {
 namespace autocomplete {
@@ -58,7 +59,7 @@ struct Compare {
     }
 };
 
-std::pair<size_t, size_t> longest_common_substring(const std::string&, const std::string&);
+std::pair<size_t, size_t> longest_common_substring(boost::string_ref, boost::string_ref);
 
 using autocomplete_map = std::map<std::string, std::string, Compare>;
 /** Map de type Autocomplete
@@ -104,23 +105,21 @@ struct Autocomplete {
     /// Structure temporaire pour construire l'indexe
     std::map<std::string, std::set<T> > temp_word_map;
 
-    /// À chaque mot (par exemple "rue" ou "jaures") on associe un tableau de T qui contient la liste des éléments
-    /// contenant ce mot
-    typedef std::pair<std::string, std::vector<T> > vec_elt;
-
+    /// À chaque mot (par exemple "rue" ou "jaures") on associe la liste des éléments contenant ce mot
     /// Structure principale de notre indexe
-    std::vector<vec_elt> word_dictionnary;
+    PostingDictionary<T> word_dictionnary;
 
     /// Structure temporaire pour garder les patterns et leurs indexs
     std::map<std::string, std::set<T> > temp_pattern_map;
-    std::vector<vec_elt> pattern_dictionnary;
+    PostingDictionary<T> pattern_dictionnary;
 
     /// Structure pour garder les informations comme nombre des mots, la distance des mots...dans chaque Autocomplete
-    /// (Position)
-    std::map<T, word_quality> word_quality_list;
+    /// (indexée par la position)
+    std::vector<word_quality> word_quality_list;
 
     // for each T, we store the originaly indexed string (for better score handling)
-    std::map<T, std::string> indexed_string;
+    std::vector<std::string> temp_indexed_string;
+    FlatStrings<T> indexed_string;
 
     template <class Archive>
     void serialize(Archive& ar, const unsigned int) {
@@ -134,6 +133,7 @@ struct Autocomplete {
         temp_pattern_map.clear();
         pattern_dictionnary.clear();
         word_quality_list.clear();
+        temp_indexed_string.clear();
         indexed_string.clear();
     }
 
@@ -165,8 +165,12 @@ struct Autocomplete {
         wc.word_count = count;
         wc.word_distance = distance;
         wc.score = 0;
+        if (word_quality_list.size() <= size_t(position)) {
+            word_quality_list.resize(position + 1);
+            temp_indexed_string.resize(position + 1);
+        }
         word_quality_list[position] = wc;
-        indexed_string[position] = strip_accents_and_lower(str);
+        temp_indexed_string[position] = strip_accents_and_lower(str);
     }
 
     void add_vec_pattern(const std::set<std::string>& vec_words, T position) {
@@ -201,56 +205,44 @@ struct Autocomplete {
     /** Construit la structure finale
      *
      * Les map et les set sont bien pratiques, mais leurs performances sont mauvaises avec des petites données (comme
-     * des ints)
+     * des ints), elles sont vidées une fois les dictionnaires construits
      */
     void build() {
-        word_dictionnary.reserve(temp_word_map.size());
-        for (auto key_val : temp_word_map) {
-            word_dictionnary.push_back(
-                std::make_pair(key_val.first, std::vector<T>(key_val.second.begin(), key_val.second.end())));
+        word_dictionnary.clear();
+        for (const auto& key_val : temp_word_map) {
+            word_dictionnary.add(key_val.first, key_val.second);
         }
+        word_dictionnary.shrink_to_fit();
+        temp_word_map.clear();
 
         // Dictionnaire des patterns:
-        pattern_dictionnary.reserve((temp_pattern_map.size()));
-        for (auto key_val : temp_pattern_map) {
-            pattern_dictionnary.push_back(
-                std::make_pair(key_val.first, std::vector<T>(key_val.second.begin(), key_val.second.end())));
+        pattern_dictionnary.clear();
+        for (const auto& key_val : temp_pattern_map) {
+            pattern_dictionnary.add(key_val.first, key_val.second);
         }
+        pattern_dictionnary.shrink_to_fit();
+        temp_pattern_map.clear();
+
+        indexed_string.assign(temp_indexed_string);
+        temp_indexed_string.clear();
+        temp_indexed_string.shrink_to_fit();
+        word_quality_list.shrink_to_fit();
     }
 
     // Méthode pour calculer le score de chaque élément par son admin.
     void compute_score(type::PT_Data& pt_data, georef::GeoRef& georef, const type::Type_e type);
     // Méthodes premettant de retrouver nos éléments
-    /** Définit un fonctor permettant de parcourir notre structure un peu particulière */
-    struct comp {
-        /** Utilisé pour trouver la borne inf. Quand on cherche av, on veux que avenue soit également trouvé
-         * Il faut donc que "av" < "avenue" soit false
-         */
-        bool operator()(const std::string& a, const std::pair<std::string, std::vector<T> >& b) {
-            if (b.first.find(a) == 0)
-                return false;
-            return (a < b.first);
-        }
-
-        /** Utilisé pour la borne sup. Ici rien d'extraordinaire */
-        bool operator()(const std::pair<std::string, std::vector<T> >& b, const std::string& a) {
-            return (b.first < a);
-        }
-    };
-
     /** Retrouve toutes les positions des élements contenant le mot des mots qui commencent par token */
-    std::vector<T> match(const std::string& token, const std::vector<vec_elt>& vec_source) const {
-        // Les éléments dans vec_map sont triés par ordre alphabétiques, il suffit donc de trouver la borne inf et sup
-        auto lower = std::lower_bound(vec_source.begin(), vec_source.end(), token, comp());
-        auto upper = std::upper_bound(vec_source.begin(), vec_source.end(), token, comp());
+    std::vector<T> match(const std::string& token, const PostingDictionary<T>& dictionary) const {
+        // Les mots sont triés par ordre alphabétiques, il suffit donc de trouver la borne inf et sup
+        const auto range = dictionary.prefix_range(token);
 
         std::vector<T> result;
 
-        // On concatène tous les indexes
+        // On concatène tous les indexes, décodés directement dans le résultat
         // Pour les raisons de perfs mesurées expérimentalement, on accepte des doublons
-        for (; lower != upper; ++lower) {
-            std::vector<T> other = lower->second;
-            result.insert(result.end(), other.begin(), other.end());
+        for (auto i = range.first; i != range.second; ++i) {
+            dictionary.for_each_element(i, [&](T elt) { result.push_back(elt); });
         }
         return result;
     }
@@ -335,7 +327,7 @@ struct Autocomplete {
     std::tuple<int, size_t, int> compute_result_scores(const std::string& str, T position) const {
         auto global_score = word_quality_list.at(position).score;
 
-        const auto& indexed_str = indexed_string.at(position);
+        const auto indexed_str = indexed_string.at(position);
         auto lcs_and_pos = longest_common_substring(strip_accents_and_lower(str), indexed_str);
 
         return std::make_tuple(global_score, lcs_and_pos.first,
@@ -383,74 +375,107 @@ struct Autocomplete {
                                                 std::function<bool(T)> keep_element,
                                                 int word_length) const;
 
-    /** Recherche des patterns les plus proche : faute de frappe */
+    /** Recherche des patterns les plus proche : faute de frappe
+     *
+     * An element is kept if it is found by at least 75% of the 2-grams
+     * of str. The posting lists of the 2-grams are walked together in
+     * increasing order of elements:
+     *  - an element found by at least min_found lists among n is in at
+     *    least one of any n - min_found + 1 lists, so only the shortest
+     *    of them give the candidates, the others being only checked
+     *  - only the nbmax best qualities are kept in a bounded heap, and
+     *    the scores are computed for them only
+     */
     std::vector<fl_quality> find_partial_with_pattern(const std::string& str,
                                                       const int word_weight,
                                                       size_t nbmax,
                                                       std::function<bool(T)> keep_element,
                                                       const std::set<std::string>& ghostwords) const {
-        // Map temporaire pour garder les patterns trouvé:
-        std::unordered_map<T, fl_quality> fl_result;
-
-        // Vector temporaire des indexs
-        std::vector<T> index_result;
-
-        // Créer un vector de réponse
-        std::vector<fl_quality> vec_quality;
-        fl_quality quality;
-
         auto vec_word = tokenize(str, ghostwords);
         std::vector<std::string> vec_pattern = make_vec_pattern(vec_word, 2);  // 2-grams
-        int wordLength = words_length(vec_word);
-        int pattern_count = vec_pattern.size();
-
-        // recherche pour le premier pattern:
-        auto vec = vec_pattern.begin();
-        if (vec != vec_pattern.end()) {
-            // Premier résultat:
-            index_result = match(*vec, pattern_dictionnary);
-
-            // Incrémenter la propriété "nb_found" pour chaque index des mots autocomplete dans vec_map
-            add_word_quality(fl_result, index_result);
-
-            // Recherche des mots qui restent
-            for (++vec; vec != vec_pattern.end(); ++vec) {
-                index_result = match(*vec, pattern_dictionnary);
-
-                // For each match of n-gram pattern word 1 is added to "nb_found"
-                add_word_quality(fl_result, index_result);
+        if (vec_pattern.empty() || nbmax == 0) {
+            return {};
+        }
+        const int wordLength = words_length(vec_word);
+        const int pattern_count = vec_pattern.size();
+
+        // For each match of n-gram pattern word 1 is added to "nb_found", so
+        // we have one list by word matching each pattern
+        using Cursor = typename PostingDictionary<T>::Cursor;
+        std::vector<Cursor> cursors;
+        for (const auto& pattern : vec_pattern) {
+            const auto range = pattern_dictionnary.prefix_range(pattern);
+            for (auto i = range.first; i != range.second; ++i) {
+                cursors.push_back(pattern_dictionnary.cursor(i));
             }
+        }
 
-            // Compute de highest score of objects found
-            int max_score = 0;
-            for (auto ir : index_result) {
+        // Compute de highest score of objects found by the last pattern
+        int max_score = 0;
+        const auto last_range = pattern_dictionnary.prefix_range(vec_pattern.back());
+        for (auto i = last_range.first; i != last_range.second; ++i) {
+            pattern_dictionnary.for_each_element(i, [&](T ir) {
                 if (keep_element(ir)) {
-                    max_score = word_quality_list.at(ir).score > max_score ? word_quality_list.at(ir).score : max_score;
+                    max_score = std::max(max_score, word_quality_list.at(ir).score);
                 }
-            }
+            });
+        }
 
-            // Here we keep object with match of patternized words >= 75%
-            for (auto pair : fl_result) {
-                if (keep_element(pair.first)
-                    && (((pattern_count - pair.second.nb_found) * 100) / pattern_count <= 25)) {
-                    quality.idx = pair.first;
-                    quality.nb_found = pair.second.nb_found;
-                    quality.word_len = wordLength;
-                    quality.scores = this->compute_result_scores(str, quality.idx);
-                    quality.quality = calc_quality_pattern(quality, word_weight, max_score, pattern_count);
-                    vec_quality.push_back(quality);
+        // Here we keep object with match of patternized words >= 75%
+        int min_found = 1;
+        while (((pattern_count - min_found) * 100) / pattern_count > 25) {
+            ++min_found;
+        }
+        if (size_t(min_found) > cursors.size()) {
+            return {};
+        }
+        std::sort(cursors.begin(), cursors.end(),
+                  [](const Cursor& a, const Cursor& b) { return a.nb_bytes < b.nb_bytes; });
+        const auto essential_end = cursors.begin() + (cursors.size() - min_found + 1);
+
+        // min heap on the quality, the worst kept element being at the front
+        std::vector<fl_quality> best;
+        best.reserve(nbmax);
+        const auto worse = [](const fl_quality& a, const fl_quality& b) { return a.quality > b.quality; };
+        while (true) {
+            const Cursor* candidate = nullptr;
+            for (auto it = cursors.begin(); it != essential_end; ++it) {
+                if (!it->at_end && (!candidate || it->elt < candidate->elt)) {
+                    candidate = &*it;
                 }
             }
+            if (!candidate) {
+                break;
+            }
+            fl_quality quality;
+            quality.idx = candidate->elt;
+            for (auto& c : cursors) {
+                c.advance_to(quality.idx);
+                if (!c.at_end && c.elt == quality.idx) {
+                    ++quality.nb_found;
+                    c.next();
+                }
+            }
+            if (quality.nb_found < min_found || !keep_element(quality.idx)) {
+                continue;
+            }
+            quality.word_len = wordLength;
+            quality.quality = calc_quality_pattern(quality, word_weight, max_score, pattern_count);
+            if (best.size() < nbmax) {
+                best.push_back(quality);
+                std::push_heap(best.begin(), best.end(), worse);
+            } else if (quality.quality > best.front().quality) {
+                std::pop_heap(best.begin(), best.end(), worse);
+                best.back() = quality;
+                std::push_heap(best.begin(), best.end(), worse);
+            }
         }
-        return sort_and_truncate_by_quality(vec_quality, nbmax);
-    }
 
-    /** pour chaque mot trouvé dans la liste des mots il faut incrémenter la propriété : nb_found*/
-    /** Utilisé que pour une recherche partielle */
-    void add_word_quality(std::unordered_map<T, fl_quality>& fl_result, const std::vector<T>& found) const {
-        for (auto i : found) {
-            fl_result[i].nb_found++;
+        for (auto& quality : best) {
+            quality.scores = this->compute_result_scores(str, quality.idx);
         }
+        std::sort(best.begin(), best.end(), worse);
+        return best;
     }
 
     int calc_quality_pattern(const fl_quality& ql, int wordweight, int max_score, int patt_count) const {
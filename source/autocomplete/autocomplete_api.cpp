@@ -31,9 +31,11 @@ www.navitia.io
 #include "autocomplete_api.h"
 #include "type/pb_converter.h"
 #include "autocomplete/autocomplete.h"
+#include "autocomplete/autocomplete_filters.h"
 #include "autocomplete/utils.h"
 #include "utils/functions.h"
 #include <algorithm>
+#include <functional>
 
 namespace navitia {
 namespace autocomplete {
@@ -109,40 +111,76 @@ bool self_admin_check(const georef::Admin* obj, const georef::Admin* admin) {
     return obj->uri == admin->uri;
 }
 
+template <typename T>
+bool is_in_admins(const T* object, const std::vector<const georef::Admin*>& admins) {
+    for (const georef::Admin* admin : admins) {
+        const auto& admin_list = object->admin_list;
+        if (std::find(admin_list.begin(), admin_list.end(), admin) != admin_list.end()) {
+            return true;
+        }
+        if (self_admin_check(object, admin)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 }  // namespace
 
-template <class T>
+/*
+ * Filter of the candidates on the required admins
+ *
+ * The valid objects are gathered once per request from the admin inverted
+ * index, each candidate is then checked in constant time. Without the index
+ * (the filters are built with the autocomplete), the admins of each
+ * candidate are walked.
+ */
 struct ValidAdminPtr {
-    const std::vector<T*>& objects;
-    const std::vector<const georef::Admin*> required_admins;
-
-    ValidAdminPtr(const std::vector<T*>& objects, const std::vector<const georef::Admin*> required_admins)
-        : objects(objects), required_admins(required_admins) {}
+    bool filtered = false;
+    boost::dynamic_bitset<> valid_objects;
+    std::function<bool(type::idx_t)> check_admins;
 
     bool operator()(type::idx_t idx) const {
-        if (required_admins.empty()) {
+        if (!filtered) {
             return true;
         }
-        const T* object = objects[idx];
-
-        for (const georef::Admin* admin : required_admins) {
-            const auto& admin_list = object->admin_list;
-            if (std::find(admin_list.begin(), admin_list.end(), admin) != admin_list.end()) {
-                return true;
-            }
-            if (self_admin_check(object, admin)) {
-                return true;
-            }
+        if (check_admins) {
+            return check_admins(idx);
         }
-
-        return false;
+        return idx < valid_objects.size() && valid_objects.test(idx);
     }
 };
 
 template <class T>
-ValidAdminPtr<T> valid_admin_ptr(const std::vector<T*>& objects,
-                                 const std::vector<const georef::Admin*>& required_admins) {
-    return ValidAdminPtr<T>(objects, required_admins);
+ValidAdminPtr valid_admin_ptr(const std::vector<T*>& objects,
+                              const AdminInvertedIndex* index,
+                              const std::vector<const georef::Admin*>& required_admins) {
+    ValidAdminPtr res;
+    if (required_admins.empty()) {
+        return res;
+    }
+    res.filtered = true;
+    if (index) {
+        res.valid_objects = index->filter(required_admins, objects.size());
+    } else {
+        res.check_admins = [&objects, required_admins](type::idx_t idx) {
+            return idx < objects.size() && is_in_admins(objects[idx], required_admins);
+        };
+    }
+    return res;
+}
+
+// Without the filters, the main stop areas of the admins are gathered for the request
+static boost::dynamic_bitset<> get_main_stop_areas(const nt::Data& d) {
+    boost::dynamic_bitset<> result(d.pt_data->stop_areas.size());
+    for (const auto* admin : d.geo_ref->admins) {
+        for (const auto sa_idx : admin->main_stop_areas) {
+            if (sa_idx < result.size()) {
+                result.set(sa_idx);
+            }
+        }
+    }
+    return result;
 }
 
 static std::vector<const georef::Admin*> admin_uris_to_admin_ptr(const std::vector<std::string>& admin_uris,
@@ -166,17 +204,8 @@ static void update_quality(std::vector<Autocomplete<nt::idx_t>::fl_quality>& ac_
     }
 }
 
-static std::unordered_set<std::string> get_main_stop_areas(const navitia::type::Data& d) {
-    std::unordered_set<std::string> result;
-    for (const auto& admin : d.geo_ref->admins) {
-        for (const auto& sa : admin->main_stop_areas) {
-            result.insert(sa->uri);
-        }
-    }
-    return result;
-}
-
 static std::vector<Autocomplete<nt::idx_t>::fl_quality> complete(const type::Data& d,
+                                                                 const AutocompleteFilters* filters,
                                                                  const type::Type_e& type,
                                                                  const std::string& q,
                                                                  const std::vector<const georef::Admin*>& admin_ptr,
@@ -185,20 +214,30 @@ static std::vector<Autocomplete<nt::idx_t>::fl_quality> complete(const type::Dat
                                                                  float main_stop_area_weight_factor) {
     // TODO Refacto this ...
     std::vector<Autocomplete<nt::idx_t>::fl_quality> result;
+    const auto* stop_areas_index = filters ? &filters->stop_areas : nullptr;
+    const auto* stop_points_index = filters ? &filters->stop_points : nullptr;
+    const auto* admins_index = filters ? &filters->geo_ref->admins : nullptr;
+    const auto* ways_index = filters ? &filters->geo_ref->ways : nullptr;
+    const auto* pois_index = filters ? &filters->geo_ref->pois : nullptr;
     switch (type) {
         case nt::Type_e::StopArea:
             if (search_type == 0) {
                 result = d.pt_data->stop_area_autocomplete.find_complete(
-                    q, nbmax, valid_admin_ptr(d.pt_data->stop_areas, admin_ptr), d.geo_ref->ghostwords);
+                    q, nbmax, valid_admin_ptr(d.pt_data->stop_areas, stop_areas_index, admin_ptr),
+                    d.geo_ref->ghostwords);
             } else {
                 result = d.pt_data->stop_area_autocomplete.find_partial_with_pattern(
-                    q, d.geo_ref->word_weight, nbmax, valid_admin_ptr(d.pt_data->stop_areas, admin_ptr),
-                    d.geo_ref->ghostwords);
+                    q, d.geo_ref->word_weight, nbmax,
+                    valid_admin_ptr(d.pt_data->stop_areas, stop_areas_index, admin_ptr), d.geo_ref->ghostwords);
             }
             if (main_stop_area_weight_factor != 1.0f) {
-                auto main_stop_areas = get_main_stop_areas(d);
+                boost::dynamic_bitset<> admins_main_stop_areas;
+                if (!filters) {
+                    admins_main_stop_areas = get_main_stop_areas(d);
+                }
+                const auto& main_stop_areas = filters ? filters->main_stop_areas : admins_main_stop_areas;
                 for (auto& r : result) {
-                    if (main_stop_areas.count(d.pt_data->stop_areas[r.idx]->uri)) {
+                    if (r.idx < main_stop_areas.size() && main_stop_areas.test(r.idx)) {
                         std::get<0>(r.scores) *= main_stop_area_weight_factor;
                     }
                 }
@@ -207,35 +246,39 @@ static std::vector<Autocomplete<nt::idx_t>::fl_quality> complete(const type::Dat
         case nt::Type_e::StopPoint:
             if (search_type == 0) {
                 result = d.pt_data->stop_point_autocomplete.find_complete(
-                    q, nbmax, valid_admin_ptr(d.pt_data->stop_points, admin_ptr), d.geo_ref->ghostwords);
+                    q, nbmax, valid_admin_ptr(d.pt_data->stop_points, stop_points_index, admin_ptr),
+                    d.geo_ref->ghostwords);
             } else {
                 result = d.pt_data->stop_point_autocomplete.find_partial_with_pattern(
-                    q, d.geo_ref->word_weight, nbmax, valid_admin_ptr(d.pt_data->stop_points, admin_ptr),
-                    d.geo_ref->ghostwords);
+                    q, d.geo_ref->word_weight, nbmax,
+                    valid_admin_ptr(d.pt_data->stop_points, stop_points_index, admin_ptr), d.geo_ref->ghostwords);
             }
             break;
         case nt::Type_e::Admin:
             if (search_type == 0) {
-                result = d.geo_ref->fl_admin.find_complete(q, nbmax, valid_admin_ptr(d.geo_ref->admins, admin_ptr),
-                                                           d.geo_ref->ghostwords);
+                result = d.geo_ref->fl_admin.find_complete(
+                    q, nbmax, valid_admin_ptr(d.geo_ref->admins, admins_index, admin_ptr),
+                    d.geo_ref->ghostwords);
             } else {
-                result = d.geo_ref->fl_admin.find_partial_with_pattern(q, d.geo_ref->word_weight, nbmax,
-                                                                       valid_admin_ptr(d.geo_ref->admins, admin_ptr),
-                                                                       d.geo_ref->ghostwords);
+                result = d.geo_ref->fl_admin.find_partial_with_pattern(
+                    q, d.geo_ref->word_weight, nbmax,
+                    valid_admin_ptr(d.geo_ref->admins, admins_index, admin_ptr), d.geo_ref->ghostwords);
             }
             break;
         case nt::Type_e::Address:
-            result = d.geo_ref->find_ways(q, nbmax, search_type, valid_admin_ptr(d.geo_ref->ways, admin_ptr),
+            result = d.geo_ref->find_ways(q, nbmax, search_type,
+                                          valid_admin_ptr(d.geo_ref->ways, ways_index, admin_ptr),
                                           d.geo_ref->ghostwords);
             break;
         case nt::Type_e::POI:
             if (search_type == 0) {
-                result = d.geo_ref->fl_poi.find_complete(q, nbmax, valid_admin_ptr(d.geo_ref->pois, admin_ptr),
-                                                         d.geo_ref->ghostwords);
+                result = d.geo_ref->fl_poi.find_complete(
+                    q, nbmax, valid_admin_ptr(d.geo_ref->pois, pois_index, admin_ptr),
+                    d.geo_ref->ghostwords);
             } else {
-                result = d.geo_ref->fl_poi.find_partial_with_pattern(q, d.geo_ref->word_weight, nbmax,
-                                                                     valid_admin_ptr(d.geo_ref->pois, admin_ptr),
-                                                                     d.geo_ref->ghostwords);
+                result = d.geo_ref->fl_poi.find_partial_with_pattern(
+                    q, d.geo_ref->word_weight, nbmax,
+                    valid_admin_ptr(d.geo_ref->pois, pois_index, admin_ptr), d.geo_ref->ghostwords);
             }
             break;
         case nt::Type_e::Network:
@@ -373,6 +416,8 @@ void autocomplete(navitia::PbCreator& pb_creator,
     // unwanted objects.
     size_t nb_items_to_search = nbmax * 10;
     std::vector<const georef::Admin*> admin_ptr = admin_uris_to_admin_ptr(admins, d);
+    // the filters are built with the autocomplete, the admins of the candidates are walked without them
+    const auto* filters = d.autocomplete_filters.get();
 
     // Compute number of words in the query:
     std::set<std::string> query_word_vec = d.geo_ref->fl_admin.tokenize(q, d.geo_ref->ghostwords);
@@ -381,7 +426,8 @@ void autocomplete(navitia::PbCreator& pb_creator,
     for (const auto& group : build_type_groups(filter)) {
         for (nt::Type_e type : group) {
             // search for candidate
-            auto found = complete(d, type, q, admin_ptr, nb_items_to_search, search_type, main_stop_area_weight_factor);
+            auto found = complete(d, filters, type, q, admin_ptr, nb_items_to_search, search_type,
+                                  main_stop_area_weight_factor);
             // Compute quality based on difference of word count in the result and the query
             if (search_type == 0) {
                 update_quality(found, query_word_vec.size());
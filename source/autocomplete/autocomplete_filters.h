@@ -0,0 +1,121 @@
+/* Copyright © 2001-2019, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+channel `#navitia` on riot https://riot.im/app/#/room/#navitia:matrix.org
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+
+#include "type/type_interfaces.h"
+#include "georef/adminref.h"
+
+#include <boost/dynamic_bitset.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace navitia {
+namespace autocomplete {
+
+/** Objects attached to each admin, indexed by admin idx
+ *
+ * An admin is attached to itself and to the admins of its admin_list.
+ */
+struct AdminInvertedIndex {
+    std::vector<std::vector<type::idx_t>> objects_by_admin;
+
+    template <typename T>
+    void build(const std::vector<T*>& objects, size_t nb_admins) {
+        objects_by_admin.assign(nb_admins, {});
+        for (const T* object : objects) {
+            add_self(object);
+            for (const georef::Admin* admin : object->admin_list) {
+                add(admin->idx, object->idx);
+            }
+        }
+        for (auto& list : objects_by_admin) {
+            std::sort(list.begin(), list.end());
+            list.erase(std::unique(list.begin(), list.end()), list.end());
+            list.shrink_to_fit();
+        }
+    }
+
+    /// Bitset, indexed by object idx, of the objects attached to one of the admins
+    boost::dynamic_bitset<> filter(const std::vector<const georef::Admin*>& admins, size_t nb_objects) const {
+        boost::dynamic_bitset<> res(nb_objects);
+        for (const georef::Admin* admin : admins) {
+            if (admin->idx >= objects_by_admin.size()) {
+                continue;
+            }
+            for (const type::idx_t idx : objects_by_admin[admin->idx]) {
+                if (idx < nb_objects) {
+                    res.set(idx);
+                }
+            }
+        }
+        return res;
+    }
+
+private:
+    void add(type::idx_t admin_idx, type::idx_t object_idx) {
+        if (admin_idx < objects_by_admin.size()) {
+            objects_by_admin[admin_idx].push_back(object_idx);
+        }
+    }
+    template <typename T>
+    void add_self(const T*) {}
+    void add_self(const georef::Admin* admin) { add(admin->idx, admin->idx); }
+};
+
+/// Filters of the street network objects, not modified by the realtime
+struct GeoRefAutocompleteFilters {
+    AdminInvertedIndex admins;
+    AdminInvertedIndex ways;
+    AdminInvertedIndex pois;
+};
+
+/** Precomputed data used to filter and weight the autocomplete candidates
+ *
+ * Computed once for each Data, so that /places does not need to walk
+ * the admins of the candidates on each request.
+ */
+struct AutocompleteFilters {
+    // indexed by stop area idx, true if it is a main stop area of an admin
+    boost::dynamic_bitset<> main_stop_areas;
+    AdminInvertedIndex stop_areas;
+    AdminInvertedIndex stop_points;
+    // shared between the clones of a Data as the geo_ref
+    std::shared_ptr<const GeoRefAutocompleteFilters> geo_ref;
+
+    bool is_main_stop_area(type::idx_t sa_idx) const {
+        return sa_idx < main_stop_areas.size() && main_stop_areas.test(sa_idx);
+    }
+};
+
+}  // namespace autocomplete
+}  // namespace navitia
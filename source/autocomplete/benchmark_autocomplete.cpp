@@ -0,0 +1,235 @@
+/* Copyright © 2001-2019, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+channel `#navitia` on riot https://riot.im/app/#/room/#navitia:matrix.org
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+/*
+ * Compares the memory and the prefix lookups of the flat posting
+ * dictionaries of the autocomplete with the former layout (a vector of
+ * words and their vector of elements).
+ *
+ * Given a query log, also reports the latencies of the complete and
+ * partial (with typos) searches of its queries.
+ */
+
+#include "autocomplete/autocomplete.h"
+#include "georef/georef.h"
+#include "type/data.h"
+#include "type/pt_data.h"
+#include "utils/init.h"
+#include "utils/timer.h"
+
+#include <boost/program_options.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+using namespace navitia;
+using namespace navitia::autocomplete;
+namespace po = boost::program_options;
+
+using Elt = type::idx_t;
+using LegacyDictionary = std::vector<std::pair<std::string, std::vector<Elt>>>;
+
+static LegacyDictionary to_legacy(const PostingDictionary<Elt>& dictionary) {
+    LegacyDictionary res;
+    res.reserve(dictionary.size());
+    for (size_t i = 0; i < dictionary.size(); ++i) {
+        std::vector<Elt> elements;
+        dictionary.for_each_element(i, [&](Elt elt) { elements.push_back(elt); });
+        res.emplace_back(dictionary.word(i).to_string(), std::move(elements));
+    }
+    return res;
+}
+
+static size_t memory_size(const LegacyDictionary& dictionary) {
+    // strings of at most 15 chars are stored inline with libstdc++
+    size_t res = dictionary.capacity() * sizeof(LegacyDictionary::value_type);
+    for (const auto& elt : dictionary) {
+        res += (elt.first.capacity() > 15 ? elt.first.capacity() + 1 : 0) + elt.second.capacity() * sizeof(Elt);
+    }
+    return res;
+}
+
+// the former Autocomplete::match
+static std::vector<Elt> legacy_match(const std::string& token, const LegacyDictionary& dictionary) {
+    auto lower = std::lower_bound(
+        dictionary.begin(), dictionary.end(), token,
+        [](const LegacyDictionary::value_type& b, const std::string& a) { return b.first < a; });
+    std::vector<Elt> result;
+    for (; lower != dictionary.end() && lower->first.find(token) == 0; ++lower) {
+        std::vector<Elt> other = lower->second;
+        result.insert(result.end(), other.begin(), other.end());
+    }
+    return result;
+}
+
+static double percentile(std::vector<double>& latencies, const double p) {
+    const auto rank = static_cast<size_t>(p * (latencies.size() - 1));
+    std::nth_element(latencies.begin(), latencies.begin() + rank, latencies.end());
+    return latencies[rank];
+}
+
+// replays the queries through search, and prints its latencies
+template <typename F>
+static void bench_search(const std::string& name, const std::vector<std::string>& queries, F search) {
+    std::vector<double> latencies;
+    size_t nb_results = 0;
+    for (const auto& q : queries) {
+        const auto start = std::chrono::steady_clock::now();
+        nb_results += search(q).size();
+        const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+        latencies.push_back(duration.count());
+    }
+    std::cout << name << ": " << nb_results << " results, p50 " << percentile(latencies, 0.5) << "ms, p95 "
+              << percentile(latencies, 0.95) << "ms, p99 " << percentile(latencies, 0.99) << "ms, max "
+              << *std::max_element(latencies.begin(), latencies.end()) << "ms" << std::endl;
+}
+
+static const Autocomplete<Elt>& get_autocomplete(const type::Data& data, const std::string& type) {
+    if (type == "way") {
+        return data.geo_ref->fl_way;
+    } else if (type == "poi") {
+        return data.geo_ref->fl_poi;
+    } else if (type == "admin") {
+        return data.geo_ref->fl_admin;
+    } else if (type == "stop_area") {
+        return data.pt_data->stop_area_autocomplete;
+    } else if (type == "stop_point") {
+        return data.pt_data->stop_point_autocomplete;
+    }
+    throw std::invalid_argument("unknown autocomplete type " + type);
+}
+
+int main(int argc, char** argv) {
+    navitia::init_app();
+    po::options_description desc("Options of the autocomplete benchmark");
+    std::string file, type, queries_file;
+    size_t nb_queries, nbmax;
+    int word_weight;
+
+    // clang-format off
+    desc.add_options()
+        ("help", "Show this message")
+        ("file,f", po::value<std::string>(&file)->default_value("data.nav.lz4"), "Path to data.nav.lz4")
+        ("type,t", po::value<std::string>(&type)->default_value("way"),
+            "autocomplete to bench: way, poi, admin, stop_area or stop_point")
+        ("queries,q", po::value<std::string>(&queries_file),
+            "file of the tokens to look up, one by line (random prefixes of the words if not given)")
+        ("nb_queries,n", po::value<size_t>(&nb_queries)->default_value(10000), "number of random prefixes")
+        ("nbmax", po::value<size_t>(&nbmax)->default_value(100), "number of results of the searches of the query log")
+        ("word_weight", po::value<int>(&word_weight)->default_value(5), "word weight of the partial searches");
+    // clang-format on
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help")) {
+        std::cout << desc << std::endl;
+        return 1;
+    }
+
+    type::Data data;
+    {
+        Timer t("Data loading: " + file);
+        data.load_nav(file);
+    }
+    const auto& ac = get_autocomplete(data, type);
+    const auto& dictionary = ac.word_dictionnary;
+    if (dictionary.empty()) {
+        std::cerr << "empty autocomplete" << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> queries, log_queries;
+    if (!queries_file.empty()) {
+        std::ifstream ifs(queries_file);
+        for (std::string line; std::getline(ifs, line);) {
+            if (line.empty()) {
+                continue;
+            }
+            log_queries.push_back(line);
+            auto tokens = ac.tokenize(line, {});
+            queries.insert(queries.end(), tokens.begin(), tokens.end());
+        }
+    } else {
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<size_t> word_dist(0, dictionary.size() - 1);
+        for (size_t i = 0; i < nb_queries; ++i) {
+            const auto word = dictionary.word(word_dist(rng)).to_string();
+            std::uniform_int_distribution<size_t> len_dist(1, std::min<size_t>(word.size(), 5));
+            queries.push_back(word.substr(0, len_dist(rng)));
+        }
+    }
+
+    const auto legacy_words = to_legacy(dictionary);
+    const auto legacy_patterns = to_legacy(ac.pattern_dictionnary);
+
+    std::cout << "memory of the words dictionary: " << dictionary.memory_size() / 1024 << " kB (legacy "
+              << memory_size(legacy_words) / 1024 << " kB)" << std::endl;
+    std::cout << "memory of the patterns dictionary: " << ac.pattern_dictionnary.memory_size() / 1024
+              << " kB (legacy " << memory_size(legacy_patterns) / 1024 << " kB)" << std::endl;
+    std::cout << "memory of the indexed strings: " << ac.indexed_string.memory_size() / 1024 << " kB" << std::endl;
+
+    size_t nb_found = 0, legacy_nb_found = 0;
+    double duration, legacy_duration;
+    {
+        Timer t;
+        for (const auto& q : queries) {
+            nb_found += ac.match(q, dictionary).size();
+        }
+        duration = t.ms();
+    }
+    {
+        Timer t;
+        for (const auto& q : queries) {
+            legacy_nb_found += legacy_match(q, legacy_words).size();
+        }
+        legacy_duration = t.ms();
+    }
+    if (nb_found != legacy_nb_found) {
+        std::cerr << "different results: " << nb_found << " vs " << legacy_nb_found << std::endl;
+        return 1;
+    }
+    std::cout << queries.size() << " lookups, " << nb_found << " elements found" << std::endl
+              << "flat dictionary: " << duration << "ms, legacy: " << legacy_duration << "ms" << std::endl;
+
+    if (!log_queries.empty()) {
+        const auto keep_all = [](Elt) { return true; };
+        const auto& ghostwords = data.geo_ref->ghostwords;
+        bench_search("complete search", log_queries,
+                     [&](const std::string& q) { return ac.find_complete(q, nbmax, keep_all, ghostwords); });
+        bench_search("partial search", log_queries, [&](const std::string& q) {
+            return ac.find_partial_with_pattern(q, word_weight, nbmax, keep_all, ghostwords);
+        });
+    }
+    return 0;
+}
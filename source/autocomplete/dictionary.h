@@ -0,0 +1,225 @@
+/* Copyright © 2001-2019, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+channel `#navitia` on riot https://riot.im/app/#/room/#navitia:matrix.org
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+
+#include "utils/exception.h"
+
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/utility/string_ref.hpp>
+#include <boost/iterator/counting_iterator.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace navitia {
+namespace autocomplete {
+
+/** Sorted words associated to the sorted list of the elements containing them
+ *
+ * Everything is stored in flat arrays:
+ *  - the words are concatenated in `words`, the word i being
+ *    words[word_offsets[i], word_offsets[i + 1])
+ *  - the elements of the word i are delta encoded as varints in
+ *    postings[posting_offsets[i], posting_offsets[i + 1])
+ *
+ * The elements are decoded on the fly by the queries, without any copy
+ * of the posting lists.
+ */
+template <class T>
+struct PostingDictionary {
+    std::string words;
+    std::vector<uint32_t> word_offsets = {0};
+    std::vector<uint8_t> postings;
+    std::vector<uint32_t> posting_offsets = {0};
+
+    size_t size() const { return word_offsets.size() - 1; }
+    bool empty() const { return size() == 0; }
+
+    boost::string_ref word(const size_t i) const {
+        return boost::string_ref(words.data() + word_offsets[i], word_offsets[i + 1] - word_offsets[i]);
+    }
+
+    /// Adds a word and its elements, the words must be added in increasing order
+    void add(const std::string& word, const std::set<T>& elements) {
+        words += word;
+        T prev = 0;
+        for (const auto elt : elements) {
+            // varint of the difference with the previous element
+            uint64_t delta = elt - prev;
+            while (delta >= 0x80) {
+                postings.push_back(static_cast<uint8_t>(delta | 0x80));
+                delta >>= 7;
+            }
+            postings.push_back(static_cast<uint8_t>(delta));
+            prev = elt;
+        }
+        if (words.size() > std::numeric_limits<uint32_t>::max()
+            || postings.size() > std::numeric_limits<uint32_t>::max()) {
+            throw navitia::exception("autocomplete dictionary too big");
+        }
+        word_offsets.push_back(words.size());
+        posting_offsets.push_back(postings.size());
+    }
+
+    void clear() {
+        words.clear();
+        word_offsets = {0};
+        postings.clear();
+        posting_offsets = {0};
+    }
+
+    void shrink_to_fit() {
+        words.shrink_to_fit();
+        word_offsets.shrink_to_fit();
+        postings.shrink_to_fit();
+        posting_offsets.shrink_to_fit();
+    }
+
+    /// Returns the range [first, last) of the words beginning with prefix
+    std::pair<size_t, size_t> prefix_range(const std::string& prefix) const {
+        const auto begin = boost::counting_iterator<size_t>(0);
+        const auto end = boost::counting_iterator<size_t>(size());
+        const boost::string_ref p(prefix);
+        // the words beginning with prefix are contiguous as they are sorted
+        const auto first = std::partition_point(begin, end, [&](size_t i) { return word(i) < p; });
+        const auto last = std::partition_point(first, end, [&](size_t i) { return word(i).starts_with(p); });
+        return {*first, *last};
+    }
+
+    /// Decodes a posting list in increasing order
+    struct Cursor {
+        const uint8_t* it;
+        const uint8_t* end;
+        size_t nb_bytes;  // size of the encoded list, to compare the lengths of the lists
+        T elt = 0;        // current element, valid if !at_end
+        bool at_end = false;
+
+        Cursor(const uint8_t* begin, const uint8_t* end) : it(begin), end(end), nb_bytes(end - begin) { next(); }
+
+        void next() {
+            if (it == end) {
+                at_end = true;
+                return;
+            }
+            uint64_t delta = 0;
+            for (size_t shift = 0;; shift += 7) {
+                delta |= uint64_t(*it & 0x7F) << shift;
+                if (!(*it++ & 0x80)) {
+                    break;
+                }
+            }
+            elt += static_cast<T>(delta);
+        }
+
+        /// Moves to the first element not lower than target
+        void advance_to(const T target) {
+            while (!at_end && elt < target) {
+                next();
+            }
+        }
+    };
+
+    Cursor cursor(const size_t i) const {
+        return Cursor(postings.data() + posting_offsets[i], postings.data() + posting_offsets[i + 1]);
+    }
+
+    /// Calls f on each element of the word i, in increasing order
+    template <typename F>
+    void for_each_element(const size_t i, F f) const {
+        for (auto c = cursor(i); !c.at_end; c.next()) {
+            f(c.elt);
+        }
+    }
+
+    /// Number of bytes used by the dictionary
+    size_t memory_size() const {
+        return words.capacity() + word_offsets.capacity() * sizeof(uint32_t) + postings.capacity()
+               + posting_offsets.capacity() * sizeof(uint32_t);
+    }
+
+    template <class Archive>
+    void serialize(Archive& ar, const unsigned int) {
+        ar& words& word_offsets& postings& posting_offsets;
+    }
+};
+
+/// Strings associated to dense elements, concatenated in a flat buffer
+template <class T>
+struct FlatStrings {
+    std::string strings;
+    std::vector<uint32_t> offsets = {0};
+
+    /// the string of an element never set is empty
+    boost::string_ref at(const T elt) const {
+        if (size_t(elt) + 1 >= offsets.size()) {
+            return {};
+        }
+        return boost::string_ref(strings.data() + offsets[elt], offsets[elt + 1] - offsets[elt]);
+    }
+
+    /// Sets the strings of the elements, the i-th string being the one of the element i
+    void assign(const std::vector<std::string>& values) {
+        clear();
+        size_t size = 0;
+        for (const auto& s : values) {
+            size += s.size();
+        }
+        if (size > std::numeric_limits<uint32_t>::max()) {
+            throw navitia::exception("autocomplete strings too big");
+        }
+        strings.reserve(size);
+        offsets.reserve(values.size() + 1);
+        for (const auto& s : values) {
+            strings += s;
+            offsets.push_back(strings.size());
+        }
+    }
+
+    void clear() {
+        strings.clear();
+        offsets = {0};
+    }
+
+    size_t memory_size() const { return strings.capacity() + offsets.capacity() * sizeof(uint32_t); }
+
+    template <class Archive>
+    void serialize(Archive& ar, const unsigned int) {
+        ar& strings& offsets;
+    }
+};
+
+}  // namespace autocomplete
+}  // namespace navitia
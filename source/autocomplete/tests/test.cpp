@@ -33,6 +33,7 @@ www.navitia.io
 
 #include "autocomplete/autocomplete.h"
 #include "autocomplete/autocomplete_api.h"
+#include "autocomplete/autocomplete_filters.h"
 #include "type/data.h"
 #include <boost/test/unit_test.hpp>
 #include <vector>
@@ -399,6 +400,40 @@ BOOST_AUTO_TEST_CASE(Faute_de_frappe_One) {
     BOOST_CHECK_EQUAL(res1.at(0).quality, 94);
 }
 
+BOOST_AUTO_TEST_CASE(Faute_de_frappe_top_k) {
+    autocomplete_map synonyms;
+    std::set<std::string> ghostwords;
+    int word_weight = 5;
+
+    Autocomplete<unsigned int> ac;
+
+    ac.add_string("gare Château", 0, ghostwords, synonyms);
+    ac.add_string("gare bateau", 1, ghostwords, synonyms);
+    ac.add_string("gare de taureau", 2, ghostwords, synonyms);
+    ac.add_string("gare tauro", 3, ghostwords, synonyms);
+    ac.add_string("gare gateau", 4, ghostwords, synonyms);
+
+    ac.build();
+
+    // only the best ones are kept
+    auto res = ac.find_partial_with_pattern("gare patea", word_weight, 2, [](int) { return true; }, ghostwords);
+    BOOST_REQUIRE_EQUAL(res.size(), 2);
+    std::initializer_list<unsigned> best_res = {1, 4};
+    BOOST_CHECK(navitia::contains(best_res, res.at(0).idx));
+    BOOST_CHECK(navitia::contains(best_res, res.at(1).idx));
+    BOOST_CHECK_EQUAL(res.at(0).quality, 94);
+    BOOST_CHECK_EQUAL(res.at(1).quality, 94);
+
+    // the filtered elements are not candidates
+    res = ac.find_partial_with_pattern("gare patea", word_weight, 2, [](int idx) { return idx != 1; }, ghostwords);
+    BOOST_REQUIRE_EQUAL(res.size(), 2);
+    BOOST_CHECK_EQUAL(res.at(0).idx, 4);
+    BOOST_CHECK_EQUAL(res.at(1).idx, 0);
+
+    BOOST_CHECK(ac.find_partial_with_pattern("gare patea", word_weight, 0, [](int) { return true; }, ghostwords)
+                    .empty());
+}
+
 /*
     > Le fonctionnement normal :> On prends que les autocomplete si tous les mots dans la recherche existent
       et trie la liste des Autocomplete par la qualité.
@@ -630,7 +665,7 @@ BOOST_AUTO_TEST_CASE(autocomplete_main_stop_area_test) {
     ad->postal_codes.push_back("29000");
     ad->idx = 0;
     b.data->geo_ref->admins.push_back(ad);
-    ad->main_stop_areas.push_back(b.data->pt_data->stop_areas_map["Luther King"]);
+    ad->main_stop_areas.push_back(b.data->pt_data->stop_areas_map["Luther King"]->idx);
     b.manage_admin();
     b.build_autocomplete();
 
@@ -1804,6 +1839,64 @@ BOOST_AUTO_TEST_CASE(autocomplete_admin_filtering_tests) {
     // we should only find the admin and bob
     BOOST_CHECK_EQUAL(resp.places(0).uri(), "BobVille");
     BOOST_CHECK_EQUAL(resp.places(1).uri(), "bob");
+
+    // without the filters, the admins of the candidates are checked
+    b.data->autocomplete_filters.reset();
+    pb_creator.init(data_ptr, boost::gregorian::not_a_date_time, null_time_period);
+    navitia::autocomplete::autocomplete(pb_creator, "bob", type_filter, 1, 10, admins, 0, *(b.data));
+    resp = pb_creator.get_response();
+    BOOST_REQUIRE_EQUAL(resp.places_size(), 2);
+    BOOST_CHECK_EQUAL(resp.places(0).uri(), "BobVille");
+    BOOST_CHECK_EQUAL(resp.places(1).uri(), "bob");
+}
+
+BOOST_AUTO_TEST_CASE(autocomplete_filters_test) {
+    ed::builder b("20140614");
+
+    Admin* bobville = new Admin;
+    bobville->uri = "BobVille";
+    bobville->level = 8;
+    bobville->idx = 0;
+    b.data->geo_ref->admins.push_back(bobville);
+    Admin* bobland = new Admin;
+    bobland->uri = "BobLand";
+    bobland->level = 4;
+    bobland->idx = 1;
+    bobland->admin_list.push_back(bobville);
+    b.data->geo_ref->admins.push_back(bobland);
+
+    b.sa("bob", 0, 0);
+    b.sa("bobette", 0, 0);
+    b.sa("bobby", 0, 0);
+    b.data->pt_data->sort_and_index();
+    auto* bob = b.data->pt_data->stop_areas_map.at("bob");
+    auto* bobby = b.data->pt_data->stop_areas_map.at("bobby");
+    bob->admin_list.push_back(bobville);
+    bobby->admin_list.push_back(bobland);
+    bobville->main_stop_areas.push_back(bobby->idx);
+    b.build_autocomplete();
+
+    BOOST_REQUIRE(b.data->autocomplete_filters);
+    const auto& filters = *b.data->autocomplete_filters;
+    BOOST_REQUIRE_EQUAL(filters.main_stop_areas.size(), 3);
+    BOOST_CHECK_EQUAL(filters.main_stop_areas.count(), 1);
+    BOOST_CHECK(filters.is_main_stop_area(bobby->idx));
+    BOOST_CHECK(!filters.is_main_stop_area(bob->idx));
+
+    const auto valid_sa = filters.stop_areas.filter({bobville}, 3);
+    BOOST_CHECK_EQUAL(valid_sa.count(), 1);
+    BOOST_CHECK(valid_sa.test(bob->idx));
+    BOOST_CHECK_EQUAL(filters.stop_areas.filter({bobville, bobland}, 3).count(), 2);
+
+    // an admin belongs to itself
+    const auto valid_admins = filters.geo_ref->admins.filter({bobville}, 2);
+    BOOST_CHECK_EQUAL(valid_admins.count(), 2);
+    BOOST_CHECK_EQUAL(filters.geo_ref->admins.filter({bobland}, 2).count(), 1);
+
+    // the street network filters are shared by the realtime rebuilds
+    const auto geo_ref_filters = filters.geo_ref;
+    b.data->build_autocomplete_partial();
+    BOOST_CHECK_EQUAL(b.data->autocomplete_filters->geo_ref, geo_ref_filters);
 }
 
 BOOST_AUTO_TEST_CASE(test_ways) {
@@ -2101,3 +2194,31 @@ BOOST_AUTO_TEST_CASE(autocomplete_test_stop_area_longest_substring) {
         BOOST_REQUIRE_EQUAL(resp.places(0).scores(2), (sp_search_low.size() - 1) * -1);
     }
 }
+
+BOOST_AUTO_TEST_CASE(posting_dictionary_test) {
+    PostingDictionary<unsigned int> dictionary;
+    dictionary.add("av", {3});
+    dictionary.add("avenue", {1, 2, 300, 70000});
+    dictionary.add("bd", {});
+    dictionary.add("rue", {0, 128});
+
+    BOOST_REQUIRE_EQUAL(dictionary.size(), 4);
+    BOOST_CHECK_EQUAL(dictionary.word(1), "avenue");
+
+    auto elements = [&](size_t i) {
+        std::vector<unsigned int> res;
+        dictionary.for_each_element(i, [&](unsigned int elt) { res.push_back(elt); });
+        return res;
+    };
+    const std::vector<unsigned int> avenue = {1, 2, 300, 70000};
+    const std::vector<unsigned int> rue = {0, 128};
+    BOOST_CHECK_EQUAL(elements(1), avenue);
+    BOOST_CHECK(elements(2).empty());
+    BOOST_CHECK_EQUAL(elements(3), rue);
+
+    BOOST_CHECK_EQUAL(dictionary.prefix_range("av"), std::make_pair(size_t(0), size_t(2)));
+    BOOST_CHECK_EQUAL(dictionary.prefix_range("ave"), std::make_pair(size_t(1), size_t(2)));
+    BOOST_CHECK_EQUAL(dictionary.prefix_range("r"), std::make_pair(size_t(3), size_t(4)));
+    BOOST_CHECK_EQUAL(dictionary.prefix_range("c"), std::make_pair(size_t(3), size_t(3)));
+    BOOST_CHECK_EQUAL(dictionary.prefix_range("z"), std::make_pair(size_t(4), size_t(4)));
+}
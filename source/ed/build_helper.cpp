@@ -786,6 +786,7 @@ void builder::make() {
 
 void builder::finalize_disruption_batch() {
     data->pt_data->build_autocomplete(*(data->geo_ref));
+    data->build_autocomplete_filters();
     data->pt_data->clean_weak_impacts();
     data->build_raptor(1);
 }
@@ -841,7 +842,7 @@ navitia::georef::Way* builder::add_way(const std::string& name, const std::strin
     // associate the way to an edge to make them "searchable" in the autocomplete
     navitia::georef::Edge e;
     e.way_idx = w->idx;
-    boost::add_edge(*this->vertex_a, *this->vertex_b, e, this->data->geo_ref->graph);
+    this->data->geo_ref->add_edge(*this->vertex_a, *this->vertex_b, e);
     w->edges.push_back(std::make_pair(*this->vertex_a, *this->vertex_b));
     this->data->geo_ref->ways.push_back(w);
     return w;
@@ -36,6 +36,7 @@ www.navitia.io
 #include "utils/exception.h"
 #include "ed_reader.h"
 #include "type/data.h"
+#include "type/flat_nav.h"
 #include "utils/init.h"
 #include "utils/functions.h"
 #include "type/meta_data.h"
@@ -189,6 +190,9 @@ int ed2nav(int argc, const char* argv[]) {
          "database connection parameters: host=localhost user=navitia dbname=navitia password=navitia")
         ("cities-connection-string", po::value<std::string>(&cities_connection_string)->default_value(""),
          "cities database connection parameters: host=localhost user=navitia dbname=cities password=navitia")
+        ("lz4hc", "compress the data with LZ4HC: smaller file, longer to write, as fast to load")
+        ("contraction_hierarchies", "contract the walking, bike and car street networks, "
+         "speeding up the direct paths of kraken but making the data bigger and longer to compute")
         ("local_syslog", "activate log redirection within local syslog")
         ("log_comment", po::value<std::string>(), "optional field to add extra information like coverage name");
     // clang-format on
@@ -224,6 +228,11 @@ int ed2nav(int argc, const char* argv[]) {
     if (vm.count("help") || !vm.count("connection-string")) {
         std::cout << "Extracts data from a database to a file readable by kraken" << std::endl;
         std::cout << desc << std::endl;
+        std::cout << "A flat companion file (<output without .lz4>.flat) is also written, mapped by kraken for the"
+                  << std::endl
+                  << "proximity lists and the POI coordinates only: the rest of the data is still loaded from the"
+                  << std::endl
+                  << "output file, the load time of kraken is not reduced yet." << std::endl;
         return 1;
     }
 
@@ -253,6 +262,10 @@ int ed2nav(int argc, const char* argv[]) {
 
     read = (pt::microsec_clock::local_time() - start).total_milliseconds();
     data.complete();
+    if (vm.count("contraction_hierarchies")) {
+        LOG4CPLUS_INFO(logger, "Building the contraction hierarchies");
+        data.geo_ref->build_contraction_hierarchies();
+    }
     data.meta->publication_date = pt::microsec_clock::local_time();
 
     LOG4CPLUS_INFO(logger, "line: " << data.pt_data->lines.size());
@@ -274,7 +287,9 @@ int ed2nav(int argc, const char* argv[]) {
 
     start = pt::microsec_clock::local_time();
     try {
-        data.save(output);
+        data.save(output, vm.count("lz4hc"));
+        // flat companion file, mapped by kraken to skip the computation of the proximity lists
+        data.save_flat(navitia::type::flat_nav_filename(output));
     } catch (const navitia::exception& e) {
         LOG4CPLUS_ERROR(logger, "Unable to save");
         LOG4CPLUS_ERROR(logger, e.what());
@@ -209,7 +209,7 @@ void EdReader::fill_admin_stop_areas(navitia::type::Data&, pqxx::work& work) {
 
         navitia::type::StopArea* sa = it_sa->second;
 
-        admin->main_stop_areas.push_back(sa);
+        admin->main_stop_areas.push_back(sa->idx);
         nb_valid_admin++;
     }
     LOG4CPLUS_INFO(log, nb_valid_admin << " admin with at least one main stop");
@@ -1568,7 +1568,7 @@ void EdReader::fill_graph(navitia::type::Data& data, pqxx::work& work, bool expo
         if (walkable) {
             if (auto dur = get_duration(nt::Mode_e::Walking, len, source, target)) {
                 e.duration = navitia::seconds(*dur);
-                boost::add_edge(source, target, e, data.geo_ref->graph);
+                data.geo_ref->add_edge(source, target, e);
                 way->edges.push_back(std::make_pair(source, target));
                 nb_walking_edges++;
             }
@@ -1578,7 +1578,7 @@ void EdReader::fill_graph(navitia::type::Data& data, pqxx::work& work, bool expo
                 e.duration = navitia::seconds(*dur);
                 auto bike_source = data.geo_ref->offsets[nt::Mode_e::Bike] + source;
                 auto bike_target = data.geo_ref->offsets[nt::Mode_e::Bike] + target;
-                boost::add_edge(bike_source, bike_target, e, data.geo_ref->graph);
+                data.geo_ref->add_edge(bike_source, bike_target, e);
                 way->edges.push_back(std::make_pair(bike_source, bike_target));
                 nb_biking_edges++;
             }
@@ -1588,7 +1588,7 @@ void EdReader::fill_graph(navitia::type::Data& data, pqxx::work& work, bool expo
                 e.duration = navitia::seconds(*dur);
                 auto car_source = data.geo_ref->offsets[nt::Mode_e::Car] + source;
                 auto car_target = data.geo_ref->offsets[nt::Mode_e::Car] + target;
-                boost::add_edge(car_source, car_target, e, data.geo_ref->graph);
+                data.geo_ref->add_edge(car_source, car_target, e);
                 way->edges.push_back(std::make_pair(car_source, car_target));
                 nb_driving_edges++;
             }
@@ -36,6 +36,10 @@ www.navitia.io
 #include <boost/optional.hpp>
 #include <boost/algorithm/string/case_conv.hpp>
 
+#include <limits>
+#include <tuple>
+#include <unordered_map>
+
 #include "type/datetime.h"
 
 namespace greg = boost::gregorian;
@@ -125,9 +129,152 @@ std::string comp_to_string(const Comp_e comp) {
     }
 }
 
+/// Compiled form of the transition graph
+/// The outgoing transitions of each state are stored contiguously, in the order boost::edges(g) visits them, and
+/// the ticket keys are resolved once into a flat ticket table
+struct FareAutomaton {
+    static const size_t no_ticket_idx = std::numeric_limits<size_t>::max();
+
+    struct Arc {
+        Fare::vertex_t target;
+        Transition transition;
+        size_t ticket_idx;  // index in tickets, no_ticket_idx for a transition without ticket
+    };
+
+    std::vector<State> states;
+    std::vector<size_t> offsets;  // the arcs of the state u are [offsets[u], offsets[u + 1])
+    std::vector<Arc> arcs;
+    std::vector<DateTicket> tickets;
+
+    explicit FareAutomaton(const Fare& fare) {
+        const size_t nb_nodes = boost::num_vertices(fare.g);
+        states.reserve(nb_nodes);
+        offsets.reserve(nb_nodes + 1);
+        arcs.reserve(boost::num_edges(fare.g));
+
+        // the tickets unknown from the fare map are priced with the default ticket
+        DateTicket default_ticket;
+        default_ticket.add(boost::gregorian::date(boost::gregorian::neg_infin),
+                           boost::gregorian::date(boost::gregorian::pos_infin), make_default_ticket());
+        tickets.push_back(default_ticket);
+        std::unordered_map<std::string, size_t> ticket_idx_by_key;
+
+        for (Fare::vertex_t u = 0; u < nb_nodes; ++u) {
+            states.push_back(fare.g[u]);
+            offsets.push_back(arcs.size());
+            BOOST_FOREACH (Fare::edge_t e, boost::out_edges(u, fare.g)) {
+                const Transition& transition = fare.g[e];
+                size_t ticket_idx = no_ticket_idx;
+                if (transition.ticket_key != "") {
+                    auto it = ticket_idx_by_key.find(transition.ticket_key);
+                    if (it != ticket_idx_by_key.end()) {
+                        ticket_idx = it->second;
+                    } else {
+                        ticket_idx = 0;
+                        auto fare_it = fare.fare_map.find(transition.ticket_key);
+                        if (fare_it != fare.fare_map.end()) {
+                            ticket_idx = tickets.size();
+                            tickets.push_back(fare_it->second);
+                        }
+                        ticket_idx_by_key[transition.ticket_key] = ticket_idx;
+                    }
+                }
+                arcs.push_back({boost::target(e, fare.g), transition, ticket_idx});
+            }
+        }
+        offsets.push_back(arcs.size());
+    }
+
+    Ticket get_ticket(size_t ticket_idx, boost::gregorian::date date) const {
+        if (ticket_idx == no_ticket_idx) {
+            return Ticket();
+        }
+        auto ticket = tickets[ticket_idx].get_fare(date);
+        return ticket ? *ticket : make_default_ticket();
+    }
+};
+
+/// Everything in a label that conditions the transitions it can take and the tickets it will buy
+struct LabelDominanceKey {
+    const Label* label;
+
+    bool operator<(const LabelDominanceKey& other) const {
+        const Label& a = *label;
+        const Label& b = *other.label;
+        const auto a_key = std::tie(a.start_time, a.nb_changes, a.current_type, a.stop_area, a.zone, a.mode, a.line,
+                                    a.network);
+        const auto b_key = std::tie(b.start_time, b.nb_changes, b.current_type, b.stop_area, b.zone, b.mode, b.line,
+                                    b.network);
+        if (a_key != b_key) {
+            return a_key < b_key;
+        }
+        if (a.tickets.empty() || b.tickets.empty()) {
+            return a.tickets.empty() && !b.tickets.empty();
+        }
+        return std::tie(a.tickets.back().key, a.tickets.back().caption)
+               < std::tie(b.tickets.back().key, b.tickets.back().caption);
+    }
+};
+
+/// Two labels of a state with the same dominance key can be extended by exactly the same transitions, for the same
+/// prices, so the extensions of the one with the lowest cost will always be preferred: the others are dropped.
+/// The kept labels stay in the same order so the ties are broken as without the pruning.
+static void remove_dominated_labels(std::vector<Label>& labels) {
+    if (labels.size() < 2) {
+        return;
+    }
+    std::map<LabelDominanceKey, size_t> best_labels;
+    for (size_t i = 0; i < labels.size(); ++i) {
+        auto it = best_labels.insert({LabelDominanceKey{&labels[i]}, i});
+        if (!it.second && labels[i] < labels[it.first->second]) {
+            it.first->second = i;
+        }
+    }
+    if (best_labels.size() == labels.size()) {
+        return;
+    }
+    std::vector<bool> is_best(labels.size(), false);
+    for (const auto& key_idx : best_labels) {
+        is_best[key_idx.second] = true;
+    }
+    std::vector<Label> kept_labels;
+    kept_labels.reserve(best_labels.size());
+    for (size_t i = 0; i < labels.size(); ++i) {
+        if (is_best[i]) {
+            kept_labels.push_back(std::move(labels[i]));
+        }
+    }
+    labels = std::move(kept_labels);
+}
+
+void Fare::build_automaton() {
+    automaton = std::make_shared<const FareAutomaton>(*this);
+}
+
+std::shared_ptr<const FareAutomaton> Fare::get_automaton() const {
+    if (automaton) {
+        return automaton;
+    }
+    return std::make_shared<const FareAutomaton>(*this);
+}
+
 results Fare::compute_fare(const routing::Path& path) const {
+    return compute_fare(*get_automaton(), path);
+}
+
+std::vector<results> Fare::compute_fares(const std::vector<routing::Path>& paths) const {
+    std::vector<results> res;
+    res.reserve(paths.size());
+    const auto compiled = get_automaton();
+    for (const auto& path : paths) {
+        res.push_back(compute_fare(*compiled, path));
+    }
+    return res;
+}
+
+results Fare::compute_fare(const FareAutomaton& automaton, const routing::Path& path) const {
     results res;
-    int nb_nodes = boost::num_vertices(g);
+    const size_t nb_nodes = automaton.states.size();
 
     if (nb_nodes < 2) {
         LOG4CPLUS_TRACE(logger, "no fare data loaded, cannot compute fare");
@@ -146,80 +293,82 @@ results Fare::compute_fare(const routing::Path& path) const {
 
         SectionKey section_key(item, section_idx++);
 
+        std::vector<bool> reachable_states(nb_nodes);
+        for (size_t v = 0; v < nb_nodes; ++v) {
+            reachable_states[v] = valid(automaton.states[v], section_key);
+        }
+
         std::vector<std::vector<Label>> new_labels(nb_nodes);
-        try {
-            BOOST_FOREACH (edge_t e, boost::edges(g)) {
-                vertex_t u = boost::source(e, g);
-                vertex_t v = boost::target(e, g);
-                if (!valid(g[v], section_key))
+        boost::optional<Ticket> exclusive_ticket;
+        for (size_t u = 0; u < nb_nodes && !exclusive_ticket; ++u) {
+            if (labels[u].empty()) {
+                continue;
+            }
+            for (size_t a = automaton.offsets[u]; a < automaton.offsets[u + 1] && !exclusive_ticket; ++a) {
+                const FareAutomaton::Arc& arc = automaton.arcs[a];
+                if (!reachable_states[arc.target]) {
                     continue;
+                }
+                const Transition& transition = arc.transition;
 
                 for (const Label& label : labels[u]) {
-                    Ticket ticket;
-                    const Transition& transition = g[e];
-                    if (valid(g[u], label) && transition.valid(section_key, label)) {
-                        if (transition.ticket_key != "") {
-                            bool ticket_found = false;  // TODO refactor this, optional is way better
-                            auto it = fare_map.find(transition.ticket_key);
-                            try {
-                                if (it != fare_map.end()) {
-                                    ticket = it->second.get_fare(section_key.date);
-                                    ticket_found = true;
-                                }
-                            } catch (no_ticket) {  // the ticket_found bool is still false
-                            }
-                            if (!ticket_found) {
-                                ticket = make_default_ticket();
-                            }
-                        }
-                        if (transition.global_condition == Transition::GlobalCondition::exclusive)
-                            throw ticket;
-                        else if (transition.global_condition == Transition::GlobalCondition::with_changes) {
-                            ticket.type = Ticket::ODFare;
+                    if (!valid(automaton.states[u], label) || !transition.valid(section_key, label)) {
+                        continue;
+                    }
+                    Ticket ticket = automaton.get_ticket(arc.ticket_idx, section_key.date);
+                    if (transition.global_condition == Transition::GlobalCondition::exclusive) {
+                        exclusive_ticket = ticket;
+                        break;
+                    } else if (transition.global_condition == Transition::GlobalCondition::with_changes) {
+                        ticket.type = Ticket::ODFare;
+                    }
+                    Label next = next_label(label, ticket, section_key);
+
+                    // we process the OD ticket: case where we'll not use this ticket anymore
+                    if (label.current_type == Ticket::ODFare || ticket.type == Ticket::ODFare) {
+                        boost::optional<Ticket> ticket_od;
+                        if (auto od = get_od(next, section_key)) {
+                            ticket_od = od->get_fare(section_key.date);
                         }
-                        Label next = next_label(label, ticket, section_key);
-
-                        // we process the OD ticket: case where we'll not use this ticket anymore
-                        if (label.current_type == Ticket::ODFare || ticket.type == Ticket::ODFare) {
-                            try {
-                                Ticket ticket_od;
-                                ticket_od = get_od(next, section_key).get_fare(section_key.date);
-                                if (label.tickets.size() > 0 && label.current_type == Ticket::ODFare)
-                                    ticket_od.sections = label.tickets.back().sections;
-
-                                ticket_od.sections.push_back(section_key);
-                                Label n = next;
-                                n.cost += ticket_od.value;
-                                n.tickets.back() = ticket_od;
-                                n.current_type = Ticket::FlatFare;
-
-                                new_labels[0].push_back(n);
-                            } catch (no_ticket) {
-                                LOG4CPLUS_TRACE(logger, "Unable to get the OD ticket SA="
-                                                            << next.stop_area << ", zone=" << next.zone
-                                                            << ", section start_zone=" << section_key.start_zone
-                                                            << ", dest_zone=" << section_key.dest_zone
-                                                            << ", start_sa=" << section_key.start_stop_area
-                                                            << ", dest_sa=" << section_key.dest_stop_area
-                                                            << ", mode=" << section_key.mode);
-                            }
+                        if (ticket_od) {
+                            if (label.tickets.size() > 0 && label.current_type == Ticket::ODFare)
+                                ticket_od->sections = label.tickets.back().sections;
+
+                            ticket_od->sections.push_back(section_key);
+                            Label n = next;
+                            n.cost += ticket_od->value;
+                            n.tickets.back() = *ticket_od;
+                            n.current_type = Ticket::FlatFare;
+
+                            new_labels[0].push_back(n);
                         } else {
-                            new_labels[0].push_back(next);
+                            LOG4CPLUS_TRACE(logger, "Unable to get the OD ticket SA="
+                                                        << next.stop_area << ", zone=" << next.zone
+                                                        << ", section start_zone=" << section_key.start_zone
+                                                        << ", dest_zone=" << section_key.dest_zone
+                                                        << ", start_sa=" << section_key.start_stop_area
+                                                        << ", dest_sa=" << section_key.dest_stop_area
+                                                        << ", mode=" << section_key.mode);
                         }
-                        new_labels[v].push_back(next);
+                    } else {
+                        new_labels[0].push_back(next);
                     }
+                    new_labels[arc.target].push_back(std::move(next));
                 }
             }
         }
         // exclusive segment, we have to use that ticket
-        catch (const Ticket& ticket) {
+        if (exclusive_ticket) {
             LOG4CPLUS_TRACE(logger, "\texclusive section for fare");
             new_labels.clear();
             new_labels.resize(nb_nodes);
-            for (Label label : labels.at(0)) {
-                new_labels.at(0).push_back(next_label(label, ticket, section_key));
+            for (const Label& label : labels[0]) {
+                new_labels[0].push_back(next_label(label, *exclusive_ticket, section_key));
             }
         }
+        for (auto& state_labels : new_labels) {
+            remove_dominated_labels(state_labels);
+        }
         labels = std::move(new_labels);
     }
 
@@ -300,13 +449,13 @@ int SectionKey::duration_at_end(int ticket_start_time) const {
         return (dest_time + 24 * 3600) - ticket_start_time;
 }
 
-Ticket DateTicket::get_fare(boost::gregorian::date date) const {
+boost::optional<Ticket> DateTicket::get_fare(boost::gregorian::date date) const {
     for (const auto& dticket : tickets) {
         if (dticket.validity_period.contains(date))
             return dticket.ticket;
     }
 
-    throw no_ticket();
+    return boost::none;
 }
 
 DateTicket DateTicket::operator+(const DateTicket& other) const {
@@ -393,7 +542,7 @@ static boost::optional<OD_map::const_iterator> get_od_dest(const OD_map& od_map,
     return od_t;
 }
 
-DateTicket Fare::get_od(const Label& label, const SectionKey& section) const {
+boost::optional<DateTicket> Fare::get_od(const Label& label, const SectionKey& section) const {
     OD_key o_sa(OD_key::StopArea, label.stop_area);
     OD_key o_mode(OD_key::Mode, label.mode);
     OD_key o_zone(OD_key::Zone, label.zone);
@@ -424,7 +573,7 @@ DateTicket Fare::get_od(const Label& label, const SectionKey& section) const {
         }
     }
     if (!od) {
-        throw no_ticket();
+        return boost::none;
     }
 
     // We create a new ticket, sum of all atomic elements
@@ -39,6 +39,9 @@ www.navitia.io
 #include <boost/date_time/gregorian/greg_serialize.hpp>
 #include "utils/serialization_vector.h"
 #include <boost/serialization/utility.hpp>
+#include <boost/optional.hpp>
+
+#include <memory>
 
 namespace navitia {
 namespace fare {
@@ -144,8 +147,8 @@ struct PeriodTicket {
 struct DateTicket {
     std::vector<PeriodTicket> tickets;
 
-    /// Returns fare for a given date
-    Ticket get_fare(boost::gregorian::date date) const;
+    /// Returns fare for a given date, none if no period covers it
+    boost::optional<Ticket> get_fare(boost::gregorian::date date) const;
 
     /// Add a new period to a ticket
     void add(boost::gregorian::date begin_date, boost::gregorian::date end_date, const Ticket& ticket);
@@ -160,7 +163,6 @@ struct DateTicket {
     }
 };
 
-struct no_ticket {};
 
 /// Defines the current state
 struct State {
@@ -324,6 +326,8 @@ struct results {
     bool not_found = true;
 };
 
+struct FareAutomaton;
+
 /// Contient l'ensemble du système tarifaire
 struct Fare {
     /// Map qui associe les clefs de tarifs aux tarifs
@@ -344,6 +348,13 @@ struct Fare {
     /// Retourne une liste de billets à acheter
     results compute_fare(const routing::Path& path) const;
 
+    /// Prices all the journeys of a response, the transition graph being compiled at most once
+    std::vector<results> compute_fares(const std::vector<routing::Path>& paths) const;
+
+    /// Compiles the transition graph and the ticket keys used by compute_fare
+    /// Must be called again if g or fare_map are modified afterward, without it every call compiles its own copy
+    void build_automaton();
+
     template <class Archive>
     void save(Archive& ar, const unsigned int) const {
         ar& fare_map& od_tickets& g;
@@ -354,17 +365,24 @@ struct Fare {
         // boost adjacency load does not seems to empty the graph, hence there was a memory leak
         g.clear();
         ar& fare_map& od_tickets& g;
+        build_automaton();
     }
     BOOST_SERIALIZATION_SPLIT_MEMBER()
 
     size_t nb_transitions() const;
 
 private:
-    /// Retourne le ticket OD qui va bien ou lève une exception no_ticket si on ne trouve pas
-    DateTicket get_od(const Label& label, const SectionKey& section) const;
+    /// Retourne le ticket OD qui va bien, none si on ne le trouve pas
+    boost::optional<DateTicket> get_od(const Label& label, const SectionKey& section) const;
+
+    std::shared_ptr<const FareAutomaton> get_automaton() const;
+    results compute_fare(const FareAutomaton& automaton, const routing::Path& path) const;
 
     void add_default_ticket();
 
+    /// Compiled graph, shared by the copies of the Fare
+    std::shared_ptr<const FareAutomaton> automaton;
+
     log4cplus::Logger logger = log4cplus::Logger::getInstance("fare");
 };
 
@@ -638,3 +638,41 @@ BOOST_AUTO_TEST_CASE(test_without_file_load_and_unknown_fare) {
     BOOST_REQUIRE_EQUAL(res.tickets.size(), 1);
     BOOST_CHECK_EQUAL(res.tickets.at(0).key, make_default_ticket().key);
 }
+
+BOOST_FIXTURE_TEST_CASE(compute_fares_of_several_journeys, fare_load_fixture) {
+    std::vector<navitia::routing::Path> paths;
+    keys.push_back("Filbleu;FILURSE-2;FILNav31;FILGATO-2;2011|07|01;02|06;02|10;1;1;metro");
+    keys.push_back("Filbleu;FILURSE-2;FILNav31;FILGATO-2;2011|07|01;02|35;02|40;1;1;bus");
+    paths.push_back(string_to_path(keys));
+    keys.clear();
+    keys.push_back("ratp;8711388;8775890;FILGATO-2;2011|07|01;04|40;04|50;4;1;rapidtransit");
+    keys.push_back("ratp;paris;FILNav31;FILGATO-2;2011|07|01;04|40;04|50;1;1;metro");
+    paths.push_back(string_to_path(keys));
+    keys.clear();
+    keys.push_back("ratp;mantes;FILNav31;FILGATO-2;2015|03|11;04|40;04|50;4;1;metro");
+    paths.push_back(string_to_path(keys));
+
+    // the compiled graph must price the journeys as the one built on the fly
+    const auto fares_on_the_fly = f.compute_fares(paths);
+    f.build_automaton();
+    const auto fares = f.compute_fares(paths);
+
+    BOOST_REQUIRE_EQUAL(fares.size(), 3);
+    BOOST_REQUIRE_EQUAL(fares_on_the_fly.size(), 3);
+    for (size_t i = 0; i < fares.size(); ++i) {
+        const auto res = f.compute_fare(paths[i]);
+        BOOST_CHECK_EQUAL(fares[i].total, res.total);
+        BOOST_CHECK_EQUAL(fares_on_the_fly[i].total, res.total);
+        BOOST_REQUIRE_EQUAL(fares[i].tickets.size(), res.tickets.size());
+        for (size_t j = 0; j < res.tickets.size(); ++j) {
+            BOOST_CHECK_EQUAL(fares[i].tickets[j].key, res.tickets[j].key);
+        }
+    }
+    BOOST_REQUIRE_EQUAL(fares[0].tickets.size(), 2);
+    BOOST_CHECK_EQUAL(fares[0].tickets.at(0).value, 170);
+    BOOST_REQUIRE_EQUAL(fares[1].tickets.size(), 1);
+    BOOST_CHECK_EQUAL(fares[1].tickets.at(0).value, 395);
+    BOOST_REQUIRE_EQUAL(fares[2].tickets.size(), 1);
+    BOOST_CHECK_EQUAL(fares[2].tickets.at(0).key, make_default_ticket().key);
+    BOOST_CHECK(fares[2].not_found);
+}
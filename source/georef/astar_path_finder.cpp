@@ -67,7 +67,7 @@ void AstarPathFinder::start_distance_or_target_astar(const navitia::time_duratio
     try {
         astar({starting_edge[source_e], starting_edge[target_e]},
               astar_distance_heuristic(geo_ref.graph, dest_projected, 1. / double(default_speed[mode])),
-              astar_distance_or_target_visitor(radius, distances, destinations));
+              astar_distance_or_target_visitor(radius, distances, destinations, deadline));
     } catch (DestinationFound&) {
     }
 }
@@ -85,11 +85,20 @@ void AstarPathFinder::astar(const std::array<georef::vertex_t, 2>& origin_vertex
     std::fill(color.data.get(), color.data.get() + (color.n + color.elements_per_char - 1) / color.elements_per_char,
               0);
 
-    // we filter the graph to only use certain mean of transport
+    auto filter = TransportationModeFilter(mode, geo_ref);
+    auto combiner = SpeedDistanceCombiner(speed_factor);
+
+    // we filter the graph to only use certain mean of transport, on the compact graph when it has been built
+    if (geo_ref.has_compact_graph()) {
+        using filtered_graph = boost::filtered_graph<CompactGraph, boost::keep_all, TransportationModeFilter>;
+        auto g = filtered_graph(geo_ref.compact_graph, {}, filter);
+        astar_shortest_paths_no_init_with_heap(g, origin_vertexes.front(), origin_vertexes.back(), heuristic, visitor,
+                                               geo_ref.compact_graph.duration_map(), combiner);
+        return;
+    }
     using filtered_graph = boost::filtered_graph<georef::Graph, boost::keep_all, TransportationModeFilter>;
-    auto g = filtered_graph(geo_ref.graph, {}, TransportationModeFilter(mode, geo_ref));
+    auto g = filtered_graph(geo_ref.graph, {}, filter);
     auto weight_map = boost::get(&Edge::duration, geo_ref.graph);
-    auto combiner = SpeedDistanceCombiner(speed_factor);
 
     astar_shortest_paths_no_init_with_heap(g, origin_vertexes.front(), origin_vertexes.back(), heuristic, visitor,
                                            weight_map, combiner);
@@ -0,0 +1,225 @@
+/* Copyright © 2001-2019, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+channel `#navitia` on riot https://riot.im/app/#/room/#navitia:matrix.org
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "georef/astar_path_finder.h"
+#include "georef/contraction_hierarchy_path_finder.h"
+#include "georef/dijkstra_path_finder.h"
+#include "type/data.h"
+#include "utils/init.h"
+
+#include <boost/program_options.hpp>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+
+namespace po = boost::program_options;
+namespace ng = navitia::georef;
+namespace nt = navitia::type;
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsed_seconds(const Clock::time_point& start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// resident memory of the process in MB, 0 if unknown
+static size_t rss_mb() {
+    std::ifstream status("/proc/self/status");
+    std::string key;
+    size_t value = 0;
+    while (status >> key) {
+        if (key == "VmRSS:") {
+            status >> value;
+            return value / 1024;
+        }
+        status.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+    return 0;
+}
+
+struct Stats {
+    size_t nb_found = 0;
+    size_t nb_settled = 0;
+    double seconds = 0;
+    navitia::time_duration total_duration = {};
+
+    void print(const std::string& name, size_t nb_queries) const {
+        std::cout << name << "\t" << nb_found << "\t" << nb_settled / std::max<size_t>(nb_queries, 1) << "\t"
+                  << 1000 * seconds / std::max<size_t>(nb_queries, 1) << "\t" << total_duration << std::endl;
+    }
+};
+
+int main(int argc, char** argv) {
+    navitia::init_app();
+    po::options_description desc("Options of the direct path benchmark");
+    std::string file, mode_name;
+    size_t nb_queries, nb_dijkstra_queries;
+    int max_duration;
+
+    // clang-format off
+    desc.add_options()
+        ("help", "Show this message")
+        ("file,f", po::value<std::string>(&file)->required(), "Path to data.nav.lz4")
+        ("mode,m", po::value<std::string>(&mode_name)->default_value("walking"), "walking, bike or car")
+        ("queries,q", po::value<size_t>(&nb_queries)->default_value(1000), "number of direct paths")
+        ("dijkstra_queries", po::value<size_t>(&nb_dijkstra_queries)->default_value(100),
+         "number of Dijkstra searches up to the max duration")
+        ("max_duration,d", po::value<int>(&max_duration)->default_value(3 * 3600),
+         "max duration in seconds of the direct paths");
+    // clang-format on
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+
+    if (vm.count("help")) {
+        std::cout << "This is used to compare the direct paths computed with the A* (on the compact graph and on "
+                     "the adjacency list) and on the contraction hierarchies, the Dijkstra searches on both graphs "
+                     "and the memory of the compact graph"
+                  << std::endl;
+        std::cout << desc << std::endl;
+        return 1;
+    }
+    po::notify(vm);
+
+    nt::Mode_e mode = nt::Mode_e::Walking;
+    if (mode_name == "bike") {
+        mode = nt::Mode_e::Bike;
+    } else if (mode_name == "car") {
+        // without the parkings, the car then stays on its layer
+        mode = nt::Mode_e::CarNoPark;
+    }
+
+    nt::Data data;
+    data.load_nav(file);
+    auto& geo_ref = *data.geo_ref;
+    std::cout << "RSS after load: " << rss_mb() << " MB" << std::endl;
+    if (!geo_ref.contraction_hierarchy(mode)) {
+        const auto start = Clock::now();
+        geo_ref.build_contraction_hierarchies();
+        std::cout << "contraction hierarchies built in " << elapsed_seconds(start) << "s" << std::endl;
+    }
+    const auto* ch = geo_ref.contraction_hierarchy(mode);
+    std::cout << ch->nb_vertices() << " vertices, " << ch->nb_edges() << " edges, " << ch->nb_shortcuts()
+              << " shortcuts" << std::endl;
+
+    // the origins and destinations are random vertices of the layer
+    const auto& items = mode == nt::Mode_e::Walking ? geo_ref.pl_walking.items
+                                                    : mode == nt::Mode_e::Bike ? geo_ref.pl_bike.items
+                                                                               : geo_ref.pl_car.items;
+    if (items.empty()) {
+        std::cout << "no vertex for this mode" << std::endl;
+        return 1;
+    }
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<size_t> item(0, items.size() - 1);
+    std::vector<std::pair<nt::GeographicalCoord, ng::ProjectionData>> ods;
+    for (size_t i = 0; i < nb_queries; ++i) {
+        ods.emplace_back(items[item(gen)].coord, ng::ProjectionData(items[item(gen)].coord, geo_ref, mode));
+    }
+    const auto max_dur = navitia::seconds(max_duration);
+
+    auto run_astar = [&]() {
+        Stats astar_stats;
+        ng::AstarPathFinder astar(geo_ref);
+        for (const auto& od : ods) {
+            const auto start = Clock::now();
+            astar.init(od.first, od.second.projected, mode, 1);
+            astar.start_distance_or_target_astar(max_dur, od.second.projected,
+                                                 {od.second[ng::source_e], od.second[ng::target_e]});
+            const auto path = astar.get_path(od.second, astar.find_nearest_vertex(od.second, true));
+            astar_stats.seconds += elapsed_seconds(start);
+            // the vertices settled by the A* are the black ones
+            for (ng::vertex_t v = 0; v < astar.costs.size(); ++v) {
+                astar_stats.nb_settled += boost::get(astar.color, v) == boost::two_bit_black;
+            }
+            if (!path.path_items.empty() && path.duration <= max_dur) {
+                ++astar_stats.nb_found;
+                astar_stats.total_duration += path.duration;
+            }
+        }
+        return astar_stats;
+    };
+
+    auto run_dijkstra = [&]() {
+        Stats dijkstra_stats;
+        ng::DijkstraPathFinder dijkstra(geo_ref);
+        for (size_t i = 0; i < std::min(nb_dijkstra_queries, ods.size()); ++i) {
+            const auto start = Clock::now();
+            dijkstra.init(ods[i].first, mode, 1);
+            dijkstra.start_distance_dijkstra(max_dur);
+            dijkstra_stats.seconds += elapsed_seconds(start);
+            for (const auto& distance : dijkstra.distances) {
+                dijkstra_stats.nb_settled += distance <= max_dur;
+            }
+            ++dijkstra_stats.nb_found;
+        }
+        return dijkstra_stats;
+    };
+
+    // as in kraken without GENERAL.street_network_compact_graph, the data is loaded without the compact graph
+    const auto adjacency_list_stats = run_astar();
+    const auto adjacency_list_dijkstra_stats = run_dijkstra();
+
+    const auto rss_before = rss_mb();
+    const auto build_start = Clock::now();
+    geo_ref.build_compact_graph();
+    std::cout << "compact graph built in " << elapsed_seconds(build_start) << "s, "
+              << geo_ref.compact_graph.memory_usage() / (1024 * 1024) << " MB, RSS " << rss_before << " -> "
+              << rss_mb() << " MB" << std::endl;
+    const auto astar_stats = run_astar();
+    const auto dijkstra_stats = run_dijkstra();
+
+    Stats ch_stats;
+    ng::ContractionHierarchyPathFinder ch_path_finder(geo_ref);
+    for (const auto& od : ods) {
+        const auto start = Clock::now();
+        ch_path_finder.init(od.first, mode, 1);
+        const auto path = ch_path_finder.compute_path(*ch, od.second, max_dur);
+        ch_stats.seconds += elapsed_seconds(start);
+        ch_stats.nb_settled += ch_path_finder.nb_settled();
+        if (!path.path_items.empty()) {
+            ++ch_stats.nb_found;
+            ch_stats.total_duration += path.duration;
+        }
+    }
+
+    std::cout << "search\tfound\tsettled vertices/query\tms/query\ttotal duration" << std::endl;
+    astar_stats.print("A*", ods.size());
+    adjacency_list_stats.print("A* (adjacency list)", ods.size());
+    ch_stats.print("CH", ods.size());
+    const auto nb_dijkstra = std::min(nb_dijkstra_queries, ods.size());
+    dijkstra_stats.print("Dijkstra", nb_dijkstra);
+    adjacency_list_dijkstra_stats.print("Dijkstra (adjacency list)", nb_dijkstra);
+    return 0;
+}
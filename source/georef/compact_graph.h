@@ -0,0 +1,209 @@
+/* Copyright © 2001-2019, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+channel `#navitia` on riot https://riot.im/app/#/room/#navitia:matrix.org
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+
+#include "type/time_duration.h"
+
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/properties.hpp>
+#include <boost/iterator/counting_iterator.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace navitia {
+namespace georef {
+
+/// Out edge of the compact graph, only what the shortest path searches need
+struct CompactEdge {
+    uint32_t target;
+    navitia::time_duration duration;  // already on 32 bits, in tenths of seconds
+};
+
+/** Read only copy of the street network graph in compressed sparse rows
+ *
+ * The out edges of all the vertices are packed in one array, those of u
+ * being between first[u] and first[u + 1], in the order of the adjacency
+ * list. An edge is 8 bytes, against a stored edge and a heap allocated
+ * property in the adjacency list, and the edges of consecutive vertices
+ * are contiguous.
+ *
+ * It models the IncidenceGraph and VertexListGraph concepts so that the
+ * Dijkstra and the A* of the path finders can run on it. The edges are
+ * given by their index, which is also the index of the out edge in the
+ * adjacency list of their source, so the ways and geometries are still
+ * found in the adjacency list.
+ */
+class CompactGraph {
+public:
+    using vertex_descriptor = std::size_t;
+
+    struct edge_descriptor {
+        vertex_descriptor source = 0;
+        uint32_t index = 0;
+
+        bool operator==(const edge_descriptor& other) const { return index == other.index; }
+        bool operator!=(const edge_descriptor& other) const { return index != other.index; }
+    };
+
+    class out_edge_iterator : public boost::iterator_facade<out_edge_iterator,
+                                                            edge_descriptor,
+                                                            std::random_access_iterator_tag,
+                                                            edge_descriptor> {
+    public:
+        out_edge_iterator() = default;
+        out_edge_iterator(vertex_descriptor source, uint32_t index) : source(source), index(index) {}
+
+    private:
+        friend class boost::iterator_core_access;
+        vertex_descriptor source = 0;
+        uint32_t index = 0;
+
+        edge_descriptor dereference() const { return {source, index}; }
+        bool equal(const out_edge_iterator& other) const { return index == other.index; }
+        void increment() { ++index; }
+        void decrement() { --index; }
+        void advance(std::ptrdiff_t n) { index += n; }
+        std::ptrdiff_t distance_to(const out_edge_iterator& other) const {
+            return std::ptrdiff_t(other.index) - std::ptrdiff_t(index);
+        }
+    };
+
+    // readable property map of the durations of the edges
+    struct DurationMap {
+        using key_type = edge_descriptor;
+        using value_type = navitia::time_duration;
+        using reference = const navitia::time_duration&;
+        using category = boost::readable_property_map_tag;
+
+        const CompactEdge* edges;
+
+        friend reference get(const DurationMap& map, const edge_descriptor& e) { return map.edges[e.index].duration; }
+    };
+
+    CompactGraph() = default;
+
+    // copy of an adjacency list whose edges have a duration
+    template <typename Graph>
+    explicit CompactGraph(const Graph& graph) {
+        const auto nb_vertices = boost::num_vertices(graph);
+        first.reserve(nb_vertices + 1);
+        first.push_back(0);
+        for (vertex_descriptor u = 0; u < nb_vertices; ++u) {
+            for (auto range = boost::out_edges(u, graph); range.first != range.second; ++range.first) {
+                edges.push_back({uint32_t(boost::target(*range.first, graph)), graph[*range.first].duration});
+            }
+            first.push_back(edges.size());
+        }
+        edges.shrink_to_fit();
+    }
+
+    std::size_t num_vertices() const { return first.empty() ? 0 : first.size() - 1; }
+    std::size_t num_edges() const { return edges.size(); }
+    std::size_t memory_usage() const {
+        return first.capacity() * sizeof(uint32_t) + edges.capacity() * sizeof(CompactEdge);
+    }
+
+    const CompactEdge& operator[](const edge_descriptor& e) const { return edges[e.index]; }
+    DurationMap duration_map() const { return {edges.data()}; }
+
+    std::pair<out_edge_iterator, out_edge_iterator> out_edges(vertex_descriptor u) const {
+        return {{u, first[u]}, {u, first[u + 1]}};
+    }
+    std::size_t out_degree(vertex_descriptor u) const { return first[u + 1] - first[u]; }
+
+private:
+    std::vector<uint32_t> first;
+    std::vector<CompactEdge> edges;
+};
+
+// Boost Graph Library interface, found by argument dependent lookup
+
+inline std::pair<CompactGraph::out_edge_iterator, CompactGraph::out_edge_iterator> out_edges(
+    CompactGraph::vertex_descriptor u,
+    const CompactGraph& g) {
+    return g.out_edges(u);
+}
+
+inline std::size_t out_degree(CompactGraph::vertex_descriptor u, const CompactGraph& g) {
+    return g.out_degree(u);
+}
+
+inline CompactGraph::vertex_descriptor source(const CompactGraph::edge_descriptor& e, const CompactGraph&) {
+    return e.source;
+}
+
+inline CompactGraph::vertex_descriptor target(const CompactGraph::edge_descriptor& e, const CompactGraph& g) {
+    return g[e].target;
+}
+
+inline std::size_t num_vertices(const CompactGraph& g) {
+    return g.num_vertices();
+}
+
+inline std::pair<boost::counting_iterator<std::size_t>, boost::counting_iterator<std::size_t>> vertices(
+    const CompactGraph& g) {
+    return {0, g.num_vertices()};
+}
+
+}  // namespace georef
+}  // namespace navitia
+
+namespace boost {
+
+template <>
+struct graph_traits<navitia::georef::CompactGraph> {
+    using G = navitia::georef::CompactGraph;
+    struct traversal_category : incidence_graph_tag, vertex_list_graph_tag {};
+
+    using vertex_descriptor = G::vertex_descriptor;
+    using edge_descriptor = G::edge_descriptor;
+    using directed_category = directed_tag;
+    using edge_parallel_category = allow_parallel_edge_tag;
+
+    using out_edge_iterator = G::out_edge_iterator;
+    using degree_size_type = std::size_t;
+    using vertex_iterator = counting_iterator<std::size_t>;
+    using vertices_size_type = std::size_t;
+    using edges_size_type = std::size_t;
+
+    // not modeled, only declared for the filtered_graph
+    using in_edge_iterator = void;
+    using edge_iterator = void;
+    using adjacency_iterator = void;
+
+    static vertex_descriptor null_vertex() { return std::numeric_limits<vertex_descriptor>::max(); }
+};
+
+}  // namespace boost
@@ -0,0 +1,393 @@
+/* Copyright © 2001-2019, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+channel `#navitia` on riot https://riot.im/app/#/room/#navitia:matrix.org
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "contraction_hierarchy.h"
+#include "visitor.h"
+
+#include "utils/exception.h"
+
+#include <boost/optional.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+namespace navitia {
+namespace georef {
+
+constexpr uint32_t CHEdge::no_middle;
+constexpr uint32_t ContractionHierarchyQuery::none;
+
+namespace {
+
+// the witness searches are stopped after this number of settled vertices, a few useless shortcuts being added
+// then. The searches only estimating the shortcuts to order the contraction are shorter
+constexpr size_t max_witness_settled = 500;
+constexpr size_t max_simulation_witness_settled = 50;
+
+struct Arc {
+    uint32_t other;
+    uint32_t middle;
+    navitia::time_duration duration;
+};
+
+// graph being contracted, a contracted vertex is removed from the arcs of its neighbours
+struct DynamicGraph {
+    std::vector<std::vector<Arc>> out;
+    std::vector<std::vector<Arc>> in;
+
+    explicit DynamicGraph(uint32_t nb_vertices) : out(nb_vertices), in(nb_vertices) {}
+
+    // add the arc u -> v, or shorten it if it already exists
+    void add(uint32_t u, uint32_t v, uint32_t middle, navitia::time_duration duration) {
+        auto it = std::find_if(out[u].begin(), out[u].end(), [&](const Arc& a) { return a.other == v; });
+        if (it == out[u].end()) {
+            out[u].push_back({v, middle, duration});
+            in[v].push_back({u, middle, duration});
+            return;
+        }
+        if (it->duration <= duration) {
+            return;
+        }
+        *it = {v, middle, duration};
+        auto jt = std::find_if(in[v].begin(), in[v].end(), [&](const Arc& a) { return a.other == u; });
+        *jt = {u, middle, duration};
+    }
+
+    void disconnect(uint32_t v) {
+        auto erase_arcs_to_v = [v](std::vector<Arc>& arcs) {
+            arcs.erase(std::remove_if(arcs.begin(), arcs.end(), [v](const Arc& a) { return a.other == v; }),
+                       arcs.end());
+        };
+        for (const auto& arc : out[v]) {
+            erase_arcs_to_v(in[arc.other]);
+        }
+        for (const auto& arc : in[v]) {
+            erase_arcs_to_v(out[arc.other]);
+        }
+        std::vector<Arc>().swap(out[v]);
+        std::vector<Arc>().swap(in[v]);
+    }
+};
+
+// bounded Dijkstra looking for paths as short as the shortcuts we would add
+class WitnessSearch {
+    using QueueItem = std::pair<navitia::time_duration, uint32_t>;
+    std::vector<navitia::time_duration> durations;
+    std::vector<uint32_t> touched;
+    std::vector<QueueItem> queue;
+
+public:
+    explicit WitnessSearch(uint32_t nb_vertices) : durations(nb_vertices, boost::date_time::pos_infin) {}
+
+    // durations from source to the vertices reachable without going through avoided
+    void run(const DynamicGraph& g,
+             uint32_t source,
+             uint32_t avoided,
+             navitia::time_duration max_duration,
+             size_t max_settled) {
+        for (const auto v : touched) {
+            durations[v] = boost::date_time::pos_infin;
+        }
+        touched.clear();
+        queue.clear();
+        push(source, {});
+        size_t nb_settled = 0;
+        while (!queue.empty() && nb_settled < max_settled) {
+            std::pop_heap(queue.begin(), queue.end(), std::greater<QueueItem>());
+            const auto item = queue.back();
+            queue.pop_back();
+            if (item.first > durations[item.second]) {
+                continue;
+            }
+            if (item.first > max_duration) {
+                break;
+            }
+            ++nb_settled;
+            for (const auto& arc : g.out[item.second]) {
+                if (arc.other != avoided) {
+                    push(arc.other, item.first + arc.duration);
+                }
+            }
+        }
+    }
+
+    navitia::time_duration duration(uint32_t v) const { return durations[v]; }
+
+private:
+    void push(uint32_t v, navitia::time_duration duration) {
+        if (duration >= durations[v]) {
+            return;
+        }
+        if (durations[v] == boost::date_time::pos_infin) {
+            touched.push_back(v);
+        }
+        durations[v] = duration;
+        queue.emplace_back(duration, v);
+        std::push_heap(queue.begin(), queue.end(), std::greater<QueueItem>());
+    }
+};
+
+// number of shortcuts needed to contract v, they are added to the graph if not simulated
+size_t contract(DynamicGraph& g, WitnessSearch& witness, uint32_t v, bool simulate) {
+    size_t nb_shortcuts = 0;
+    for (const auto& in_arc : g.in[v]) {
+        const auto u = in_arc.other;
+        boost::optional<navitia::time_duration> max_duration;
+        for (const auto& out_arc : g.out[v]) {
+            if (out_arc.other != u) {
+                max_duration = std::max(max_duration.value_or(navitia::time_duration()),
+                                        in_arc.duration + out_arc.duration);
+            }
+        }
+        if (!max_duration) {
+            continue;
+        }
+        witness.run(g, u, v, *max_duration, simulate ? max_simulation_witness_settled : max_witness_settled);
+        for (const auto& out_arc : g.out[v]) {
+            const auto x = out_arc.other;
+            const auto duration = in_arc.duration + out_arc.duration;
+            if (x == u || witness.duration(x) <= duration) {
+                continue;
+            }
+            ++nb_shortcuts;
+            if (!simulate) {
+                g.add(u, x, v, duration);
+            }
+        }
+    }
+    return nb_shortcuts;
+}
+
+void flatten(const std::vector<std::vector<CHEdge>>& rows, std::vector<uint32_t>& first, std::vector<CHEdge>& edges) {
+    first.assign(1, 0);
+    edges.clear();
+    for (const auto& row : rows) {
+        edges.insert(edges.end(), row.begin(), row.end());
+        first.push_back(edges.size());
+    }
+}
+
+}  // namespace
+
+ContractionHierarchy::ContractionHierarchy(uint32_t offset,
+                                           uint32_t nb_vertices,
+                                           const std::vector<InputEdge>& edges)
+    : offset_(offset) {
+    DynamicGraph g(nb_vertices);
+    for (const auto& e : edges) {
+        if (e.source != e.target) {
+            g.add(e.source, e.target, CHEdge::no_middle, e.duration);
+        }
+    }
+
+    // the vertices are contracted by increasing edge difference (shortcuts added minus edges removed), the
+    // number of contracted neighbours being added to spread the contraction over the graph
+    WitnessSearch witness(nb_vertices);
+    std::vector<int> nb_contracted_neighbours(nb_vertices, 0);
+    auto priority = [&](uint32_t v) {
+        const int edge_difference = int(contract(g, witness, v, true)) - int(g.in[v].size() + g.out[v].size());
+        return 2 * edge_difference + nb_contracted_neighbours[v];
+    };
+    using QueueItem = std::pair<int, uint32_t>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    for (uint32_t v = 0; v < nb_vertices; ++v) {
+        queue.emplace(priority(v), v);
+    }
+
+    std::vector<std::vector<CHEdge>> forward_rows(nb_vertices), backward_rows(nb_vertices);
+    while (!queue.empty()) {
+        const auto v = queue.top().second;
+        queue.pop();
+        // lazy update, the priority may have changed since v has been pushed
+        const auto p = priority(v);
+        if (!queue.empty() && p > queue.top().first) {
+            queue.emplace(p, v);
+            continue;
+        }
+        contract(g, witness, v, false);
+        // all the remaining neighbours will be contracted after v, they are thus ranked higher
+        for (const auto& arc : g.out[v]) {
+            forward_rows[v].emplace_back(arc.other, arc.middle, arc.duration);
+            ++nb_contracted_neighbours[arc.other];
+        }
+        for (const auto& arc : g.in[v]) {
+            backward_rows[v].emplace_back(arc.other, arc.middle, arc.duration);
+            ++nb_contracted_neighbours[arc.other];
+        }
+        g.disconnect(v);
+    }
+    flatten(forward_rows, forward_first, forward_edges);
+    flatten(backward_rows, backward_first, backward_edges);
+}
+
+size_t ContractionHierarchy::nb_shortcuts() const {
+    auto is_shortcut = [](const CHEdge& e) { return e.is_shortcut(); };
+    return std::count_if(forward_edges.begin(), forward_edges.end(), is_shortcut)
+           + std::count_if(backward_edges.begin(), backward_edges.end(), is_shortcut);
+}
+
+void ContractionHierarchy::unpack(uint32_t from, uint32_t to, uint32_t middle, std::vector<uint32_t>& path) const {
+    if (middle == CHEdge::no_middle) {
+        path.push_back(to);
+        return;
+    }
+    // middle has been contracted before both ends, the two edges are thus stored on it
+    auto find_middle = [](const EdgeRange& edges, uint32_t head) {
+        for (const auto& e : edges) {
+            if (e.head == head) {
+                return e.middle;
+            }
+        }
+        throw navitia::exception("contraction hierarchy: unable to unpack a shortcut");
+    };
+    unpack(from, middle, find_middle(backward(middle), from), path);
+    unpack(middle, to, find_middle(forward(middle), to), path);
+}
+
+void ContractionHierarchyQuery::reset(uint32_t nb_vertices) {
+    for (int dir : {0, 1}) {
+        if (labels[dir].size() != nb_vertices) {
+            labels[dir].assign(nb_vertices, Label());
+        } else {
+            for (const auto v : touched[dir]) {
+                labels[dir][v] = Label();
+            }
+        }
+        touched[dir].clear();
+        queues[dir].clear();
+    }
+}
+
+void ContractionHierarchyQuery::relax(int dir,
+                                      uint32_t v,
+                                      navitia::time_duration duration,
+                                      uint32_t parent,
+                                      uint32_t middle) {
+    auto& label = labels[dir][v];
+    if (duration >= label.duration) {
+        return;
+    }
+    if (label.duration == boost::date_time::pos_infin) {
+        touched[dir].push_back(v);
+    }
+    label = {duration, parent, middle};
+    queues[dir].emplace_back(duration, v);
+    std::push_heap(queues[dir].begin(), queues[dir].end(), std::greater<QueueItem>());
+}
+
+ContractionHierarchyQuery::Result ContractionHierarchyQuery::compute(const ContractionHierarchy& ch,
+                                                                     const std::vector<Seed>& sources,
+                                                                     const std::vector<Seed>& targets,
+                                                                     float speed_factor,
+                                                                     const navitia::time_duration& max_duration,
+                                                                     const navitia::Deadline* deadline) {
+    // a query settles few vertices, the deadline is checked once before it and every few thousands settled ones
+    if (deadline != nullptr) {
+        deadline->check();
+    }
+    DeadlineCheck check_deadline(deadline);
+    Result result;
+    nb_settled = 0;
+    reset(ch.nb_vertices());
+    auto seed = [&](int dir, const std::vector<Seed>& seeds) {
+        for (const auto& s : seeds) {
+            if (s.first >= ch.offset() && s.first - ch.offset() < ch.nb_vertices()) {
+                relax(dir, s.first - ch.offset(), s.second, none, CHEdge::no_middle);
+            }
+        }
+    };
+    seed(0, sources);
+    seed(1, targets);
+
+    // both searches only go up the hierarchy, we always settle the smallest of their two next vertices so we
+    // can stop as soon as it is not shorter than the best path found
+    const float inv_speed_factor = 1.f / speed_factor;
+    uint32_t meeting = none;
+    while (true) {
+        int dir = -1;
+        for (int d : {0, 1}) {
+            if (!queues[d].empty() && (dir < 0 || queues[d].front().first < queues[dir].front().first)) {
+                dir = d;
+            }
+        }
+        if (dir < 0) {
+            break;
+        }
+        auto& queue = queues[dir];
+        std::pop_heap(queue.begin(), queue.end(), std::greater<QueueItem>());
+        const auto item = queue.back();
+        queue.pop_back();
+        const auto u = item.second;
+        if (item.first > labels[dir][u].duration) {
+            continue;
+        }
+        if (item.first >= result.duration || item.first > max_duration) {
+            break;
+        }
+        ++nb_settled;
+        check_deadline();
+        const auto& other_duration = labels[1 - dir][u].duration;
+        if (other_duration != boost::date_time::pos_infin && item.first + other_duration < result.duration) {
+            result.duration = item.first + other_duration;
+            meeting = u;
+        }
+        for (const auto& e : dir == 0 ? ch.forward(u) : ch.backward(u)) {
+            relax(dir, e.head, item.first + e.duration * inv_speed_factor, u, e.middle);
+        }
+    }
+    if (meeting == none || result.duration > max_duration) {
+        result.duration = boost::date_time::pos_infin;
+        return result;
+    }
+
+    // from a source up to the meeting vertex
+    std::vector<uint32_t> chain;
+    uint32_t v = meeting;
+    for (; labels[0][v].parent != none; v = labels[0][v].parent) {
+        chain.push_back(v);
+    }
+    auto& path = result.vertices;
+    path.push_back(v);
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        ch.unpack(labels[0][*it].parent, *it, labels[0][*it].middle, path);
+    }
+    // then down to a target, the backward labels are on the reversed edges
+    for (v = meeting; labels[1][v].parent != none; v = labels[1][v].parent) {
+        ch.unpack(v, labels[1][v].parent, labels[1][v].middle, path);
+    }
+    for (auto& vertex : path) {
+        vertex += ch.offset();
+    }
+    return result;
+}
+
+}  // namespace georef
+}  // namespace navitia
@@ -0,0 +1,191 @@
+/* Copyright © 2001-2019, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+channel `#navitia` on riot https://riot.im/app/#/room/#navitia:matrix.org
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+
+#include "type/time_duration.h"
+#include "utils/deadline.h"
+#include "utils/serialization_vector.h"
+
+#include <boost/range/iterator_range.hpp>
+#include <boost/serialization/serialization.hpp>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace navitia {
+namespace georef {
+
+/** Edge of a contraction hierarchy
+ *
+ * The edges are stored on their lowest ranked end, head being the other end.
+ * A shortcut replaces the two edges going through the vertex middle,
+ * contracted before both of its ends.
+ */
+struct CHEdge {
+    static constexpr uint32_t no_middle = std::numeric_limits<uint32_t>::max();
+
+    uint32_t head = 0;
+    uint32_t middle = no_middle;
+    navitia::time_duration duration = {};
+
+    CHEdge() = default;
+    CHEdge(uint32_t head, uint32_t middle, navitia::time_duration duration)
+        : head(head), middle(middle), duration(duration) {}
+
+    bool is_shortcut() const { return middle != no_middle; }
+
+    template <class Archive>
+    void serialize(Archive& ar, const unsigned int) {
+        ar& head& middle& duration;
+    }
+};
+
+/** Contraction hierarchy of one layer of the street network graph
+ *
+ * The vertices are contracted one after the other, shortcuts being added
+ * between their neighbours when no other path (witness) is as short.
+ * A shortest path is then found by two Dijkstra only going up the
+ * hierarchy: a forward one from the sources and a backward one from the
+ * targets.
+ *
+ * The vertices are those of a layer of GeoRef::graph, numbered from 0
+ * (the vertex v of the graph being v - offset). Both the edges from a
+ * vertex to a higher ranked one (forward) and from a higher ranked one to
+ * a vertex (backward) are stored on the vertex, in compressed rows.
+ */
+class ContractionHierarchy {
+public:
+    // edge of the layer to contract, between vertices numbered from 0
+    struct InputEdge {
+        uint32_t source;
+        uint32_t target;
+        navitia::time_duration duration;
+    };
+    using EdgeRange = boost::iterator_range<std::vector<CHEdge>::const_iterator>;
+
+    ContractionHierarchy() = default;
+
+    /**
+     * Contract the nb_vertices vertices of the layer starting at offset
+     *
+     * Only the shortest of the parallel edges is kept, loops are ignored.
+     **/
+    ContractionHierarchy(uint32_t offset, uint32_t nb_vertices, const std::vector<InputEdge>& edges);
+
+    uint32_t offset() const { return offset_; }
+    uint32_t nb_vertices() const { return forward_first.empty() ? 0 : forward_first.size() - 1; }
+    size_t nb_edges() const { return forward_edges.size() + backward_edges.size(); }
+    size_t nb_shortcuts() const;
+
+    // edges u -> v, v being ranked higher than u
+    EdgeRange forward(uint32_t u) const { return row(forward_first, forward_edges, u); }
+    // edges v -> u, v being ranked higher than u, head being v
+    EdgeRange backward(uint32_t u) const { return row(backward_first, backward_edges, u); }
+
+    /**
+     * Append to path the vertices (numbered in the layer) after from up to to,
+     * following the edge from -> to of the hierarchy going through middle
+     **/
+    void unpack(uint32_t from, uint32_t to, uint32_t middle, std::vector<uint32_t>& path) const;
+
+    template <class Archive>
+    void serialize(Archive& ar, const unsigned int) {
+        ar& offset_& forward_first& forward_edges& backward_first& backward_edges;
+    }
+
+private:
+    uint32_t offset_ = 0;
+    std::vector<uint32_t> forward_first;
+    std::vector<CHEdge> forward_edges;
+    std::vector<uint32_t> backward_first;
+    std::vector<CHEdge> backward_edges;
+
+    static EdgeRange row(const std::vector<uint32_t>& first, const std::vector<CHEdge>& edges, uint32_t u) {
+        return {edges.begin() + first[u], edges.begin() + first[u + 1]};
+    }
+};
+
+/**
+ * Bidirectional shortest path search on a contraction hierarchy
+ *
+ * The structure holds the labels of the searches so that they are not
+ * allocated for each query, it is thus not to be shared between threads.
+ */
+class ContractionHierarchyQuery {
+public:
+    // vertex of the graph and duration to add when starting or ending there
+    using Seed = std::pair<uint32_t, navitia::time_duration>;
+
+    struct Result {
+        navitia::time_duration duration = boost::date_time::pos_infin;
+        std::vector<uint32_t> vertices;  //< vertices of the graph, from a source to a target, empty if not found
+    };
+
+    /**
+     * Shortest path from one of the sources to one of the targets
+     *
+     * The durations of the edges are divided by speed_factor, as the
+     * SpeedDistanceCombiner does, and no path longer than max_duration is
+     * searched. The deadline, if any, is checked before the search and every
+     * few settled vertices, navitia::DeadlineExpired is thrown once it has expired.
+     **/
+    Result compute(const ContractionHierarchy& ch,
+                   const std::vector<Seed>& sources,
+                   const std::vector<Seed>& targets,
+                   float speed_factor,
+                   const navitia::time_duration& max_duration,
+                   const navitia::Deadline* deadline = nullptr);
+
+    // number of vertices settled by the last query, both directions included
+    size_t nb_settled = 0;
+
+private:
+    static constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+
+    struct Label {
+        navitia::time_duration duration = boost::date_time::pos_infin;
+        uint32_t parent = none;
+        uint32_t middle = CHEdge::no_middle;
+    };
+    using QueueItem = std::pair<navitia::time_duration, uint32_t>;
+
+    // forward and backward labels, by vertex of the hierarchy
+    std::vector<Label> labels[2];
+    std::vector<uint32_t> touched[2];
+    std::vector<QueueItem> queues[2];
+
+    void reset(uint32_t nb_vertices);
+    void relax(int dir, uint32_t v, navitia::time_duration duration, uint32_t parent, uint32_t middle);
+};
+
+}  // namespace georef
+}  // namespace navitia
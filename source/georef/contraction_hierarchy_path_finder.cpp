@@ -0,0 +1,81 @@
+/* Copyright © 2001-2019, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+channel `#navitia` on riot https://riot.im/app/#/room/#navitia:matrix.org
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "contraction_hierarchy_path_finder.h"
+
+namespace navitia {
+namespace georef {
+
+ContractionHierarchyPathFinder::~ContractionHierarchyPathFinder() = default;
+
+Path ContractionHierarchyPathFinder::compute_path(const ContractionHierarchy& ch,
+                                                  const ProjectionData& destination,
+                                                  const navitia::time_duration& max_duration) {
+    if (!starting_edge.found || !destination.found) {
+        return {};
+    }
+    computation_launch = true;
+
+    // the ends of the starting edge have been initialized by init_start
+    std::vector<ContractionHierarchyQuery::Seed> sources;
+    for (const auto d : {source_e, target_e}) {
+        const auto v = starting_edge[d];
+        if (distances[v] != bt::pos_infin) {
+            sources.emplace_back(v, distances[v]);
+        }
+    }
+    // as in find_nearest_vertex, a destination projected on a node only ends there
+    std::vector<ContractionHierarchyQuery::Seed> targets;
+    for (const auto d : {source_e, target_e}) {
+        if (destination.distances[d] < 0.01) {
+            targets.assign(1, {destination[d], {}});
+            break;
+        }
+        targets.emplace_back(destination[d], crow_fly_duration(destination.distances[d]));
+    }
+
+    const auto res = query.compute(ch, sources, targets, speed_factor, max_duration, deadline);
+    if (res.vertices.empty()) {
+        return {};
+    }
+    predecessors[res.vertices.front()] = res.vertices.front();
+    for (size_t i = 1; i < res.vertices.size(); ++i) {
+        predecessors[res.vertices[i]] = res.vertices[i - 1];
+    }
+    const auto direction = res.vertices.back() == destination[source_e] ? source_e : target_e;
+    auto path = get_path(destination, {res.duration, direction});
+    if (path.duration > max_duration) {
+        return {};
+    }
+    return path;
+}
+
+}  // namespace georef
+}  // namespace navitia
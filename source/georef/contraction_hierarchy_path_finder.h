@@ -0,0 +1,69 @@
+/* Copyright © 2001-2019, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+channel `#navitia` on riot https://riot.im/app/#/room/#navitia:matrix.org
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+
+#include "path_finder.h"
+#include "contraction_hierarchy.h"
+
+namespace navitia {
+namespace georef {
+
+/**
+ * Direct paths computed on the contraction hierarchy of a layer
+ *
+ * The shortest path found on the hierarchy is unpacked to the vertices of
+ * the graph and set in the predecessors, the Path is then built as with the
+ * other path finders.
+ */
+class ContractionHierarchyPathFinder : public PathFinder {
+public:
+    ContractionHierarchyPathFinder(const GeoRef& geo_ref) : PathFinder(geo_ref) {}
+    ContractionHierarchyPathFinder(const ContractionHierarchyPathFinder& o) = default;
+    virtual ~ContractionHierarchyPathFinder();
+
+    void init(const type::GeographicalCoord& start_coord, nt::Mode_e mode, const float speed_factor) {
+        PathFinder::init_start(start_coord, mode, speed_factor);
+    }
+
+    // path to the destination projected on the layer of the hierarchy, empty if longer than max_duration
+    Path compute_path(const ContractionHierarchy& ch,
+                      const ProjectionData& destination,
+                      const navitia::time_duration& max_duration);
+
+    // number of vertices settled by the last search
+    size_t nb_settled() const { return query.nb_settled; }
+
+private:
+    ContractionHierarchyQuery query;
+};
+
+}  // namespace georef
+}  // namespace navitia
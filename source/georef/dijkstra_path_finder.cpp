@@ -34,6 +34,8 @@ www.navitia.io
 
 #include <boost/graph/dijkstra_shortest_paths.hpp>
 
+#include <numeric>
+
 namespace navitia {
 namespace georef {
 
@@ -45,7 +47,8 @@ void DijkstraPathFinder::start_distance_dijkstra(const navitia::time_duration& r
     computation_launch = true;
     // We start dijkstra from source and target nodes
     try {
-        dijkstra({starting_edge[source_e], starting_edge[target_e]}, dijkstra_distance_visitor(radius, distances));
+        dijkstra({starting_edge[source_e], starting_edge[target_e]},
+                 dijkstra_distance_visitor(radius, distances, deadline));
     } catch (DestinationFound) {
     }
 }
@@ -56,6 +59,9 @@ static routing::SpIdx get_id(const routing::SpIdx& idx) {
 static std::string get_id(const type::GeographicalCoord& coord) {
     return coord.uri();
 }
+static size_t get_id(const size_t i) {
+    return i;
+}
 
 template <typename K, typename U, typename G>
 boost::container::flat_map<K, georef::RoutingElement> DijkstraPathFinder::start_dijkstra_and_fill_duration_map(
@@ -195,6 +201,29 @@ DijkstraPathFinder::get_duration_with_dijkstra(const navitia::time_duration& rad
                                                 ProjectionGetterOnFly>(radius, dest_coords, projection_getter);
 }
 
+struct ProjectionGetterByIndex {
+    const std::vector<georef::ProjectionData>& projections;
+    const georef::ProjectionData& operator()(const size_t i) const { return projections[i]; }
+};
+
+std::vector<georef::RoutingElement> DijkstraPathFinder::get_duration_with_dijkstra(
+    const navitia::time_duration& radius,
+    const std::vector<ProjectionData>& projections) {
+    std::vector<size_t> dests(projections.size());
+    std::iota(dests.begin(), dests.end(), 0);
+    ProjectionGetterByIndex projection_getter{projections};
+    const auto durations = start_dijkstra_and_fill_duration_map<size_t, size_t, ProjectionGetterByIndex>(
+        radius, dests, projection_getter);
+
+    // the durations are sorted by index
+    std::vector<georef::RoutingElement> res;
+    res.reserve(durations.size());
+    for (const auto& duration : durations) {
+        res.push_back(duration.second);
+    }
+    return res;
+}
+
 template <class Visitor>
 void DijkstraPathFinder::dijkstra(const std::array<georef::vertex_t, 2>& origin_vertexes, const Visitor& visitor) {
     // Note: the predecessors have been updated in init
@@ -202,11 +231,21 @@ void DijkstraPathFinder::dijkstra(const std::array<georef::vertex_t, 2>& origin_
     std::fill(color.data.get(), color.data.get() + (color.n + color.elements_per_char - 1) / color.elements_per_char,
               0);
 
+    auto const filter = TransportationModeFilter(mode, geo_ref);
+    auto const combiner = SpeedDistanceCombiner(speed_factor);  // we multiply the edge duration by a speed factor
+
     // we filter the graph to only use certain mean of transport
+    // the compact graph is preferred, the adjacency list is used when it has not been built
+    if (geo_ref.has_compact_graph()) {
+        using filtered_graph = boost::filtered_graph<CompactGraph, boost::keep_all, TransportationModeFilter>;
+        auto const g = filtered_graph(geo_ref.compact_graph, {}, filter);
+        dijkstra_shortest_paths_no_init_with_heap(g, origin_vertexes.front(), origin_vertexes.back(), visitor,
+                                                  geo_ref.compact_graph.duration_map(), combiner);
+        return;
+    }
     using filtered_graph = boost::filtered_graph<georef::Graph, boost::keep_all, TransportationModeFilter>;
-    auto const g = filtered_graph(geo_ref.graph, {}, TransportationModeFilter(mode, geo_ref));
+    auto const g = filtered_graph(geo_ref.graph, {}, filter);
     auto const weight_map = boost::get(&Edge::duration, geo_ref.graph);
-    auto const combiner = SpeedDistanceCombiner(speed_factor);  // we multiply the edge duration by a speed factor
 
     dijkstra_shortest_paths_no_init_with_heap(g, origin_vertexes.front(), origin_vertexes.back(), visitor, weight_map,
                                               combiner);
@@ -224,7 +263,7 @@ std::pair<navitia::time_duration, ProjectionData::Direction> DijkstraPathFinder:
         bool found = false;
         try {
             dijkstra({starting_edge[source_e], starting_edge[target_e]},
-                     dijkstra_target_all_visitor({target[source_e], target[target_e]}));
+                     dijkstra_target_all_visitor({target[source_e], target[target_e]}, deadline));
         } catch (DestinationFound) {
             found = true;
         }
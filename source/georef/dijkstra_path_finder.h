@@ -59,6 +59,10 @@ public:
         const navitia::time_duration& radius,
         const std::vector<type::GeographicalCoord>& entry_points);
 
+    // durations to destinations already projected, in the same order
+    std::vector<georef::RoutingElement> get_duration_with_dijkstra(const navitia::time_duration& radius,
+                                                                   const std::vector<ProjectionData>& projections);
+
     /**
      * Launch a dijkstra without initializing the data structure
      * Warning, it modifies the distances and the predecessors
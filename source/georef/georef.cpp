@@ -42,8 +42,10 @@ www.navitia.io
 #include <boost/range/algorithm/lexicographical_compare.hpp>
 #include <boost/math/constants/constants.hpp>
 #include <array>
+#include <future>
 #include <unordered_map>
 #include "type/stop_area.h"
+#include "type/flat_nav.h"
 #include "type/type.h"  //TODO: move get_admin_name and reduce include
 
 using navitia::type::idx_t;
@@ -357,6 +359,7 @@ static bool is_sn_edge(const GeoRef& georef, const edge_t& e) {
  * walking graph offset)
  */
 void GeoRef::init() {
+    compact_graph = CompactGraph();
     offsets[nt::Mode_e::Walking] = 0;
     offsets[nt::Mode_e::Bss] = 0;
 
@@ -373,7 +376,7 @@ void GeoRef::init() {
     offsets[nt::Mode_e::CarNoPark] = offsets[nt::Mode_e::Car];
 }
 
-void GeoRef::build_proximity_list() {
+void GeoRef::build_proximity_list(const type::FlatNav* flat_nav) {
     pl_walking.clear();
     pl_bike.clear();
     pl_car.clear();
@@ -381,7 +384,19 @@ void GeoRef::build_proximity_list() {
 
     auto log = log4cplus::Logger::getInstance("GeoRef::build_proximity_list");
 
-    auto build_sn_pl = [this](proximitylist::ProximityList<vertex_t>& sn_pl, nt::idx_t offset) {
+    using Item = proximitylist::ProximityList<vertex_t>::Item;
+    auto build_sn_pl = [this, flat_nav, &log](proximitylist::ProximityList<vertex_t>& sn_pl, nt::idx_t offset,
+                                              const std::string& name) {
+        if (flat_nav) {
+            const auto items = flat_nav->section<Item>("georef." + name + ".items");
+            const auto coords = flat_nav->section<float>("georef." + name + ".coords");
+            if (!items.empty() && coords.size() == 3 * items.size()) {
+                LOG4CPLUS_INFO(log, "Using the flat file for " << name);
+                sn_pl.items.assign(items.begin(), items.end());
+                sn_pl.build(coords.begin());
+                return;
+            }
+        }
         for (vertex_t v = offset; v < nb_vertex_by_mode + offset; ++v) {
             if (boost::algorithm::none_of(boost::out_edges(v, graph),
                                           [=](const auto& e) { return is_sn_edge(*this, e); }))
@@ -392,19 +407,95 @@ void GeoRef::build_proximity_list() {
     };
 
     LOG4CPLUS_INFO(log, "Building Proximity list for walking graph");
-    build_sn_pl(pl_walking, offsets[nt::Mode_e::Walking]);
+    build_sn_pl(pl_walking, offsets[nt::Mode_e::Walking], "pl_walking");
 
     LOG4CPLUS_INFO(log, "Building Proximity list for bike graph");
-    build_sn_pl(pl_bike, offsets[nt::Mode_e::Bike]);
+    build_sn_pl(pl_bike, offsets[nt::Mode_e::Bike], "pl_bike");
 
     LOG4CPLUS_INFO(log, "Building Proximity list for car graph");
-    build_sn_pl(pl_car, offsets[nt::Mode_e::Car]);
+    build_sn_pl(pl_car, offsets[nt::Mode_e::Car], "pl_car");
 
     LOG4CPLUS_INFO(log, "Building Proximity list for POIs");
     for (const POI* poi : pois) {
         poi_proximity_list.add(poi->coord, poi->idx);
     }
-    poi_proximity_list.build();
+    const auto poi_coords =
+        flat_nav ? flat_nav->section<float>("georef.poi.coords") : boost::iterator_range<const float*>();
+    if (!poi_coords.empty() && poi_coords.size() == 3 * poi_proximity_list.items.size()) {
+        poi_proximity_list.build(poi_coords.begin());
+    } else {
+        poi_proximity_list.build();
+    }
+}
+
+edge_t GeoRef::add_edge(vertex_t source, vertex_t target, const Edge& edge) {
+    compact_graph = CompactGraph();
+    return boost::add_edge(source, target, edge, graph).first;
+}
+
+void GeoRef::build_compact_graph() {
+    auto log = log4cplus::Logger::getInstance("GeoRef::build_compact_graph");
+    compact_graph = CompactGraph(graph);
+    LOG4CPLUS_INFO(log, "compact graph built: " << compact_graph.num_vertices() << " vertices, "
+                                                << compact_graph.num_edges() << " edges, "
+                                                << compact_graph.memory_usage() / (1024 * 1024) << " MB");
+}
+
+void GeoRef::add_flat_sections(type::FlatNavWriter& writer) const {
+    writer.add_section("georef.pl_walking.items", pl_walking.items);
+    writer.add_section("georef.pl_walking.coords", pl_walking.NN_data);
+    writer.add_section("georef.pl_bike.items", pl_bike.items);
+    writer.add_section("georef.pl_bike.coords", pl_bike.NN_data);
+    writer.add_section("georef.pl_car.items", pl_car.items);
+    writer.add_section("georef.pl_car.coords", pl_car.NN_data);
+    writer.add_section("georef.poi.coords", poi_proximity_list.NN_data);
+}
+
+void GeoRef::build_contraction_hierarchies() {
+    auto log = log4cplus::Logger::getInstance("GeoRef::build_contraction_hierarchies");
+    contraction_hierarchies.clear();
+
+    // the layers are independent, they are contracted in parallel
+    std::vector<std::future<ContractionHierarchy>> futures;
+    for (nt::Mode_e mode : {nt::Mode_e::Walking, nt::Mode_e::Bike, nt::Mode_e::Car}) {
+        const auto offset = offsets[mode];
+        std::vector<ContractionHierarchy::InputEdge> edges;
+        for (vertex_t v = offset; v < offset + nb_vertex_by_mode; ++v) {
+            for (auto range = boost::out_edges(v, graph); range.first != range.second; ++range.first) {
+                const auto t = boost::target(*range.first, graph);
+                if (t >= offset && t < offset + nb_vertex_by_mode) {
+                    edges.push_back({uint32_t(v - offset), uint32_t(t - offset), graph[*range.first].duration});
+                }
+            }
+        }
+        futures.push_back(std::async(std::launch::async, [this, offset, edges = std::move(edges)]() {
+            return ContractionHierarchy(offset, nb_vertex_by_mode, edges);
+        }));
+    }
+    for (auto& future : futures) {
+        contraction_hierarchies.push_back(future.get());
+        const auto& ch = contraction_hierarchies.back();
+        LOG4CPLUS_INFO(log, "layer at " << ch.offset() << " contracted: " << ch.nb_edges() << " edges, "
+                                         << ch.nb_shortcuts() << " shortcuts");
+    }
+}
+
+const ContractionHierarchy* GeoRef::contraction_hierarchy(type::Mode_e mode) const {
+    switch (mode) {
+        case type::Mode_e::Walking:
+        case type::Mode_e::Bike:
+        case type::Mode_e::CarNoPark:
+            break;
+        default:
+            // the car and the bss go through several layers
+            return nullptr;
+    }
+    for (const auto& ch : contraction_hierarchies) {
+        if (ch.offset() == offsets[mode] && ch.nb_vertices() == nb_vertex_by_mode) {
+            return &ch;
+        }
+    }
+    return nullptr;
 }
 
 static const Admin* find_city_admin(const std::vector<Admin*>& admins) {
@@ -675,37 +766,70 @@ edge_t GeoRef::nearest_edge(const type::GeographicalCoord& coordinates) const {
     return nearest_edge(coordinates, pl_walking);
 }
 
-edge_t GeoRef::nearest_edge(const type::GeographicalCoord& coordinates, type::Mode_e mode) const {
+const proximitylist::ProximityList<vertex_t>& GeoRef::proximity_list(type::Mode_e mode) const {
     switch (mode) {
         case type::Mode_e::Walking:
         case type::Mode_e::Bss:
-            return nearest_edge(coordinates, pl_walking);
+            return pl_walking;
         case type::Mode_e::Bike:
-            return nearest_edge(coordinates, pl_bike);
+            return pl_bike;
         case type::Mode_e::Car:
         case type::Mode_e::CarNoPark:
-            return nearest_edge(coordinates, pl_car);
+            return pl_car;
         default:
             throw navitia::recoverable_exception("Unknown mode when looking for nearest edges");
     }
 }
 
+edge_t GeoRef::nearest_edge(const type::GeographicalCoord& coordinates, type::Mode_e mode) const {
+    return nearest_edge(coordinates, proximity_list(mode));
+}
+
+// Magic Number!
+// The number indicates the number of nearest vertices that should be returned by find_with
+// This number is determined by balancing the performance and the practical results (Artemis)
+// The bigger the number is, the better the projection will be and slower it will run.
+// With 30, we have broken less than 1% tests on Artemis_idfm.
+static const int nb_nearest_vertices = 30;
+
 /// Get the nearest_edge with at least one vertex in the graph corresponding to the offset (walking, bike, ...)
 edge_t GeoRef::nearest_edge(const type::GeographicalCoord& coordinates,
                             const proximitylist::ProximityList<vertex_t>& prox,
                             double horizon) const {
+    const auto vertices = prox.find_within<proximitylist::IndexOnly>(coordinates, horizon, nb_nearest_vertices);
+    const auto res = nearest_edge(coordinates, vertices);
+    if (res) {
+        return *res;
+    }
+    throw proximitylist::NotFound();
+}
+
+std::vector<ProjectionData> GeoRef::project(const std::vector<type::GeographicalCoord>& coords,
+                                            type::Mode_e mode) const {
+    const auto nearest_vertices =
+        proximity_list(mode).find_within_many<proximitylist::IndexOnly>(coords, 500, nb_nearest_vertices);
+    std::vector<ProjectionData> res(coords.size());
+    for (size_t i = 0; i < coords.size(); ++i) {
+        auto& projection = res[i];
+        const auto edge = nearest_edge(coords[i], nearest_vertices[i]);
+        if (edge) {
+            projection.found = true;
+            projection.init(coords[i], *this, *edge);
+        } else {
+            projection.vertices[ProjectionData::Direction::Source] = std::numeric_limits<vertex_t>::max();
+            projection.vertices[ProjectionData::Direction::Target] = std::numeric_limits<vertex_t>::max();
+        }
+    }
+    return res;
+}
+
+boost::optional<edge_t> GeoRef::nearest_edge(const type::GeographicalCoord& coordinates,
+                                             const std::vector<vertex_t>& vertices) const {
     boost::optional<edge_t> res;
     float min_dist = 0., cur_dist = 0.;
     double coslat = ::cos(coordinates.lat() * type::GeographicalCoord::N_DEG_TO_RAD);
 
-    // Magic Number!
-    // The number indicates the number of nearest vertices that should be returned by find_with
-    // This number is determined by balancing the performance and the practical results (Artemis)
-    // The bigger the number is, the better the projection will be and slower it will run.
-    // With 30, we have broken less than 1% tests on Artemis_idfm.
-    constexpr int nb_nearest_vertices = 30;
-
-    for (const auto& u : prox.find_within<proximitylist::IndexOnly>(coordinates, horizon, nb_nearest_vertices)) {
+    for (const auto& u : vertices) {
         BOOST_FOREACH (const edge_t& e, boost::out_edges(u, graph)) {
             const auto& v = target(e, graph);
             auto source_mode = get_mode(u);
@@ -727,10 +851,7 @@ edge_t GeoRef::nearest_edge(const type::GeographicalCoord& coordinates,
             }
         }
     }
-    if (res) {
-        return *res;
-    }
-    throw proximitylist::NotFound();
+    return res;
 }
 
 std::pair<int, const Way*> GeoRef::nearest_addr(const type::GeographicalCoord& coord) const {
@@ -834,11 +955,11 @@ bool GeoRef::add_bss_edges(const type::GeographicalCoord& coord) {
 
     // time needed to take the bike + time to walk between the edges
     edge.duration = dur_between_edges + default_time_bss_pickup;
-    add_edge(walking_v, biking_v, edge, graph);
+    add_edge(walking_v, biking_v, edge);
 
     // time needed to hang the bike back + time to walk between the edges
     edge.duration = dur_between_edges + default_time_bss_putback;
-    add_edge(biking_v, walking_v, edge, graph);
+    add_edge(biking_v, walking_v, edge);
 
     return true;
 }
@@ -869,11 +990,11 @@ bool GeoRef::add_parking_edges(const type::GeographicalCoord& coord) {
 
     // time to walk between the edges + time needed to leave the parking
     edge.duration = dur_between_edges + default_time_parking_leave;
-    add_edge(walking_v, car_v, edge, graph);
+    add_edge(walking_v, car_v, edge);
 
     // time needed to park the car + time to walk between the edges
     edge.duration = dur_between_edges + default_time_parking_park;
-    add_edge(car_v, walking_v, edge, graph);
+    add_edge(car_v, walking_v, edge);
 
     return true;
 }
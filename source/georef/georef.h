@@ -32,9 +32,12 @@ www.navitia.io
 #include "autocomplete/autocomplete.h"
 #include "proximity_list/proximity_list.h"
 #include "adminref.h"
+#include "contraction_hierarchy.h"
+#include "compact_graph.h"
 #include "utils/exception.h"
 #include "utils/flat_enum_map.h"
 #include <boost/graph/adjacency_list.hpp>
+#include <boost/optional.hpp>
 #include <boost/graph/adj_list_serialize.hpp>
 #include <boost/serialization/serialization.hpp>
 #include "utils/serialization_vector.h"
@@ -45,6 +48,13 @@ www.navitia.io
 #include <functional>
 #include "type/time_duration.h"
 
+namespace navitia {
+namespace type {
+class FlatNav;
+class FlatNavWriter;
+}  // namespace type
+}  // namespace navitia
+
 namespace nt = navitia::type;
 namespace nf = navitia::autocomplete;
 
@@ -255,12 +265,20 @@ struct GeoRef {
 
     int word_weight = 5;  // Pas serialisé : lu dans le fichier ini
 
+    /// optional contraction hierarchies of the walking, bike and car layers, see build_contraction_hierarchies
+    std::vector<ContractionHierarchy> contraction_hierarchies;
+
+    /// compact copy of the graph used by the path finders, not serialized.
+    /// It is cleared when the graph is modified, see build_compact_graph
+    CompactGraph compact_graph;
+
     void init();
 
     template <class Archive>
     void save(Archive& ar, const unsigned int) const {
         ar& ways& way_map& graph& offsets& fl_admin& fl_way& projected_stop_points& admins& admin_map& pois& fl_poi&
-            poitypes& poitype_map& poi_map& synonyms& ghostwords& poi_proximity_list& nb_vertex_by_mode;
+            poitypes& poitype_map& poi_map& synonyms& ghostwords& poi_proximity_list& nb_vertex_by_mode&
+                contraction_hierarchies;
     }
 
     template <class Archive>
@@ -269,12 +287,48 @@ struct GeoRef {
         // On avait donc une fuite de mémoire
         graph.clear();
         ar& ways& way_map& graph& offsets& fl_admin& fl_way& projected_stop_points& admins& admin_map& pois& fl_poi&
-            poitypes& poitype_map& poi_map& synonyms& ghostwords& poi_proximity_list& nb_vertex_by_mode;
+            poitypes& poitype_map& poi_map& synonyms& ghostwords& poi_proximity_list& nb_vertex_by_mode&
+                contraction_hierarchies;
     }
     BOOST_SERIALIZATION_SPLIT_MEMBER()
 
-    /** Construit l'indexe spatial */
-    void build_proximity_list();
+    /** Construit l'indexe spatial
+     *
+     * If a flat file is given, the street network proximity lists are
+     * built directly on its precomputed items and projected coords
+     */
+    void build_proximity_list(const type::FlatNav* flat_nav = nullptr);
+
+    /** Contract the walking, bike and car layers of the graph
+     *
+     * Only the edges inside a layer are kept, the hierarchies are thus used
+     * for the modes staying on one layer (walking, bike and car without park).
+     * The graph must not be modified afterwards
+     */
+    void build_contraction_hierarchies();
+
+    /** Copy the graph in a compact graph
+     *
+     * Only built by kraken when GENERAL.street_network_compact_graph is set: the adjacency list is still
+     * needed for the ways and geometries, the copy adds to the memory.
+     * The edges must be added with add_edge and their durations must not change afterwards
+     */
+    void build_compact_graph();
+
+    bool has_compact_graph() const {
+        // num_edges walks the vertices of the adjacency list, as the init of the searches already does
+        return compact_graph.num_vertices() > 0 && compact_graph.num_vertices() == boost::num_vertices(graph)
+               && compact_graph.num_edges() == boost::num_edges(graph);
+    }
+
+    /// add an edge to the graph and drop the compact graph, now out of date
+    edge_t add_edge(vertex_t source, vertex_t target, const Edge& edge);
+
+    /// hierarchy for the paths of the mode, nullptr if there is none
+    const ContractionHierarchy* contraction_hierarchy(type::Mode_e mode) const;
+
+    /// Add the precomputed proximity lists to the flat file
+    void add_flat_sections(type::FlatNavWriter& writer) const;
 
     ///  Construit l'indexe autocomplete à partir des rues
     void build_autocomplete_list();
@@ -321,6 +375,9 @@ struct GeoRef {
 
     edge_t nearest_edge(const type::GeographicalCoord& coordinates, type::Mode_e mode) const;
 
+    /// Projections of a batch of coordinates, the nearest vertices of all of them are searched in one go
+    std::vector<ProjectionData> project(const std::vector<type::GeographicalCoord>& coords, type::Mode_e mode) const;
+
     std::pair<int, const Way*> nearest_addr(const type::GeographicalCoord&) const;
     std::pair<int, const Way*> nearest_addr(const type::GeographicalCoord& coord,
                                             const std::function<bool(const Way&)>& filter) const;
@@ -343,6 +400,13 @@ private:
     edge_t nearest_edge(const type::GeographicalCoord& coordinates,
                         const proximitylist::ProximityList<vertex_t>& prox,
                         double horizon = 500) const;
+
+    // nearest edge among the out edges of the given vertices
+    boost::optional<edge_t> nearest_edge(const type::GeographicalCoord& coordinates,
+                                         const std::vector<vertex_t>& vertices) const;
+
+    // proximity list of the vertices of the layer of the mode
+    const proximitylist::ProximityList<vertex_t>& proximity_list(type::Mode_e mode) const;
 };
 
 /** When given a coordinate, we have to associate it with the street network.
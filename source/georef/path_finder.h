@@ -32,6 +32,7 @@ www.navitia.io
 
 #include "georef.h"
 #include "routing/raptor_utils.h"
+#include "utils/deadline.h"
 
 #include <boost/graph/two_bit_color_map.hpp>
 
@@ -141,6 +142,9 @@ public:
     // Color map for the dijkstra shortest path (to avoid extra alloc)
     boost::two_bit_color_map<> color;
 
+    // Deadline of the request, checked while exploring the graph (none when null)
+    const navitia::Deadline* deadline = nullptr;
+
     PathFinder(const GeoRef& geo_ref);
     PathFinder(const PathFinder& o) = default;
 
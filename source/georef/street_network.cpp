@@ -31,13 +31,19 @@ www.navitia.io
 #include "street_network.h"
 #include "type/data.h"
 #include "georef.h"
+#include <atomic>
 #include <chrono>
+#include <future>
 
 namespace navitia {
 namespace georef {
 
 StreetNetwork::StreetNetwork(const GeoRef& geo_ref)
-    : geo_ref(geo_ref), departure_path_finder(geo_ref), arrival_path_finder(geo_ref), direct_path_finder(geo_ref) {}
+    : geo_ref(geo_ref),
+      departure_path_finder(geo_ref),
+      arrival_path_finder(geo_ref),
+      direct_path_finder(geo_ref),
+      ch_path_finder(geo_ref) {}
 
 void StreetNetwork::init(const type::EntryPoint& start, boost::optional<const type::EntryPoint&> end) {
     departure_path_finder.init(start.coordinates, start.streetnetwork_params.mode,
@@ -48,6 +54,17 @@ void StreetNetwork::init(const type::EntryPoint& start, boost::optional<const ty
     }
 }
 
+void StreetNetwork::set_deadline(const navitia::Deadline* deadline) {
+    this->deadline = deadline;
+    departure_path_finder.deadline = deadline;
+    arrival_path_finder.deadline = deadline;
+    direct_path_finder.deadline = deadline;
+    ch_path_finder.deadline = deadline;
+    for (auto& path_finder : matrix_path_finders) {
+        path_finder->deadline = deadline;
+    }
+}
+
 bool StreetNetwork::departure_launched() const {
     return departure_path_finder.computation_launch;
 }
@@ -132,6 +149,11 @@ Path StreetNetwork::get_direct_path(const type::EntryPoint& origin, const type::
         return Path();
     }
     const auto max_dur = origin.streetnetwork_params.max_duration + destination.streetnetwork_params.max_duration;
+    if (const auto* ch = geo_ref.contraction_hierarchy(origin.streetnetwork_params.mode)) {
+        ch_path_finder.init(origin.coordinates, origin.streetnetwork_params.mode,
+                            origin.streetnetwork_params.speed_factor);
+        return ch_path_finder.compute_path(*ch, dest_edge, max_dur);
+    }
     direct_path_finder.init(origin.coordinates, dest_edge.projected, origin.streetnetwork_params.mode,
                             origin.streetnetwork_params.speed_factor);
 
@@ -144,5 +166,56 @@ Path StreetNetwork::get_direct_path(const type::EntryPoint& origin, const type::
     }
     return res;
 }
+DijkstraPathFinder& StreetNetwork::get_matrix_path_finder(const size_t i) {
+    if (i == 0) {
+        return departure_path_finder;
+    }
+    while (matrix_path_finders.size() < i) {
+        matrix_path_finders.push_back(std::make_unique<DijkstraPathFinder>(geo_ref));
+        matrix_path_finders.back()->deadline = deadline;
+    }
+    return *matrix_path_finders[i - 1];
+}
+
+std::vector<std::vector<RoutingElement>> StreetNetwork::get_routing_matrix(
+    const std::vector<type::EntryPoint>& origins,
+    const std::vector<type::GeographicalCoord>& destinations,
+    const navitia::time_duration& max_duration,
+    const size_t nb_threads) {
+    // the destinations are projected on the walking layer for the car, as in get_duration_with_dijkstra
+    auto projection_mode = [](nt::Mode_e mode) { return mode == nt::Mode_e::Car ? nt::Mode_e::Walking : mode; };
+    flat_enum_map<nt::Mode_e, std::vector<ProjectionData>> projections;
+    flat_enum_map<nt::Mode_e, bool> projected{{{}}};
+    for (const auto& origin : origins) {
+        const auto mode = projection_mode(origin.streetnetwork_params.mode);
+        if (!projected[mode]) {
+            projections[mode] = geo_ref.project(destinations, mode);
+            projected[mode] = true;
+        }
+    }
+
+    std::vector<std::vector<RoutingElement>> rows(origins.size());
+    std::atomic<size_t> next_row{0};
+    auto compute_rows = [&](DijkstraPathFinder& path_finder) {
+        for (size_t i = next_row++; i < origins.size(); i = next_row++) {
+            const auto& params = origins[i].streetnetwork_params;
+            path_finder.init(origins[i].coordinates, params.mode, params.speed_factor);
+            rows[i] = path_finder.get_duration_with_dijkstra(max_duration, projections[projection_mode(params.mode)]);
+        }
+    };
+
+    const size_t nb_workers = std::max(size_t(1), std::min(nb_threads, origins.size()));
+    std::vector<std::future<void>> futures;
+    for (size_t i = 1; i < nb_workers; ++i) {
+        DijkstraPathFinder* path_finder = &get_matrix_path_finder(i);
+        futures.push_back(std::async(std::launch::async, [&, path_finder]() { compute_rows(*path_finder); }));
+    }
+    compute_rows(departure_path_finder);
+    for (auto& future : futures) {
+        future.get();
+    }
+    return rows;
+}
+
 }  // namespace georef
 }  // namespace navitia
@@ -32,6 +32,7 @@ www.navitia.io
 #include "georef.h"
 #include "dijkstra_path_finder.h"
 #include "astar_path_finder.h"
+#include "contraction_hierarchy_path_finder.h"
 #include "routing/raptor_utils.h"
 #include "type/type.h"  //TODO: Remove
 #include "type/time_duration.h"
@@ -45,6 +46,9 @@ struct StreetNetwork {
 
     void init(const type::EntryPoint& start_coord, boost::optional<const type::EntryPoint&> end_coord = {});
 
+    // the searches of all the path finders stop with navitia::DeadlineExpired once the deadline has expired
+    void set_deadline(const navitia::Deadline* deadline);
+
     bool departure_launched() const;
     bool arrival_launched() const;
 
@@ -58,13 +62,37 @@ struct StreetNetwork {
 
     /**
      * Build the direct path between the start and the end
+     *
+     * on the contraction hierarchy of the mode if the graph has one, with an A* otherwise
      **/
     Path get_direct_path(const type::EntryPoint& origin, const type::EntryPoint& destination);
 
+    /**
+     * Durations from each origin to each destination, the i-th row being the one of origins[i]
+     *
+     * The destinations are projected once for the whole matrix, then each row
+     * is a single Dijkstra from its origin bounded by max_duration.
+     * The rows are distributed between nb_threads path finders, the first one
+     * being the departure path finder.
+     **/
+    std::vector<std::vector<RoutingElement>> get_routing_matrix(
+        const std::vector<type::EntryPoint>& origins,
+        const std::vector<type::GeographicalCoord>& destinations,
+        const navitia::time_duration& max_duration,
+        const size_t nb_threads = 1);
+
     const GeoRef& geo_ref;
     DijkstraPathFinder departure_path_finder;
     DijkstraPathFinder arrival_path_finder;
     AstarPathFinder direct_path_finder;
+    // used instead of the A* when the graph has a contraction hierarchy for the mode
+    ContractionHierarchyPathFinder ch_path_finder;
+
+    // additional path finders of the matrix, created on demand
+    std::vector<std::unique_ptr<DijkstraPathFinder>> matrix_path_finders;
+    DijkstraPathFinder& get_matrix_path_finder(const size_t i);
+
+    const navitia::Deadline* deadline = nullptr;
 };
 
 }  // namespace georef
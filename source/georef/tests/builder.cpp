@@ -72,9 +72,9 @@ GraphBuilder& GraphBuilder::add_edge(std::string source_name,
     this->geo_ref.ways.push_back(way);
     edge.way_idx = way->idx;
 
-    boost::add_edge(source, target, edge, this->geo_ref.graph);
+    this->geo_ref.add_edge(source, target, edge);
     if (bidirectionnal)
-        boost::add_edge(target, source, edge, this->geo_ref.graph);
+        this->geo_ref.add_edge(target, source, edge);
 
     return *this;
 }
@@ -0,0 +1,240 @@
+/* Copyright © 2001-2019, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+channel `#navitia` on riot https://riot.im/app/#/room/#navitia:matrix.org
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE test_contraction_hierarchy
+
+#include "georef/contraction_hierarchy.h"
+#include "georef/street_network.h"
+#include "builder.h"
+
+#include <boost/test/unit_test.hpp>
+#include <queue>
+#include <random>
+
+using namespace navitia::georef;
+using navitia::time_duration;
+namespace nt = navitia::type;
+
+namespace {
+
+using InputEdge = ContractionHierarchy::InputEdge;
+using Seed = ContractionHierarchyQuery::Seed;
+
+// plain Dijkstra on the edges, from the sources to the best of the targets
+time_duration reference_duration(uint32_t nb_vertices,
+                                 const std::vector<InputEdge>& edges,
+                                 const std::vector<Seed>& sources,
+                                 const std::vector<Seed>& targets) {
+    std::vector<time_duration> durations(nb_vertices, bt::pos_infin);
+    using Item = std::pair<time_duration, uint32_t>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+    for (const auto& s : sources) {
+        if (s.second < durations[s.first]) {
+            durations[s.first] = s.second;
+            queue.emplace(s.second, s.first);
+        }
+    }
+    while (!queue.empty()) {
+        const auto item = queue.top();
+        queue.pop();
+        if (item.first > durations[item.second]) {
+            continue;
+        }
+        for (const auto& e : edges) {
+            if (e.source == item.second && item.first + e.duration < durations[e.target]) {
+                durations[e.target] = item.first + e.duration;
+                queue.emplace(durations[e.target], e.target);
+            }
+        }
+    }
+    time_duration best = bt::pos_infin;
+    for (const auto& t : targets) {
+        best = std::min(best, durations[t.first] + t.second);
+    }
+    return best;
+}
+
+}  // namespace
+
+/*
+ * The paths found on the hierarchy of a random graph must be as short as
+ * the ones of a Dijkstra, and once unpacked follow edges of the graph
+ */
+BOOST_AUTO_TEST_CASE(contraction_hierarchy_shortest_paths) {
+    const uint32_t nb_vertices = 300;
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<uint32_t> vertex(0, nb_vertices - 1);
+    std::uniform_int_distribution<int> seconds(0, 60);
+    std::vector<InputEdge> edges;
+    for (uint32_t v = 0; v < nb_vertices; ++v) {
+        for (uint32_t u : {(v + 1) % nb_vertices, (v + 17) % nb_vertices, vertex(gen)}) {
+            edges.push_back({v, u, navitia::seconds(seconds(gen))});
+            if (seconds(gen) % 2) {
+                edges.push_back({u, v, navitia::seconds(seconds(gen))});
+            }
+        }
+    }
+
+    ContractionHierarchy ch(0, nb_vertices, edges);
+    BOOST_CHECK_EQUAL(ch.nb_vertices(), nb_vertices);
+    ContractionHierarchyQuery query;
+    for (int i = 0; i < 100; ++i) {
+        const std::vector<Seed> sources = {{vertex(gen), navitia::seconds(2)}, {vertex(gen), navitia::seconds(5)}};
+        const std::vector<Seed> targets = {{vertex(gen), navitia::seconds(1)}, {vertex(gen), {}}};
+        const auto res = query.compute(ch, sources, targets, 1, bt::pos_infin);
+        const auto expected = reference_duration(nb_vertices, edges, sources, targets);
+        BOOST_REQUIRE_EQUAL(res.duration, expected);
+        if (expected == bt::pos_infin) {
+            BOOST_CHECK(res.vertices.empty());
+            continue;
+        }
+
+        BOOST_REQUIRE(!res.vertices.empty());
+        time_duration duration = bt::pos_infin;
+        for (const auto& s : sources) {
+            if (s.first == res.vertices.front()) {
+                duration = std::min(duration, s.second);
+            }
+        }
+        for (size_t j = 1; j < res.vertices.size(); ++j) {
+            time_duration edge_duration = bt::pos_infin;
+            for (const auto& e : edges) {
+                if (e.source == res.vertices[j - 1] && e.target == res.vertices[j]) {
+                    edge_duration = std::min(edge_duration, e.duration);
+                }
+            }
+            BOOST_REQUIRE_NE(edge_duration, bt::pos_infin);
+            duration += edge_duration;
+        }
+        time_duration end_duration = bt::pos_infin;
+        for (const auto& t : targets) {
+            if (t.first == res.vertices.back()) {
+                end_duration = std::min(end_duration, t.second);
+            }
+        }
+        BOOST_CHECK_EQUAL(duration + end_duration, expected);
+
+        // nothing is found above the max duration
+        BOOST_CHECK(query.compute(ch, sources, targets, 1, expected - navitia::seconds(1)).vertices.empty());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(contraction_hierarchy_deadline_expired) {
+    const uint32_t nb_vertices = 100;
+    std::vector<InputEdge> edges;
+    for (uint32_t v = 0; v + 1 < nb_vertices; ++v) {
+        edges.push_back({v, v + 1, navitia::seconds(10)});
+        edges.push_back({v + 1, v, navitia::seconds(10)});
+    }
+    ContractionHierarchy ch(0, nb_vertices, edges);
+    ContractionHierarchyQuery query;
+    const std::vector<Seed> sources = {{0, {}}};
+    const std::vector<Seed> targets = {{nb_vertices - 1, {}}};
+
+    navitia::Deadline deadline;
+    deadline.set(boost::posix_time::from_iso_string("20000101T000000"));
+    BOOST_CHECK_THROW(query.compute(ch, sources, targets, 1, bt::pos_infin, &deadline), navitia::DeadlineExpired);
+
+    // the same search goes to the end without deadline
+    BOOST_CHECK_EQUAL(query.compute(ch, sources, targets, 1, bt::pos_infin).duration, navitia::seconds(990));
+}
+
+/*
+ * The direct paths computed on the contraction hierarchy are the shortest
+ * ones, as found by a Dijkstra on the whole graph
+ */
+BOOST_AUTO_TEST_CASE(contraction_hierarchy_direct_path) {
+    GraphBuilder b;
+    const size_t square_size = 10;
+    auto name = [](size_t i, size_t j) { return std::to_string(i) + "_" + std::to_string(j); };
+    for (size_t i = 0; i < square_size; ++i) {
+        for (size_t j = 0; j < square_size; ++j) {
+            b(name(i, j), i * 10, j * 10);
+        }
+    }
+    // the vertices are 10m away, the edges are not faster than walking for the heuristic of the A*
+    for (size_t i = 0; i < square_size - 1; ++i) {
+        for (size_t j = 0; j < square_size - 1; ++j) {
+            b.add_edge(name(i, j), name(i, j + 1), navitia::seconds(9 + (i * j) % 7), true);
+            b.add_edge(name(i, j), name(i + 1, j), navitia::seconds(9 + (i + j) % 5), true);
+        }
+    }
+    b.init();
+
+    std::vector<std::pair<nt::GeographicalCoord, nt::GeographicalCoord>> ods;
+    for (const auto& od : {std::make_pair(std::make_pair(2., 3.), std::make_pair(75., 81.)),
+                           std::make_pair(std::make_pair(80., 11.), std::make_pair(4., 62.)),
+                           std::make_pair(std::make_pair(30., 30.), std::make_pair(60., 20.)),
+                           std::make_pair(std::make_pair(41., 47.), std::make_pair(43., 47.))}) {
+        ods.emplace_back();
+        ods.back().first.set_xy(od.first.first, od.first.second);
+        ods.back().second.set_xy(od.second.first, od.second.second);
+    }
+    auto direct_paths = [&]() {
+        StreetNetwork worker(b.geo_ref);
+        std::vector<Path> paths;
+        for (const auto& od : ods) {
+            nt::EntryPoint origin, destination;
+            origin.coordinates = od.first;
+            destination.coordinates = od.second;
+            origin.streetnetwork_params.max_duration = navitia::seconds(3600);
+            destination.streetnetwork_params.max_duration = navitia::seconds(3600);
+            paths.push_back(worker.get_direct_path(origin, destination));
+        }
+        return paths;
+    };
+
+    const auto astar_paths = direct_paths();
+    BOOST_REQUIRE(b.geo_ref.contraction_hierarchy(nt::Mode_e::Walking) == nullptr);
+    b.geo_ref.build_contraction_hierarchies();
+    BOOST_REQUIRE(b.geo_ref.contraction_hierarchy(nt::Mode_e::Walking) != nullptr);
+    BOOST_CHECK(b.geo_ref.contraction_hierarchy(nt::Mode_e::Bss) == nullptr);
+    const auto ch_paths = direct_paths();
+
+    BOOST_REQUIRE_EQUAL(ch_paths.size(), ods.size());
+    DijkstraPathFinder dijkstra(b.geo_ref);
+    for (size_t i = 0; i < ods.size(); ++i) {
+        dijkstra.init(ods[i].first, nt::Mode_e::Walking, 1);
+        dijkstra.start_distance_dijkstra(navitia::seconds(3600));
+        const ProjectionData destination(ods[i].second, b.geo_ref, nt::Mode_e::Walking);
+        const auto expected = dijkstra.get_path(destination, dijkstra.find_nearest_vertex(destination, true));
+
+        BOOST_REQUIRE(!expected.path_items.empty());
+        BOOST_REQUIRE(!ch_paths[i].path_items.empty());
+        BOOST_CHECK_EQUAL(ch_paths[i].duration, expected.duration);
+        // the A* stops on the first end of the destination edge it reaches
+        BOOST_CHECK_LE(ch_paths[i].duration, astar_paths[i].duration);
+        BOOST_CHECK_EQUAL(ch_paths[i].path_items.front().coordinates.front(),
+                          expected.path_items.front().coordinates.front());
+        BOOST_CHECK_EQUAL(ch_paths[i].path_items.back().coordinates.back(),
+                          expected.path_items.back().coordinates.back());
+    }
+}
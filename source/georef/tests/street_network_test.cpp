@@ -232,3 +232,112 @@ BOOST_AUTO_TEST_CASE(astar_init) {
         BOOST_CHECK_THROW(worker.costs.at(worker.starting_edge[dir::Target]), proximitylist::NotFound);
     }
 }
+
+/*
+ * The routing matrix, with its destinations projected once and its rows
+ * spread between several path finders, has to give the same durations as
+ * one dijkstra by origin
+ */
+BOOST_AUTO_TEST_CASE(routing_matrix) {
+    GraphBuilder b;
+    type::Data data;
+    build_data(b, data);
+
+    std::vector<type::GeographicalCoord> destinations;
+    for (const auto& xy : {std::make_pair(8., 6.), std::make_pair(5., 1.), std::make_pair(1., 7.),
+                           std::make_pair(800., 650.)}) {
+        destinations.emplace_back();
+        destinations.back().set_xy(xy.first, xy.second);
+    }
+    std::vector<type::EntryPoint> origins;
+    for (const auto& xy : {std::make_pair(2., 2.), std::make_pair(7., 3.), std::make_pair(4., 8.)}) {
+        origins.emplace_back();
+        origins.back().type = type::Type_e::Coord;
+        origins.back().coordinates.set_xy(xy.first, xy.second);
+    }
+    const auto max_duration = navitia::seconds(1000);
+
+    DijkstraPathFinder reference_finder(b.geo_ref);
+    std::vector<std::vector<RoutingElement>> expected;
+    for (const auto& origin : origins) {
+        reference_finder.init(origin.coordinates, type::Mode_e::Walking, 1);
+        const auto durations = reference_finder.get_duration_with_dijkstra(max_duration, destinations);
+        expected.emplace_back();
+        for (const auto& destination : destinations) {
+            expected.back().push_back(durations.at(destination.uri()));
+        }
+    }
+
+    StreetNetwork sn_worker(b.geo_ref);
+    for (size_t nb_threads : {1, 2, 8}) {
+        const auto rows = sn_worker.get_routing_matrix(origins, destinations, max_duration, nb_threads);
+        BOOST_REQUIRE_EQUAL(rows.size(), expected.size());
+        for (size_t i = 0; i < rows.size(); ++i) {
+            BOOST_REQUIRE_EQUAL(rows[i].size(), expected[i].size());
+            for (size_t j = 0; j < rows[i].size(); ++j) {
+                BOOST_CHECK_EQUAL(rows[i][j].time_duration, expected[i][j].time_duration);
+                BOOST_CHECK(rows[i][j].routing_status == expected[i][j].routing_status);
+            }
+        }
+        // the last destination is too far to be projected
+        BOOST_CHECK(rows[0][3].routing_status == RoutingStatus_e::unknown);
+    }
+}
+
+/*
+ * The searches on the compact graph have to
+ * give the same distances and predecessors as on the adjacency list
+ */
+BOOST_AUTO_TEST_CASE(compact_graph) {
+    GraphBuilder b;
+    type::Data data;
+    build_data(b, data);
+    BOOST_REQUIRE(!b.geo_ref.has_compact_graph());
+    b.geo_ref.build_compact_graph();
+    BOOST_REQUIRE(b.geo_ref.has_compact_graph());
+    BOOST_CHECK_EQUAL(b.geo_ref.compact_graph.num_edges(), boost::num_edges(b.geo_ref.graph));
+
+    type::GeographicalCoord start;
+    start.set_xy(2., 2.);
+    type::GeographicalCoord destination;
+    destination.set_xy(8., 6.);
+    const auto target_idx = data.pt_data->stop_points.front()->idx;
+
+    DijkstraPathFinder dijkstra(b.geo_ref);
+    dijkstra.init(start, type::Mode_e::Walking, 1);
+    dijkstra.start_distance_dijkstra(navitia::seconds(1000));
+    computation_results dijkstra_res{dijkstra.get_distance(target_idx), dijkstra};
+
+    AstarPathFinder astar(b.geo_ref);
+    const ProjectionData dest_proj(destination, b.geo_ref, type::Mode_e::Walking);
+    astar.init(start, dest_proj.projected, type::Mode_e::Walking, 1);
+    astar.start_distance_or_target_astar(navitia::seconds(1000), dest_proj.projected,
+                                         {dest_proj[dir::Source], dest_proj[dir::Target]});
+    const auto astar_path = astar.get_path(dest_proj, astar.find_nearest_vertex(dest_proj, true));
+    computation_results astar_res{astar_path.duration, astar};
+
+    // adding an edge drops the compact graph, the adjacency list is then used
+    // (a loop does not change the searches)
+    const auto first_vertex = b.vertex_map.begin()->second;
+    b.geo_ref.add_edge(first_vertex, first_vertex, Edge(0, navitia::seconds(1)));
+    BOOST_REQUIRE(!b.geo_ref.has_compact_graph());
+
+    dijkstra.init(start, type::Mode_e::Walking, 1);
+    dijkstra.start_distance_dijkstra(navitia::seconds(1000));
+    computation_results other_dijkstra_res{dijkstra.get_distance(target_idx), dijkstra};
+    BOOST_CHECK(dijkstra_res == other_dijkstra_res);
+
+    astar.init(start, dest_proj.projected, type::Mode_e::Walking, 1);
+    astar.start_distance_or_target_astar(navitia::seconds(1000), dest_proj.projected,
+                                         {dest_proj[dir::Source], dest_proj[dir::Target]});
+    const auto other_astar_path = astar.get_path(dest_proj, astar.find_nearest_vertex(dest_proj, true));
+    computation_results other_astar_res{other_astar_path.duration, astar};
+    BOOST_CHECK(astar_res == other_astar_res);
+    BOOST_CHECK_EQUAL(astar_path.path_items.size(), other_astar_path.path_items.size());
+
+    // an edge added without add_edge is also detected
+    b.geo_ref.build_compact_graph();
+    BOOST_REQUIRE(b.geo_ref.has_compact_graph());
+    boost::add_edge(first_vertex, first_vertex, Edge(0, navitia::seconds(1)), b.geo_ref.graph);
+    BOOST_CHECK(!b.geo_ref.has_compact_graph());
+}
@@ -32,6 +32,7 @@ www.navitia.io
 
 #include "georef.h"
 #include "type/time_duration.h"
+#include "utils/deadline.h"
 #include <boost/graph/dijkstra_shortest_paths.hpp>
 #include <boost/graph/astar_search.hpp>
 
@@ -42,14 +43,32 @@ namespace georef {
 struct DestinationFound {};
 struct DestinationNotFound {};
 
+// Checks every few visited vertices that the deadline of the request has not expired
+// (throwing navitia::DeadlineExpired), reading the clock at each vertex would be too costly
+struct DeadlineCheck {
+    static constexpr uint32_t nb_vertices_between_checks = 4096;
+    const navitia::Deadline* deadline;
+    uint32_t nb_vertices = 0;
+
+    explicit DeadlineCheck(const navitia::Deadline* deadline) : deadline(deadline) {}
+    void operator()() {
+        if (deadline != nullptr && ++nb_vertices % nb_vertices_between_checks == 0) {
+            deadline->check();
+        }
+    }
+};
+
 // Visitor who stops (throw a DestinationFound exception) when a certain distance is reached
 template <class Base>
 struct distance_visitor : virtual public Base {
     navitia::time_duration max_duration;
     const std::vector<navitia::time_duration>& durations;
+    DeadlineCheck check_deadline;
 
-    distance_visitor(const time_duration& max_dur, const std::vector<time_duration>& dur)
-        : max_duration(max_dur), durations(dur) {}
+    distance_visitor(const time_duration& max_dur,
+                     const std::vector<time_duration>& dur,
+                     const navitia::Deadline* deadline = nullptr)
+        : max_duration(max_dur), durations(dur), check_deadline(deadline) {}
     distance_visitor(const distance_visitor& other) = default;
 
     /*
@@ -59,6 +78,7 @@ struct distance_visitor : virtual public Base {
     void examine_vertex(typename boost::graph_traits<G>::vertex_descriptor u, const G&) {
         if (durations[u] > max_duration)
             throw DestinationFound();
+        check_deadline();
     }
 };
 
@@ -67,9 +87,10 @@ template <class Base>
 struct target_all_visitor : virtual public Base {
     std::vector<vertex_t> destinations;
     size_t nbFound = 0;
+    DeadlineCheck check_deadline;
 
-    target_all_visitor(const std::vector<vertex_t>& destinations)
-        : destinations(destinations.begin(), destinations.end()) {}
+    target_all_visitor(const std::vector<vertex_t>& destinations, const navitia::Deadline* deadline = nullptr)
+        : destinations(destinations.begin(), destinations.end()), check_deadline(deadline) {}
 
     target_all_visitor(const target_all_visitor& other) = default;
 
@@ -81,6 +102,7 @@ struct target_all_visitor : virtual public Base {
                 throw DestinationFound();
             }
         }
+        check_deadline();
     }
 };
 
@@ -101,10 +123,12 @@ struct target_unique_visitor : public Base {
 // Visitor who stops when a target has been visited or a certain distance is reached
 template <class Base>
 struct distance_or_target_visitor : virtual public distance_visitor<Base>, virtual public target_all_visitor<Base> {
+    // the deadline is only checked by the distance part
     distance_or_target_visitor(const time_duration& max_dur,
                                const std::vector<time_duration>& dur,
-                               const std::vector<vertex_t>& destinations)
-        : distance_visitor<Base>(max_dur, dur), target_all_visitor<Base>(destinations) {}
+                               const std::vector<vertex_t>& destinations,
+                               const navitia::Deadline* deadline = nullptr)
+        : distance_visitor<Base>(max_dur, dur, deadline), target_all_visitor<Base>(destinations) {}
     distance_or_target_visitor(const distance_or_target_visitor& other) = default;
     template <typename graph_type>
     void finish_vertex(vertex_t u, const graph_type& g) {
@@ -75,6 +75,21 @@ po::options_description get_options_description(const boost::optional<std::strin
              po::value<bool>()->default_value(*display_contributors) : po::value<bool>()->default_value(false),
          "display all contributors in feed publishers")
         ("GENERAL.raptor_cache_size", po::value<int>()->default_value(10), "maximum number of stored raptor caches")
+        ("GENERAL.raptor_profile_threads", po::value<int>()->default_value(1),
+                                  "number of slices of the timeframe of a journeys request computed in parallel as a profile query, by the thread of the request and a pool of raptor_profile_threads - 1 threads shared by all the workers (1 to disable). "
+                                  "Changes the results: with more than 1, only the Pareto set of the journeys of the timeframe is returned, the sequential mode returns every journey found")
+        ("GENERAL.street_network_matrix_threads", po::value<int>()->default_value(1),
+                                  "number of threads computing the rows of a street network routing matrix, each one with its own path finder")
+        ("GENERAL.heat_map_threads", po::value<int>()->default_value(1),
+                                  "number of threads filling the cells of a heat map")
+        ("GENERAL.graphical_isochrone_resolution", po::value<int>()->default_value(0),
+                                  "resolution of the grid on which the graphical isochrones are traced after a street network search (0 to use circles around the stop points)")
+        ("GENERAL.street_network_compact_graph", po::value<bool>()->default_value(false),
+                                  "copy the street network graph in compressed sparse rows at load for faster street network searches (the adjacency list is kept, this adds 8 bytes per edge to the memory of kraken)")
+        ("GENERAL.ptref_cache_size", po::value<int>()->default_value(0),
+                                  "maximum number of ptref filter results kept by data, renewed with each data (0 to disable)")
+        ("GENERAL.raptor_cache_prebuild_period", po::value<int>()->default_value(60),
+                                  "period in seconds of the background build of the raptor caches of today and tomorrow (0 to disable)")
         ("GENERAL.log_level", po::value<std::string>(), "log level of kraken")
         ("GENERAL.log_format", po::value<std::string>()->default_value("[%D{%y-%m-%d %H:%M:%S,%q}] [%p] [%x] - %m %b:%L  %n"), "log format")
 
@@ -250,6 +265,10 @@ bool Configuration::enable_request_deadline() const {
     return vm["GENERAL.enable_request_deadline"].as<bool>();
 }
 
+bool Configuration::street_network_compact_graph() const {
+    return vm["GENERAL.street_network_compact_graph"].as<bool>();
+}
+
 size_t Configuration::raptor_cache_size() const {
     if (!vm.count("GENERAL.raptor_cache_size")) {
         return 10;
@@ -261,6 +280,72 @@ size_t Configuration::raptor_cache_size() const {
     return size_t(raptor_cache_size);
 }
 
+size_t Configuration::raptor_profile_threads() const {
+    if (!vm.count("GENERAL.raptor_profile_threads")) {
+        return 1;
+    }
+    int raptor_profile_threads = vm["GENERAL.raptor_profile_threads"].as<int>();
+    if (raptor_profile_threads < 1) {
+        throw std::invalid_argument("raptor_profile_threads must be strictly positive");
+    }
+    return size_t(raptor_profile_threads);
+}
+
+size_t Configuration::street_network_matrix_threads() const {
+    if (!vm.count("GENERAL.street_network_matrix_threads")) {
+        return 1;
+    }
+    int street_network_matrix_threads = vm["GENERAL.street_network_matrix_threads"].as<int>();
+    if (street_network_matrix_threads < 1) {
+        throw std::invalid_argument("street_network_matrix_threads must be strictly positive");
+    }
+    return size_t(street_network_matrix_threads);
+}
+
+size_t Configuration::heat_map_threads() const {
+    if (!vm.count("GENERAL.heat_map_threads")) {
+        return 1;
+    }
+    int heat_map_threads = vm["GENERAL.heat_map_threads"].as<int>();
+    if (heat_map_threads < 1) {
+        throw std::invalid_argument("heat_map_threads must be strictly positive");
+    }
+    return size_t(heat_map_threads);
+}
+
+uint32_t Configuration::graphical_isochrone_resolution() const {
+    if (!vm.count("GENERAL.graphical_isochrone_resolution")) {
+        return 0;
+    }
+    int graphical_isochrone_resolution = vm["GENERAL.graphical_isochrone_resolution"].as<int>();
+    if (graphical_isochrone_resolution < 0) {
+        throw std::invalid_argument("graphical_isochrone_resolution must be positive");
+    }
+    return uint32_t(graphical_isochrone_resolution);
+}
+
+size_t Configuration::ptref_cache_size() const {
+    if (!vm.count("GENERAL.ptref_cache_size")) {
+        return 0;
+    }
+    int ptref_cache_size = vm["GENERAL.ptref_cache_size"].as<int>();
+    if (ptref_cache_size < 0) {
+        throw std::invalid_argument("ptref_cache_size must be positive");
+    }
+    return size_t(ptref_cache_size);
+}
+
+size_t Configuration::raptor_cache_prebuild_period() const {
+    if (!vm.count("GENERAL.raptor_cache_prebuild_period")) {
+        return 60;
+    }
+    int raptor_cache_prebuild_period = vm["GENERAL.raptor_cache_prebuild_period"].as<int>();
+    if (raptor_cache_prebuild_period < 0) {
+        throw std::invalid_argument("raptor_cache_prebuild_period must be positive");
+    }
+    return size_t(raptor_cache_prebuild_period);
+}
+
 boost::optional<std::string> Configuration::log_level() const {
     boost::optional<std::string> result;
     if (this->vm.count("GENERAL.log_level") > 0) {
@@ -67,6 +67,13 @@ public:
     int kirin_retry_timeout() const;
     bool display_contributors() const;
     size_t raptor_cache_size() const;
+    size_t raptor_profile_threads() const;
+    size_t street_network_matrix_threads() const;
+    size_t heat_map_threads() const;
+    uint32_t graphical_isochrone_resolution() const;
+    bool street_network_compact_graph() const;
+    size_t ptref_cache_size() const;
+    size_t raptor_cache_prebuild_period() const;
     int core_file_size_limit() const;
     int slow_request_duration() const;
     boost::optional<std::string> log_level() const;
@@ -97,7 +97,9 @@ public:
     bool load(const std::string& filename,
               const boost::optional<std::string>& chaos_database = boost::none,
               const std::vector<std::string>& contributors = {},
-              const size_t raptor_cache_size = 10) {
+              const size_t raptor_cache_size = 10,
+              const size_t ptref_cache_size = 0,
+              const bool compact_graph = false) {
         // Add logger
         log4cplus::Logger logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("logger"));
 
@@ -115,6 +117,7 @@ public:
         }
 
         // load disruptions from database
+        bool has_autocomplete_filters = false;
         if (chaos_database != boost::none) {
             // If we catch a bdd broken connection, we do nothing (Just a log),
             // because data is still clean, unlike other cases where we have
@@ -122,6 +125,7 @@ public:
             try {
                 data->load_disruptions(*chaos_database, contributors);
                 data->build_autocomplete_partial();
+                has_autocomplete_filters = true;
             } catch (const navitia::data::disruptions_broken_connection&) {
                 LOG4CPLUS_WARN(logger, "Load data without disruptions");
             } catch (const navitia::data::disruptions_loading_error&) {
@@ -138,8 +142,16 @@ public:
         // Build Raptor Data
         data->build_raptor(raptor_cache_size);
         data->build_relations();
+        // the filters are already built with the autocomplete after the disruptions
+        if (!has_autocomplete_filters) {
+            data->build_autocomplete_filters();
+        }
         // Build proximity list NN index
         data->build_proximity_list();
+        if (compact_graph) {
+            data->build_compact_graph();
+        }
+        data->build_ptref_cache(ptref_cache_size);
         data->loading = false;
 
         // Set data
@@ -0,0 +1,283 @@
+/* Copyright © 2001-2019, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+channel `#navitia` on riot https://riot.im/app/#/room/#navitia:matrix.org
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+/*
+ * Replays a file of captured requests through Worker::dispatch, as
+ * kraken does, and reports the latencies by api. The latencies include
+ * the serialization of the responses, also reported apart since it is
+ * significant for the big responses (journeys, schedules).
+ *
+ * The requests file is a sequence of serialized pbnavitia::Request,
+ * each one prefixed by its size as a varint (the protobuf "delimited"
+ * format).
+ *
+ * The options of kraken (e.g. --GENERAL.heat_map_threads=4) can also be
+ * given, the others take their default value.
+ */
+
+#include "kraken/worker.h"
+#include "kraken/data_manager.h"
+#include "kraken/configuration.h"
+#include "routing/thread_pool.h"
+#include "type/data.h"
+#include "type/request.pb.h"
+#include "type/response.pb.h"
+#include "utils/init.h"
+#include "utils/exception.h"
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <boost/program_options.hpp>
+
+#include <sys/resource.h>  // Posix dependencies for getrusage
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <thread>
+#include <vector>
+
+namespace po = boost::program_options;
+namespace gio = google::protobuf::io;
+
+namespace {
+
+std::vector<pbnavitia::Request> read_requests(const std::string& filename) {
+    std::ifstream ifs(filename, std::ios::in | std::ios::binary);
+    if (!ifs.is_open()) {
+        throw std::runtime_error("impossible to open " + filename);
+    }
+    gio::IstreamInputStream raw_input(&ifs);
+    std::vector<pbnavitia::Request> requests;
+    while (true) {
+        // a new coded stream by message, as its total bytes limit is for the whole stream
+        gio::CodedInputStream input(&raw_input);
+        uint32_t size;
+        if (!input.ReadVarint32(&size)) {
+            break;
+        }
+        const auto limit = input.PushLimit(size);
+        pbnavitia::Request request;
+        if (!request.ParseFromCodedStream(&input) || !input.ConsumedEntireMessage()) {
+            throw std::runtime_error("invalid request #" + std::to_string(requests.size()) + " in " + filename);
+        }
+        input.PopLimit(limit);
+        requests.push_back(std::move(request));
+    }
+    return requests;
+}
+
+// latencies in milliseconds
+struct ApiMeasures {
+    std::vector<double> latencies;
+    std::vector<double> serialization_latencies;
+    size_t max_response_size = 0;  // in bytes
+};
+using Measures = std::map<pbnavitia::API, ApiMeasures>;
+
+// serializes the response as kraken does before sending it
+size_t serialize(const pbnavitia::Response& response, std::vector<google::protobuf::uint8>& buffer) {
+    const size_t size = response.ByteSize();
+    buffer.resize(size);
+    response.SerializeWithCachedSizesToArray(buffer.data());
+    return size;
+}
+
+double percentile(std::vector<double>& latencies, const double p) {
+    const auto rank = static_cast<size_t>(p * (latencies.size() - 1));
+    std::nth_element(latencies.begin(), latencies.begin() + rank, latencies.end());
+    return latencies[rank];
+}
+
+void print_report(Measures& measures, const double total_duration, const size_t nb_threads) {
+    std::cout << std::left << std::setw(25) << "api" << std::right << std::setw(10) << "nb" << std::setw(12)
+              << "p50 (ms)" << std::setw(12) << "p95 (ms)" << std::setw(12) << "p99 (ms)" << std::setw(12)
+              << "max (ms)" << std::setw(16) << "ser. p50 (ms)" << std::setw(16) << "ser. p99 (ms)"
+              << std::setw(14) << "max size (kB)" << std::endl;
+    size_t nb_requests = 0;
+    for (auto& api_measures : measures) {
+        auto& v = api_measures.second.latencies;
+        auto& serialization = api_measures.second.serialization_latencies;
+        nb_requests += v.size();
+        std::cout << std::left << std::setw(25) << pbnavitia::API_Name(api_measures.first) << std::right
+                  << std::setw(10) << v.size() << std::fixed << std::setprecision(2) << std::setw(12)
+                  << percentile(v, 0.5) << std::setw(12) << percentile(v, 0.95) << std::setw(12)
+                  << percentile(v, 0.99) << std::setw(12) << *std::max_element(v.begin(), v.end())
+                  << std::setw(16) << percentile(serialization, 0.5) << std::setw(16)
+                  << percentile(serialization, 0.99) << std::setw(14)
+                  << api_measures.second.max_response_size / 1024. << std::endl;
+    }
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::cout << std::endl
+              << nb_requests << " requests in " << total_duration << "s on " << nb_threads
+              << " threads: " << nb_requests / total_duration << " requests/s" << std::endl
+              << "peak RSS: " << usage.ru_maxrss / 1024 << " MB" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    navitia::init_app();
+    po::options_description desc("Options of kraken_bench");
+    std::string file, requests_file;
+    int nb_threads, raptor_cache_size;
+    size_t nb_loops, nb_warmup;
+
+    // clang-format off
+    desc.add_options()
+        ("help", "Show this message")
+        ("file,f", po::value<std::string>(&file)->default_value("data.nav.lz4"), "Path to data.nav.lz4")
+        ("requests,r", po::value<std::string>(&requests_file)->required(),
+            "Path to the requests to replay: varint-delimited serialized pbnavitia::Request")
+        ("threads,t", po::value<int>(&nb_threads)->default_value(1), "number of workers replaying the requests")
+        ("loops,l", po::value<size_t>(&nb_loops)->default_value(1), "number of times the requests are replayed")
+        ("warmup,w", po::value<size_t>(&nb_warmup)->default_value(0),
+            "number of requests replayed before the measures")
+        ("raptor_cache_size", po::value<int>(&raptor_cache_size)->default_value(10), "raptor cache size");
+    // clang-format on
+
+    // the unregistered options are the ones of kraken
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc, argv).options(desc).allow_unregistered().run(), vm);
+
+    const auto kraken_desc = navitia::kraken::get_options_description(std::string("kraken_bench"), std::string());
+    if (vm.count("help")) {
+        std::cout << "Replays captured requests through the kraken workers and reports their latencies" << std::endl;
+        std::cout << desc << std::endl;
+        std::cout << kraken_desc << std::endl;
+        return 1;
+    }
+    po::notify(vm);
+
+    navitia::kraken::Configuration conf;
+    conf.load_from_command_line(kraken_desc, argc, argv);
+
+    if (nb_threads < 1) {
+        std::cerr << "the number of threads must be strictly positive" << std::endl;
+        return 1;
+    }
+
+    const auto requests = read_requests(requests_file);
+    std::cout << requests.size() << " requests read from " << requests_file << std::endl;
+    if (requests.empty()) {
+        return 1;
+    }
+
+    DataManager<navitia::type::Data> data_manager;
+    if (!data_manager.load(file, boost::none, {}, raptor_cache_size, conf.ptref_cache_size(),
+                           conf.street_network_compact_graph())) {
+        std::cerr << "impossible to load " << file << std::endl;
+        return 1;
+    }
+    const auto data = data_manager.get_data();
+
+    // as in kraken, the extra threads of the profile queries are shared by the workers
+    navitia::routing::ThreadPool profile_pool(conf.raptor_profile_threads() - 1);
+    {
+        navitia::Worker w(conf, &profile_pool);
+        for (size_t i = 0; i < nb_warmup; ++i) {
+            try {
+                w.dispatch(requests[i % requests.size()], *data);
+            } catch (const std::exception& e) {
+                std::cerr << "warmup request " << i << " failed: " << e.what() << std::endl;
+            }
+        }
+    }
+
+    // the workers take the next request to replay in order, as the
+    // load balancer of kraken would give them
+    std::atomic<size_t> next_request{0};
+    std::atomic<size_t> nb_errors{0};
+    const size_t nb_to_replay = requests.size() * nb_loops;
+    std::vector<Measures> thread_measures(nb_threads);
+    std::vector<std::thread> threads;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < nb_threads; ++i) {
+        threads.emplace_back([&, i]() {
+            navitia::Worker w(conf, &profile_pool);
+            auto& measures = thread_measures[i];
+            std::vector<google::protobuf::uint8> buffer;
+            for (size_t r = next_request++; r < nb_to_replay; r = next_request++) {
+                const auto& request = requests[r % requests.size()];
+                const auto request_start = std::chrono::steady_clock::now();
+                try {
+                    w.dispatch(request, *data);
+                } catch (const navitia::recoverable_exception& e) {
+                    // kraken responds an internal error, the request is measured all the same
+                    w.pb_creator.fill_pb_error(pbnavitia::Error::internal_error, e.what());
+                    ++nb_errors;
+                } catch (const std::exception& e) {
+                    // an exception escaping the thread would abort the bench
+                    w.pb_creator.fill_pb_error(pbnavitia::Error::internal_error, e.what());
+                    ++nb_errors;
+                }
+                const auto& response = w.pb_creator.get_response();
+                const auto serialization_start = std::chrono::steady_clock::now();
+                const size_t size = serialize(response, buffer);
+                const auto end = std::chrono::steady_clock::now();
+                const std::chrono::duration<double, std::milli> duration = end - request_start;
+                const std::chrono::duration<double, std::milli> serialization_duration = end - serialization_start;
+                auto& api_measures = measures[request.requested_api()];
+                api_measures.latencies.push_back(duration.count());
+                api_measures.serialization_latencies.push_back(serialization_duration.count());
+                api_measures.max_response_size = std::max(api_measures.max_response_size, size);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const std::chrono::duration<double> total_duration = std::chrono::steady_clock::now() - start;
+
+    Measures measures;
+    for (auto& m : thread_measures) {
+        for (auto& api_measures : m) {
+            auto& merged = measures[api_measures.first];
+            const auto& thread_api_measures = api_measures.second;
+            merged.latencies.insert(merged.latencies.end(), thread_api_measures.latencies.begin(),
+                                    thread_api_measures.latencies.end());
+            merged.serialization_latencies.insert(merged.serialization_latencies.end(),
+                                                  thread_api_measures.serialization_latencies.begin(),
+                                                  thread_api_measures.serialization_latencies.end());
+            merged.max_response_size = std::max(merged.max_response_size, thread_api_measures.max_response_size);
+        }
+    }
+    print_report(measures, total_duration.count(), nb_threads);
+    if (nb_errors) {
+        std::cout << nb_errors << " requests failed" << std::endl;
+    }
+    return 0;
+}
@@ -127,6 +127,9 @@ int main(int argn, char** argv) {
     const navitia::Metrics metrics(conf.metrics_binding(), conf.instance_name());
 
     threads.create_thread(navitia::MaintenanceWorker(data_manager, conf, metrics));
+    if (conf.raptor_cache_prebuild_period() > 0) {
+        threads.create_thread(navitia::NextStopTimePrebuilder(data_manager, conf));
+    }
     //
     // Data have been loaded, we can now accept connections
     try {
@@ -139,10 +142,13 @@ int main(int argn, char** argv) {
     }
 
     int nb_threads = conf.nb_threads();
+    // the extra threads of the profile queries are shared by the workers, their number stays bounded under load
+    navitia::routing::ThreadPool profile_pool(conf.raptor_profile_threads() - 1);
     // Launch pool of worker threads
     LOG4CPLUS_INFO(logger, "starting workers threads");
     for (int thread_nbr = 0; thread_nbr < nb_threads; ++thread_nbr) {
-        threads.create_thread(std::bind(&doWork, std::ref(context), std::ref(data_manager), conf, std::ref(metrics)));
+        threads.create_thread(std::bind(&doWork, std::ref(context), std::ref(data_manager), conf, std::ref(metrics),
+                                        std::ref(profile_pool)));
     }
 
     // Connect worker threads to client threads via a queue
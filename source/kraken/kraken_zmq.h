@@ -31,12 +31,16 @@ www.navitia.io
 #pragma once
 #include "worker.h"
 #include "maintenance_worker.h"
+#include "next_stop_time_prebuilder.h"
 #include "kraken/data_manager.h"
 #include "utils/logger.h"
 #include <utils/zmq.h>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include "kraken/configuration.h"
 #include "type/meta_data.h"
+#include "routing/dataraptor.h"
+#include "routing/thread_pool.h"
+#include "ptreferential/ptref_cache.h"
 #include <log4cplus/ndc.h>
 #include "metrics.h"
 
@@ -44,9 +48,11 @@ www.navitia.io
 #include <boost/optional/optional_io.hpp>
 
 static void respond(zmq::socket_t& socket, const std::string& address, const pbnavitia::Response& response) {
+    // ByteSize walks the whole response and caches the size of every message,
+    // the response is then serialized in place in the zmq message with these sizes
     zmq::message_t reply(response.ByteSize());
     try {
-        response.SerializeToArray(reply.data(), response.ByteSize());
+        response.SerializeWithCachedSizesToArray(static_cast<google::protobuf::uint8*>(reply.data()));
     } catch (const google::protobuf::FatalException& e) {
         auto logger = log4cplus::Logger::getInstance("worker");
         LOG4CPLUS_ERROR(logger, "failure during serialization: " << e.what());
@@ -65,7 +71,8 @@ namespace pt = boost::posix_time;
 inline void doWork(zmq::context_t& context,
                    DataManager<navitia::type::Data>& data_manager,
                    navitia::kraken::Configuration conf,
-                   const navitia::Metrics& metrics) {
+                   const navitia::Metrics& metrics,
+                   navitia::routing::ThreadPool& profile_pool) {
     auto logger = log4cplus::Logger::getInstance("worker");
 
     zmq::socket_t socket(context, ZMQ_REQ);
@@ -73,7 +80,7 @@ inline void doWork(zmq::context_t& context,
     bool run = true;
     auto enable_deadline = conf.enable_request_deadline();
     // Here we create the worker
-    navitia::Worker w(conf);
+    navitia::Worker w(conf, &profile_pool);
     z_send(socket, "READY");
     auto slow_request_duration = pt::milliseconds(conf.slow_request_duration());
     while (run) {
@@ -121,14 +128,17 @@ inline void doWork(zmq::context_t& context,
 
         LOG4CPLUS_DEBUG(logger, "deadline set to " << deadline.get());
         const auto data = data_manager.get_data();
+        bool started = false;
         try {
             deadline.check();
-            w.dispatch(pb_req, *data);
+            started = true;
+            w.dispatch(pb_req, *data, deadline);
             if (api != pbnavitia::METADATAS) {
                 LOG4CPLUS_TRACE(logger, "response: " << w.pb_creator.get_response().DebugString());
             }
         } catch (const navitia::DeadlineExpired& e) {
             LOG4CPLUS_ERROR(logger, "deadline expired, aborting request: " << e.what());
+            metrics.observe_deadline_expired(started);
             w.pb_creator.fill_pb_error(pbnavitia::Error::deadline_expired, e.what());
             // we still respond so this thread become availlable again
         } catch (const navitia::recoverable_exception& e) {
@@ -146,6 +156,13 @@ inline void doWork(zmq::context_t& context,
         respond(socket, address, w.pb_creator.get_response());
         auto duration = pt::microsec_clock::universal_time() - start;
         metrics.observe_api(api, duration.total_milliseconds() / 1000.0);
+        metrics.observe_fill(api, w.pb_creator.get_fill_stats());
+        if (data->dataRaptor && data->dataRaptor->cached_next_st_manager) {
+            metrics.set_next_stop_time_cache_stats(data->dataRaptor->cached_next_st_manager->get_stats());
+        }
+        if (data->ptref_cache) {
+            metrics.set_ptref_cache_stats(data->ptref_cache->get_stats());
+        }
         if (duration >= slow_request_duration) {
             LOG4CPLUS_WARN(logger, "slow request! duration: " << duration.total_milliseconds()
                                                               << "ms request: " << pb_req.DebugString());
@@ -35,6 +35,7 @@ www.navitia.io
 #include "realtime.h"
 #include "type/task.pb.h"
 #include "type/pt_data.h"
+#include "routing/dataraptor.h"
 #include <boost/algorithm/string/join.hpp>
 #include <boost/optional.hpp>
 #include <boost/thread/thread.hpp>
@@ -58,7 +59,8 @@ void MaintenanceWorker::load_data() {
     auto contributors = conf.rt_topics();
     LOG4CPLUS_INFO(logger, "Loading database from file: " + database);
     auto start = pt::microsec_clock::universal_time();
-    if (this->data_manager.load(database, chaos_database, contributors, conf.raptor_cache_size())) {
+    if (this->data_manager.load(database, chaos_database, contributors, conf.raptor_cache_size(),
+                                conf.ptref_cache_size(), conf.street_network_compact_graph())) {
         auto data = data_manager.get_data();
         data->is_realtime_loaded = false;
         data->meta->instance_name = conf.instance_name();
@@ -176,7 +178,7 @@ void MaintenanceWorker::handle_rt_in_batch(const std::vector<AmqpClient::Envelop
                 pt::ptime copy_begin = pt::microsec_clock::universal_time();
                 data = data_manager.get_data_clone();
                 auto duration = pt::microsec_clock::universal_time() - copy_begin;
-                this->metrics.observe_data_cloning(duration.total_seconds());
+                this->metrics.observe_data_cloning(duration.total_milliseconds() / 1000.0);
                 LOG4CPLUS_INFO(logger, "data copied in " << duration);
             }
             if (entity.is_deleted()) {
@@ -203,9 +205,20 @@ void MaintenanceWorker::handle_rt_in_batch(const std::vector<AmqpClient::Envelop
         LOG4CPLUS_INFO(logger, "cleaning weak impacts");
         data->pt_data->clean_weak_impacts();
         LOG4CPLUS_INFO(logger, "rebuilding data raptor");
-        data->build_raptor(conf.raptor_cache_size());
+        // the current data is the one we have been cloned from, its
+        // raptor data are reused for the journey patterns not impacted
+        const auto current_data = data_manager.get_data();
+        pt::ptime raptor_begin = pt::microsec_clock::universal_time();
+        data->build_raptor(conf.raptor_cache_size(), current_data.get());
+        auto raptor_duration = pt::microsec_clock::universal_time() - raptor_begin;
+        this->metrics.observe_raptor_rebuild(raptor_duration.total_milliseconds() / 1000.0,
+                                             data->dataRaptor->nb_rebuilt_jps);
+        LOG4CPLUS_INFO(logger, "data raptor rebuilt in " << raptor_duration << " ("
+                                                          << data->dataRaptor->nb_rebuilt_jps
+                                                          << " journey patterns computed)");
         data->build_proximity_list();
-        data->warmup(*data_manager.get_data());
+        data->warmup(*current_data);
+        data->build_ptref_cache(conf.ptref_cache_size());
         data->set_last_rt_data_loaded(pt::microsec_clock::universal_time());
         data_manager.set_data(std::move(data));
         auto duration = pt::microsec_clock::universal_time() - begin;
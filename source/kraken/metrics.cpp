@@ -30,6 +30,9 @@ www.navitia.io
 
 #include "metrics.h"
 #include "utils/functions.h"
+#include "routing/next_stop_time.h"
+#include "ptreferential/ptref_cache.h"
+#include "type/pb_converter.h"
 
 #include <prometheus/exposer.h>
 #include <prometheus/registry.h>
@@ -99,6 +102,24 @@ Metrics::Metrics(const boost::optional<std::string>& endpoint, const std::string
         auto& histo = histogram_family.Add({{"api", value->name()}}, create_fixed_duration_buckets());
         this->request_histogram[static_cast<pbnavitia::API>(value->number())] = &histo;
     }
+    auto& fill_histogram_family = prometheus::BuildHistogram()
+                                      .Name("kraken_response_fill_duration_seconds")
+                                      .Help("time spent filling the protobuf response of a request, in seconds")
+                                      .Labels({{"coverage", coverage}})
+                                      .Register(*registry);
+    for (int i = 0; i < desc->value_count(); ++i) {
+        auto value = desc->value(i);
+        auto& histo = fill_histogram_family.Add({{"api", value->name()}}, create_fixed_duration_buckets());
+        this->fill_histogram[static_cast<pbnavitia::API>(value->number())] = &histo;
+    }
+    auto& fill_memo_family = prometheus::BuildCounter()
+                                 .Name("kraken_response_fill_memo_total")
+                                 .Help("Number of objects of the responses copied from (hit) or added to (miss) the "
+                                       "fill memo")
+                                 .Labels({{"coverage", coverage}})
+                                 .Register(*registry);
+    this->fill_memo_hits = &fill_memo_family.Add({{"event", "hit"}});
+    this->fill_memo_misses = &fill_memo_family.Add({{"event", "miss"}});
     auto& in_flight_family = prometheus::BuildGauge()
                                  .Name("kraken_request_in_flight")
                                  .Help("Number of requests currently beeing processed")
@@ -106,6 +127,14 @@ Metrics::Metrics(const boost::optional<std::string>& endpoint, const std::string
                                  .Register(*registry);
     this->in_flight = &in_flight_family.Add({});
 
+    auto& deadline_expired_family = prometheus::BuildCounter()
+                                        .Name("kraken_request_deadline_expired_total")
+                                        .Help("Number of requests aborted because of their deadline")
+                                        .Labels({{"coverage", coverage}})
+                                        .Register(*registry);
+    this->deadline_expired_before_start = &deadline_expired_family.Add({{"stage", "before_start"}});
+    this->deadline_expired_in_flight = &deadline_expired_family.Add({{"stage", "in_flight"}});
+
     this->data_loading_histogram = &prometheus::BuildHistogram()
                                         .Name("kraken_data_loading_duration_seconds")
                                         .Help("duration of loading data")
@@ -126,6 +155,48 @@ Metrics::Metrics(const boost::optional<std::string>& endpoint, const std::string
                                      .Labels({{"coverage", coverage}})
                                      .Register(*registry)
                                      .Add({}, create_exponential_buckets(1, 2, 10));
+
+    this->raptor_rebuild_histogram = &prometheus::BuildHistogram()
+                                          .Name("kraken_rt_raptor_rebuild_duration_seconds")
+                                          .Help("duration for rebuilding raptor data after realtime")
+                                          .Labels({{"coverage", coverage}})
+                                          .Register(*registry)
+                                          .Add({}, create_exponential_buckets(0.01, 2, 12));
+
+    this->rebuilt_journey_patterns_histogram = &prometheus::BuildHistogram()
+                                                    .Name("kraken_rt_rebuilt_journey_patterns")
+                                                    .Help("number of journey patterns impacted by a realtime batch")
+                                                    .Labels({{"coverage", coverage}})
+                                                    .Register(*registry)
+                                                    .Add({}, create_exponential_buckets(1, 4, 10));
+
+    // the next stop time cache is rebuilt with the data, so its counters are exported as gauges
+    auto& next_st_cache_family = prometheus::BuildGauge()
+                                     .Name("kraken_next_stop_time_cache_events")
+                                     .Help("Number of hits, misses and evictions of the next stop time cache")
+                                     .Labels({{"coverage", coverage}})
+                                     .Register(*registry);
+    this->next_st_cache_hits = &next_st_cache_family.Add({{"event", "hit"}});
+    this->next_st_cache_misses = &next_st_cache_family.Add({{"event", "miss"}});
+    this->next_st_cache_evictions = &next_st_cache_family.Add({{"event", "eviction"}});
+
+    this->next_st_cache_build_duration = &prometheus::BuildGauge()
+                                              .Name("kraken_next_stop_time_cache_build_duration_seconds")
+                                              .Help("Cumulated duration of the builds of the next stop time cache")
+                                              .Labels({{"coverage", coverage}})
+                                              .Register(*registry)
+                                              .Add({});
+
+    // the ptref cache is renewed with the data too
+    auto& ptref_cache_family = prometheus::BuildGauge()
+                                   .Name("kraken_ptref_cache_events")
+                                   .Help("Number of hits and misses of the caches of the ptref filters")
+                                   .Labels({{"coverage", coverage}})
+                                   .Register(*registry);
+    this->ptref_cache_hits = &ptref_cache_family.Add({{"cache", "result"}, {"event", "hit"}});
+    this->ptref_cache_misses = &ptref_cache_family.Add({{"cache", "result"}, {"event", "miss"}});
+    this->ptref_parse_cache_hits = &ptref_cache_family.Add({{"cache", "expression"}, {"event", "hit"}});
+    this->ptref_parse_cache_misses = &ptref_cache_family.Add({{"cache", "expression"}, {"event", "miss"}});
 }
 
 InFlightGuard Metrics::start_in_flight() const {
@@ -135,6 +206,17 @@ InFlightGuard Metrics::start_in_flight() const {
     return InFlightGuard(this->in_flight);
 }
 
+void Metrics::observe_deadline_expired(bool in_flight) const {
+    if (!registry) {
+        return;
+    }
+    if (in_flight) {
+        this->deadline_expired_in_flight->Increment();
+    } else {
+        this->deadline_expired_before_start->Increment();
+    }
+}
+
 void Metrics::observe_api(pbnavitia::API api, double duration) const {
     if (!registry) {
         return;
@@ -148,6 +230,18 @@ void Metrics::observe_api(pbnavitia::API api, double duration) const {
     }
 }
 
+void Metrics::observe_fill(pbnavitia::API api, const PbFillStats& stats) const {
+    if (!registry) {
+        return;
+    }
+    auto it = this->fill_histogram.find(api);
+    if (it != std::end(this->fill_histogram)) {
+        it->second->Observe(stats.fill_duration);
+    }
+    this->fill_memo_hits->Increment(stats.nb_memo_hits);
+    this->fill_memo_misses->Increment(stats.nb_memo_misses);
+}
+
 void Metrics::observe_data_loading(double duration) const {
     if (!registry) {
         return;
@@ -169,4 +263,32 @@ void Metrics::observe_handle_rt(double duration) const {
     this->handle_rt_histogram->Observe(duration);
 }
 
+void Metrics::observe_raptor_rebuild(double duration, size_t nb_rebuilt_journey_patterns) const {
+    if (!registry) {
+        return;
+    }
+    this->raptor_rebuild_histogram->Observe(duration);
+    this->rebuilt_journey_patterns_histogram->Observe(nb_rebuilt_journey_patterns);
+}
+
+void Metrics::set_next_stop_time_cache_stats(const routing::CachedNextStopTimeStats& stats) const {
+    if (!registry) {
+        return;
+    }
+    this->next_st_cache_hits->Set(stats.nb_calls - stats.nb_cache_miss);
+    this->next_st_cache_misses->Set(stats.nb_cache_miss);
+    this->next_st_cache_evictions->Set(stats.nb_evictions);
+    this->next_st_cache_build_duration->Set(stats.build_duration);
+}
+
+void Metrics::set_ptref_cache_stats(const ptref::PtrefCacheStats& stats) const {
+    if (!registry) {
+        return;
+    }
+    this->ptref_cache_hits->Set(stats.nb_calls - stats.nb_cache_miss);
+    this->ptref_cache_misses->Set(stats.nb_cache_miss);
+    this->ptref_parse_cache_hits->Set(stats.nb_parse_calls - stats.nb_parse_cache_miss);
+    this->ptref_parse_cache_misses->Set(stats.nb_parse_cache_miss);
+}
+
 }  // namespace navitia
@@ -51,6 +51,14 @@ class Histogram;
 
 namespace navitia {
 
+struct PbFillStats;
+namespace routing {
+struct CachedNextStopTimeStats;
+}
+namespace ptref {
+struct PtrefCacheStats;
+}
+
 class InFlightGuard {
     prometheus::Gauge* gauge;
 
@@ -68,19 +76,41 @@ protected:
     std::unique_ptr<prometheus::Exposer> exposer;
     std::shared_ptr<prometheus::Registry> registry;
     std::map<pbnavitia::API, prometheus::Histogram*> request_histogram;
+    std::map<pbnavitia::API, prometheus::Histogram*> fill_histogram;
+    prometheus::Counter* fill_memo_hits;
+    prometheus::Counter* fill_memo_misses;
     prometheus::Gauge* in_flight;
+    prometheus::Counter* deadline_expired_before_start;
+    prometheus::Counter* deadline_expired_in_flight;
     prometheus::Histogram* data_loading_histogram;
     prometheus::Histogram* data_cloning_histogram;
     prometheus::Histogram* handle_rt_histogram;
+    prometheus::Histogram* raptor_rebuild_histogram;
+    prometheus::Histogram* rebuilt_journey_patterns_histogram;
+    prometheus::Gauge* next_st_cache_hits;
+    prometheus::Gauge* next_st_cache_misses;
+    prometheus::Gauge* next_st_cache_evictions;
+    prometheus::Gauge* next_st_cache_build_duration;
+    prometheus::Gauge* ptref_cache_hits;
+    prometheus::Gauge* ptref_cache_misses;
+    prometheus::Gauge* ptref_parse_cache_hits;
+    prometheus::Gauge* ptref_parse_cache_misses;
 
 public:
     Metrics(const boost::optional<std::string>& endpoint, const std::string& coverage);
     void observe_api(pbnavitia::API api, double duration) const;
+    // time spent filling the protobuf response of a request
+    void observe_fill(pbnavitia::API api, const PbFillStats& stats) const;
     InFlightGuard start_in_flight() const;
+    // in_flight is false when the deadline had already expired before the request started
+    void observe_deadline_expired(bool in_flight) const;
 
     void observe_data_loading(double duration) const;
     void observe_data_cloning(double duration) const;
     void observe_handle_rt(double duration) const;
+    void observe_raptor_rebuild(double duration, size_t nb_rebuilt_journey_patterns) const;
+    void set_next_stop_time_cache_stats(const routing::CachedNextStopTimeStats& stats) const;
+    void set_ptref_cache_stats(const ptref::PtrefCacheStats& stats) const;
 };
 
 }  // namespace navitia
@@ -0,0 +1,78 @@
+/* Copyright © 2001-2019, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+channel `#navitia` on riot https://riot.im/app/#/room/#navitia:matrix.org
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "next_stop_time_prebuilder.h"
+
+#include "type/meta_data.h"
+#include "routing/dataraptor.h"
+
+#include <boost/thread/thread.hpp>
+
+namespace pt = boost::posix_time;
+
+namespace navitia {
+
+NextStopTimePrebuilder::NextStopTimePrebuilder(DataManager<type::Data>& data_manager,
+                                               const kraken::Configuration conf)
+    : data_manager(data_manager), logger(log4cplus::Logger::getInstance("next_stop_time_prebuilder")), conf(conf) {}
+
+void NextStopTimePrebuilder::prebuild(const pt::ptime& now) {
+    const auto data = data_manager.get_data();
+    if (!data->loaded || !data->dataRaptor || !data->dataRaptor->cached_next_st_manager) {
+        return;
+    }
+    const auto& production_date = data->meta->production_date;
+    if (!production_date.contains(now.date())) {
+        return;
+    }
+    auto& manager = *data->dataRaptor->cached_next_st_manager;
+    const auto today = (now.date() - production_date.begin()).days();
+    const auto nb_days = production_date.length().days();
+    // a cache is 2-days wide, the one of tomorrow is used by the
+    // requests of tomorrow and by the end of the journeys of today
+    for (auto day = today; day <= today + 1 && day < nb_days; ++day) {
+        manager.prebuild(DateTimeUtils::set(day, 0));
+    }
+}
+
+void NextStopTimePrebuilder::operator()() {
+    const auto period = conf.raptor_cache_prebuild_period();
+    LOG4CPLUS_INFO(logger, "Starting next stop time prebuild thread, period: " << period << "s");
+    while (true) {
+        try {
+            prebuild(pt::second_clock::universal_time());
+        } catch (const std::exception& e) {
+            LOG4CPLUS_ERROR(logger, "next stop time prebuild failed: " << e.what());
+        }
+        boost::this_thread::sleep(pt::seconds(period));
+    }
+}
+
+}  // namespace navitia
@@ -0,0 +1,64 @@
+/* Copyright © 2001-2019, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+channel `#navitia` on riot https://riot.im/app/#/room/#navitia:matrix.org
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+
+#include "type/data.h"
+#include "kraken/data_manager.h"
+#include "kraken/configuration.h"
+#include "utils/logger.h"
+
+namespace navitia {
+
+/*
+ * Background thread building the next stop time caches of today and
+ * tomorrow before the requests need them, so that the first request
+ * after midnight does not pay for the build.
+ *
+ * The caches are built in the manager of the current data, thus a
+ * new data (after a reload or a realtime update) is handled at the
+ * next period.
+ */
+class NextStopTimePrebuilder {
+private:
+    DataManager<type::Data>& data_manager;
+    log4cplus::Logger logger;
+    const kraken::Configuration conf;
+
+public:
+    NextStopTimePrebuilder(DataManager<type::Data>& data_manager, const kraken::Configuration conf);
+
+    // builds the missing caches of the current data
+    void prebuild(const boost::posix_time::ptime& now);
+
+    void operator()();
+};
+
+}  // namespace navitia
@@ -46,7 +46,10 @@ public:
     void build_raptor(size_t) {}
     void build_relations() {}
     void build_proximity_list() {}
+    void build_compact_graph() {}
     void build_autocomplete_partial() {}
+    void build_autocomplete_filters() {}
+    void build_ptref_cache(size_t) {}
     mutable std::atomic<bool> loading;
     mutable std::atomic<bool> is_connected_to_rabbitmq;
     static bool load_status;
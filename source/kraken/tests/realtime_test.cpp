@@ -43,6 +43,8 @@ www.navitia.io
 #include "disruption/traffic_reports_api.h"
 #include "type/pb_converter.h"
 
+#include <boost/range/algorithm/equal.hpp>
+
 struct logger_initialized {
     logger_initialized() { navitia::init_logger("logger", "TRACE"); }
 };
@@ -3504,3 +3506,100 @@ BOOST_FIXTURE_TEST_CASE(cannot_add_new_trip_if_id_corresponds_to_a_base_VJ_the_s
     BOOST_CHECK_EQUAL(res.response_type(), pbnavitia::NO_SOLUTION);
     BOOST_CHECK_EQUAL(res.impacts_size(), 0);
 }
+
+/*
+ * When rebuilding raptor after realtime, the journey patterns not impacted by the update reuse the
+ * raptor data of the Data we have been cloned from. The result must be the same as a full rebuild.
+ */
+BOOST_AUTO_TEST_CASE(raptor_rebuild_reuses_unchanged_journey_patterns) {
+    ed::builder b("20150928");
+    b.vj("A", "000001", "", true, "vj:1")("stop1", "08:00"_t)("stop2", "09:00"_t);
+    b.vj("B", "000111", "", true, "vj:2")("stop3", "08:00"_t)("stop4", "09:00"_t);
+    b.make();
+    b.data->build_raptor();
+
+    nt::Data cloned_data(1);
+    cloned_data.clone_from(*b.data);
+    navitia::handle_realtime(feed_id, timestamp, make_cancellation_message("vj:1", "20150928"), cloned_data, true,
+                             true);
+    cloned_data.build_relations();
+    cloned_data.build_raptor(10, b.data.get());
+
+    // only the journey pattern of vj:1 has been computed
+    const auto& incremental = *cloned_data.dataRaptor;
+    BOOST_CHECK_EQUAL(incremental.jp_container.nb_jps(), 2);
+    BOOST_CHECK_EQUAL(incremental.nb_rebuilt_jps, 1);
+
+    navitia::routing::dataRAPTOR full;
+    full.load(*cloned_data.pt_data);
+    BOOST_CHECK_EQUAL(full.nb_rebuilt_jps, 2);
+
+    for (const auto level : {nt::RTLevel::Base, nt::RTLevel::Adapted, nt::RTLevel::RealTime}) {
+        BOOST_CHECK(incremental.jp_validity_patterns[level] == full.jp_validity_patterns[level]);
+    }
+    for (const auto jpp : full.jp_container.get_jpps()) {
+        for (const auto stop_event : {navitia::routing::StopEvent::pick_up, navitia::routing::StopEvent::drop_off}) {
+            const auto full_range = full.next_stop_time_data.stop_time_range_forward(jpp.first, stop_event);
+            const auto incremental_range =
+                incremental.next_stop_time_data.stop_time_range_forward(jpp.first, stop_event);
+            BOOST_CHECK(boost::equal(full_range, incremental_range));
+        }
+    }
+
+    // the stop times must be the ones of the cloned data
+    const auto* vj = cloned_data.pt_data->vehicle_journeys_map.at("vehicle_journey:vj:2");
+    const auto& jpp_idx = incremental.jp_container.get_jpp(vj->stop_time_list.front());
+    const auto range =
+        incremental.next_stop_time_data.stop_time_range_forward(jpp_idx, navitia::routing::StopEvent::pick_up);
+    BOOST_REQUIRE_EQUAL(range.size(), 1);
+    BOOST_CHECK_EQUAL(range.front(), &vj->stop_time_list.front());
+}
+
+/*
+ * The realtime doesn't modify the street network, a clone shares it with the Data it comes from.
+ * The admins of its stop areas and stop points must be the ones of the shared geo_ref.
+ */
+BOOST_AUTO_TEST_CASE(clone_shares_geo_ref) {
+    ed::builder b("20150928");
+    b.vj("A", "000001", "", true, "vj:1")("stop1", "08:00"_t)("stop2", "09:00"_t);
+    b.make();
+    auto* admin = new navitia::georef::Admin();
+    admin->uri = "admin";
+    admin->idx = 0;
+    admin->main_stop_areas.push_back(b.data->pt_data->stop_areas_map["stop2"]->idx);
+    b.data->geo_ref->admins.push_back(admin);
+    b.manage_admin();
+
+    nt::Data cloned_data(1);
+    cloned_data.clone_from(*b.data);
+    BOOST_CHECK(cloned_data.is_geo_ref_shared);
+    BOOST_CHECK_EQUAL(cloned_data.geo_ref, b.data->geo_ref);
+    BOOST_CHECK_EQUAL(cloned_data.fare, b.data->fare);
+
+    // the public transport data are copied
+    BOOST_REQUIRE_EQUAL(cloned_data.pt_data->stop_areas.size(), b.data->pt_data->stop_areas.size());
+    for (const auto* sa : cloned_data.pt_data->stop_areas) {
+        BOOST_CHECK_NE(sa, b.data->pt_data->stop_areas[sa->idx]);
+        BOOST_REQUIRE_EQUAL(sa->admin_list.size(), 1);
+        BOOST_CHECK_EQUAL(sa->admin_list.front(), admin);
+    }
+    for (const auto* sp : cloned_data.pt_data->stop_points) {
+        BOOST_REQUIRE_EQUAL(sp->admin_list.size(), 1);
+        BOOST_CHECK_EQUAL(sp->admin_list.front(), admin);
+    }
+    const auto main_sa_idx = cloned_data.geo_ref->admins.front()->main_stop_areas.front();
+    BOOST_CHECK_EQUAL(cloned_data.pt_data->stop_areas[main_sa_idx]->uri, "stop2");
+
+    // the realtime only modifies the clone
+    navitia::handle_realtime(feed_id, timestamp, make_cancellation_message("vj:1", "20150928"), cloned_data, true,
+                             true);
+    cloned_data.build_relations();
+    cloned_data.build_autocomplete_partial();
+    // the projections of the stop points are read by the workers of the original data, they are not rebuilt
+    const auto* projections = b.data->geo_ref->projected_stop_points.data();
+    cloned_data.build_proximity_list();
+    BOOST_CHECK_EQUAL(b.data->geo_ref->projected_stop_points.data(), projections);
+    BOOST_CHECK_EQUAL(b.data->pt_data->vehicle_journeys.size(), 1);
+    BOOST_CHECK_EQUAL(b.data->pt_data->vehicle_journeys.front()->rt_validity_pattern()->days.count(), 1);
+    BOOST_CHECK_EQUAL(cloned_data.pt_data->vehicle_journeys.front()->rt_validity_pattern()->days.count(), 0);
+}
@@ -43,6 +43,7 @@ www.navitia.io
 #include "disruption/line_reports_api.h"
 #include "calendar/calendar_api.h"
 #include "routing/raptor.h"
+#include "routing/heat_map.h"
 #include "type/meta_data.h"
 #include "equipment/equipment_api.h"
 #include <numeric>
@@ -65,6 +66,21 @@ struct coord_conversion_exception : public recoverable_exception {
     coord_conversion_exception& operator=(const coord_conversion_exception&) = default;
     virtual ~coord_conversion_exception() noexcept {}
 };
+
+// gives the deadline of the request to the searches, for the time of the request only
+struct DeadlineSetter {
+    routing::RAPTOR& planner;
+    georef::StreetNetwork& street_network;
+    DeadlineSetter(routing::RAPTOR& planner, georef::StreetNetwork& street_network, const Deadline& deadline)
+        : planner(planner), street_network(street_network) {
+        planner.deadline = &deadline;
+        street_network.set_deadline(&deadline);
+    }
+    ~DeadlineSetter() {
+        planner.deadline = nullptr;
+        street_network.set_deadline(nullptr);
+    }
+};
 }  // namespace
 
 template <typename T>
@@ -216,8 +232,8 @@ std::vector<std::string> vector_of_admins(const T& admin) {
     return result;
 }
 
-Worker::Worker(kraken::Configuration conf)
-    : conf(conf), logger(log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("logger"))) {}
+Worker::Worker(kraken::Configuration conf, navitia::routing::ThreadPool* profile_pool)
+    : conf(conf), profile_pool(profile_pool), logger(log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("logger"))) {}
 
 Worker::~Worker() {}
 
@@ -372,6 +388,7 @@ void Worker::init_worker_data(const navitia::type::Data* data,
     if (data->data_identifier != this->last_data_identifier || !planner) {
         planner = std::make_unique<routing::RAPTOR>(*data);
         street_network_worker = std::make_unique<georef::StreetNetwork>(*data->geo_ref);
+        heat_map_cache = std::make_unique<routing::HeatMapCache>();
         this->last_data_identifier = data->data_identifier;
         LOG4CPLUS_INFO(logger, "Instanciate planner");
     }
@@ -732,7 +749,7 @@ void Worker::journeys(const pbnavitia::JourneysRequest& request, pbnavitia::API
                     request.night_bus_filter_max_factor(), request.night_bus_filter_base_factor(),
                     request.has_timeframe_duration() ? boost::make_optional<uint32_t>(request.timeframe_duration())
                                                      : boost::none,
-                    request.depth());
+                    request.depth(), profile_pool);
                 break;
             default:
                 routing::make_response(
@@ -745,7 +762,7 @@ void Worker::journeys(const pbnavitia::JourneysRequest& request, pbnavitia::API
                     request.night_bus_filter_max_factor(), request.night_bus_filter_base_factor(),
                     request.has_timeframe_duration() ? boost::make_optional<uint32_t>(request.timeframe_duration())
                                                      : boost::none,
-                    request.depth());
+                    request.depth(), profile_pool);
         }
     } catch (const navitia::coord_conversion_exception& e) {
         this->pb_creator.fill_pb_error(pbnavitia::Error::bad_format, e.what());
@@ -836,7 +853,8 @@ void Worker::graphical_isochrone(const pbnavitia::GraphicalIsochroneRequest& req
     navitia::routing::make_graphical_isochrone(
         this->pb_creator, *planner, center_and_stop_points.first, request_journey.datetimes(0), boundary_duration,
         request_journey.max_transfers(), arg.accessibilite_params, arg.forbidden, arg.allowed,
-        request_journey.clockwise(), arg.rt_level, *street_network_worker, end_speed, center_and_stop_points.second);
+        request_journey.clockwise(), arg.rt_level, *street_network_worker, end_speed, center_and_stop_points.second,
+        end_mode, conf.graphical_isochrone_resolution(), conf.heat_map_threads());
 }
 
 void Worker::heat_map(const pbnavitia::HeatMapRequest& request) {
@@ -855,7 +873,8 @@ void Worker::heat_map(const pbnavitia::HeatMapRequest& request) {
                                     request_journey.datetimes(0), request_journey.max_duration(),
                                     request_journey.max_transfers(), arg.accessibilite_params, arg.forbidden,
                                     arg.allowed, request_journey.clockwise(), arg.rt_level, *street_network_worker,
-                                    end_speed, end_mode, request.resolution(), center_and_stop_points.second);
+                                    end_speed, end_mode, request.resolution(), center_and_stop_points.second,
+                                    conf.heat_map_threads(), heat_map_cache.get(), request_journey.SerializeAsString());
 }
 
 void Worker::car_co2_emission_on_crow_fly(const pbnavitia::CarCO2EmissionRequest& request) {
@@ -948,32 +967,28 @@ void Worker::street_network_routing_matrix(const pbnavitia::StreetNetworkRouting
         }
     }
 
+    std::vector<type::EntryPoint> origins;
     for (const auto& origin : request.origins()) {
-        type::EntryPoint entry_point;
         try {
-            entry_point =
-                make_sn_entry_point(origin.place(), request.mode(), request.speed(), request.max_duration(), *data);
+            origins.push_back(
+                make_sn_entry_point(origin.place(), request.mode(), request.speed(), request.max_duration(), *data));
         } catch (const navitia::coord_conversion_exception& e) {
             this->pb_creator.fill_pb_error(pbnavitia::Error::bad_format, e.what());
             return;
         }
+    }
 
-        street_network_worker->departure_path_finder.init(entry_point.coordinates,
-                                                          entry_point.streetnetwork_params.mode,
-                                                          entry_point.streetnetwork_params.speed_factor);
-        auto nearest = street_network_worker->departure_path_finder.get_duration_with_dijkstra(
-            navitia::time_duration::from_boost_duration(boost::posix_time::seconds(request.max_duration())),
-            dest_coords);
+    const auto max_duration =
+        navitia::time_duration::from_boost_duration(boost::posix_time::seconds(request.max_duration()));
+    const auto matrix = street_network_worker->get_routing_matrix(origins, dest_coords, max_duration,
+                                                                  conf.street_network_matrix_threads());
 
+    for (const auto& routing_elements : matrix) {
         auto* row = this->pb_creator.mutable_sn_routing_matrix()->add_rows();
-        for (auto coord : dest_coords) {
+        for (const auto& routing_element : routing_elements) {
             auto* k = row->add_routing_response();
-            auto it = nearest.find(coord.uri());
-            if (it == nearest.end()) {
-                throw navitia::recoverable_exception("Cannot find object: " + coord.uri());
-            }
-            k->set_duration(it->second.time_duration.total_seconds());
-            switch (it->second.routing_status) {
+            k->set_duration(routing_element.time_duration.total_seconds());
+            switch (routing_element.routing_status) {
                 case georef::RoutingStatus_e::reached:
                     k->set_routing_status(pbnavitia::RoutingStatus::reached);
                     break;
@@ -1000,11 +1015,12 @@ void Worker::direct_path(const pbnavitia::Request& request) {
                              dp_request.clockwise());
 }
 
-void Worker::dispatch(const pbnavitia::Request& request, const nt::Data& data) {
+void Worker::dispatch(const pbnavitia::Request& request, const nt::Data& data, const navitia::Deadline& deadline) {
     bool disable_geojson = get_geojson_state(request);
     boost::posix_time::ptime current_datetime = bt::from_time_t(request._current_datetime());
     this->init_worker_data(&data, current_datetime, null_time_period, disable_geojson, request.disable_feedpublisher(),
                            request.disable_disruption());
+    const DeadlineSetter deadline_setter(*planner, *street_network_worker, deadline);
 
     // These api can respond even if the data isn't loaded
     if (request.requested_api() == pbnavitia::STATUS) {
@@ -34,6 +34,8 @@ www.navitia.io
 namespace navitia {
 namespace routing {
 struct RAPTOR;
+struct HeatMapCache;
+class ThreadPool;
 }
 }  // namespace navitia
 
@@ -45,6 +47,7 @@ struct RAPTOR;
 #include "utils/logger.h"
 #include "kraken/configuration.h"
 #include "type/pb_converter.h"
+#include "utils/deadline.h"
 
 #include <memory>
 #include <limits>
@@ -75,8 +78,13 @@ class Worker {
 private:
     std::unique_ptr<navitia::routing::RAPTOR> planner;
     std::unique_ptr<navitia::georef::StreetNetwork> street_network_worker;
+    // street network part of the last heat map, only the edges of its box, reused for a new resolution of the same
+    // request
+    std::unique_ptr<navitia::routing::HeatMapCache> heat_map_cache;
 
     const kraken::Configuration conf;
+    // threads computing the profile queries, shared by all the workers
+    navitia::routing::ThreadPool* profile_pool;
     log4cplus::Logger logger;
     size_t last_data_identifier =
         std::numeric_limits<size_t>::max();  // to check that data did not change, do not use directly
@@ -85,12 +93,15 @@ private:
 public:
     navitia::PbCreator pb_creator;
 
-    Worker(kraken::Configuration conf);
+    Worker(kraken::Configuration conf, navitia::routing::ThreadPool* profile_pool = nullptr);
     // we override de destructor this way we can forward declare Raptor
     // see: https://stackoverflow.com/questions/6012157/is-stdunique-ptrt-required-to-know-the-full-definition-of-t
     ~Worker();
 
-    void dispatch(const pbnavitia::Request& request, const nt::Data& data);
+    // the searches of the request stop with navitia::DeadlineExpired once the deadline has expired
+    void dispatch(const pbnavitia::Request& request,
+                  const nt::Data& data,
+                  const navitia::Deadline& deadline = navitia::Deadline());
 
 private:
     void init_worker_data(const navitia::type::Data* data,
@@ -0,0 +1,117 @@
+/* Copyright © 2001-2019, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+channel `#navitia` on riot https://riot.im/app/#/room/#navitia:matrix.org
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "lz4_filter/framed_filter.h"
+#include "type/data.h"
+#include "utils/init.h"
+
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+namespace po = boost::program_options;
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsed_seconds(const Clock::time_point& start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// decompression only, the content is discarded
+static double decompress(const std::string& file, size_t nb_threads) {
+    const auto start = Clock::now();
+    std::ifstream ifs(file, std::ios::in | std::ios::binary);
+    boost::iostreams::filtering_istream in;
+    in.push(FramedLZ4Decompressor(nb_threads), 8192 * 500, 8192 * 500);
+    in.push(ifs);
+    std::vector<char> buffer(1024 * 1024);
+    while (in.read(buffer.data(), buffer.size()) || in.gcount() > 0) {
+    }
+    return elapsed_seconds(start);
+}
+
+// decompression and deserialization of the whole data
+static double load(const std::string& file, size_t nb_threads) {
+    const auto start = Clock::now();
+    std::ifstream ifs(file, std::ios::in | std::ios::binary);
+    ifs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    navitia::type::Data data;
+    data.load(ifs, nb_threads);
+    return elapsed_seconds(start);
+}
+
+int main(int argc, char** argv) {
+    navitia::init_app();
+    po::options_description desc("Options of the .nav loading benchmark");
+    std::string file, output;
+    size_t max_threads;
+
+    // clang-format off
+    desc.add_options()
+        ("help", "Show this message")
+        ("file,f", po::value<std::string>(&file)->default_value("data.nav.lz4"), "Path to data.nav.lz4")
+        ("threads,t", po::value<size_t>(&max_threads)->default_value(std::thread::hardware_concurrency()),
+         "maximum number of threads, the loading is timed for 1, 2, 4, ... threads")
+        ("convert,c", po::value<std::string>(&output),
+         "save the data in the framed format in this file first, the benchmark is then done on it")
+        ("lz4hc", "use LZ4HC to save the converted file");
+    // clang-format on
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help")) {
+        std::cout << "This is used to benchmark the loading time of a .nav depending on the number of threads"
+                  << std::endl;
+        std::cout << desc << std::endl;
+        return 1;
+    }
+
+    if (vm.count("convert")) {
+        navitia::type::Data data;
+        data.load_nav(file);
+        const auto start = Clock::now();
+        data.save(output, vm.count("lz4hc"));
+        std::cout << "converted " << file << " into " << output << " in " << elapsed_seconds(start) << "s"
+                  << std::endl;
+        file = output;
+    }
+
+    std::cout << "threads\tdecompression (s)\tload (s)" << std::endl;
+    for (size_t nb_threads = 1; nb_threads <= std::max(size_t(1), max_threads); nb_threads *= 2) {
+        const auto decompression_time = decompress(file, nb_threads);
+        const auto load_time = load(file, nb_threads);
+        std::cout << nb_threads << "\t" << decompression_time << "\t" << load_time << std::endl;
+    }
+    return 0;
+}
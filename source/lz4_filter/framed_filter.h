@@ -0,0 +1,394 @@
+/* Copyright © 2001-2019, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+channel `#navitia` on riot https://riot.im/app/#/room/#navitia:matrix.org
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+#include "filter.h"
+#include "lz4hc.h"
+
+#include <boost/iostreams/concepts.hpp>
+#include <boost/iostreams/write.hpp>
+#include <boost/iostreams/read.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+/*
+ * Framed LZ4 format
+ *
+ * The legacy format written by LZ4Compressor is a flat sequence of
+ * [uint32 compressed size][block] that can only be decoded one block
+ * after the other.
+ *
+ * The framed format starts with a header giving the size of the
+ * uncompressed blocks, then each block is prefixed by its compressed
+ * and uncompressed sizes:
+ *
+ *   [magic "NAVLZ4F"][uint8 version][uint32 block size][uint32 flags]
+ *   [uint32 compressed size][uint32 raw size][block] ...
+ *   [uint32 0]  (end of stream)
+ *
+ * Knowing the size of every block before decompressing it, the
+ * blocks are (de)compressed by batch on several threads.
+ *
+ * FramedLZ4Decompressor also reads the legacy format (detected with
+ * the magic), so old .nav files can still be loaded.
+ */
+namespace framed_lz4 {
+
+constexpr char magic[] = {'N', 'A', 'V', 'L', 'Z', '4', 'F'};
+constexpr uint8_t version = 1;
+constexpr uint32_t high_compression_flag = 1;
+constexpr size_t header_size = sizeof(magic) + sizeof(uint8_t) + 2 * sizeof(uint32_t);
+constexpr size_t frame_header_size = 2 * sizeof(uint32_t);
+
+inline size_t default_nb_threads() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// call f(i) for every i in [0, nb_items[, on nb_threads threads (the current one included)
+template <typename F>
+void parallel_for(size_t nb_items, size_t nb_threads, const F& f) {
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < nb_items; i = next++) {
+            f(i);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < std::min(nb_threads, nb_items); ++t) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+// read until size bytes are read or the end of the stream is reached, return the number of bytes read
+template <typename Source>
+std::streamsize read_fully(Source& src, char* dest, std::streamsize size) {
+    std::streamsize total = 0;
+    while (total < size) {
+        std::streamsize nb_read = boost::iostreams::read(src, dest + total, size - total);
+        if (nb_read <= 0) {
+            break;
+        }
+        total += nb_read;
+    }
+    return total;
+}
+
+template <typename Sink>
+void write_uint32(Sink& dest, uint32_t value) {
+    boost::iostreams::write(dest, reinterpret_cast<const char*>(&value), sizeof(uint32_t));
+}
+
+inline uint32_t read_uint32(const char* src) {
+    uint32_t value;
+    memcpy(&value, src, sizeof(uint32_t));
+    return value;
+}
+
+}  // namespace framed_lz4
+
+/**
+ * Compression filter writing the framed LZ4 format
+ *
+ * The input is cut in blocks of block_size bytes, nb_threads blocks are
+ * compressed at the same time. The end of the stream is written when
+ * the filter is closed.
+ */
+class FramedLZ4Compressor : public boost::iostreams::multichar_output_filter {
+    uint32_t block_size;
+    bool high_compression;
+    size_t nb_threads;
+    bool header_written = false;
+    std::vector<char> input_buffer;
+    std::vector<char> output_buffer;
+    std::vector<int> compressed_sizes;
+
+public:
+    /**
+     * @param block_size size of the uncompressed blocks
+     * @param high_compression use LZ4HC: smaller files, much slower compression, same decompression speed
+     * @param nb_threads number of blocks compressed in parallel, 0 for one by core
+     */
+    FramedLZ4Compressor(uint32_t block_size = 1024 * 1024, bool high_compression = false, size_t nb_threads = 0)
+        : block_size(block_size),
+          high_compression(high_compression),
+          nb_threads(nb_threads ? nb_threads : framed_lz4::default_nb_threads()) {}
+
+    template <typename Sink>
+    std::streamsize write(Sink& dest, const char* src, std::streamsize size) {
+        write_header(dest);
+        const size_t batch_size = size_t(block_size) * nb_threads;
+        std::streamsize written = 0;
+        while (written < size) {
+            if (input_buffer.capacity() < batch_size) {
+                input_buffer.reserve(batch_size);
+            }
+            size_t nb = std::min(batch_size - input_buffer.size(), size_t(size - written));
+            input_buffer.insert(input_buffer.end(), src + written, src + written + nb);
+            written += nb;
+            if (input_buffer.size() == batch_size) {
+                flush_blocks(dest);
+            }
+        }
+        return written;
+    }
+
+    template <typename Sink>
+    void close(Sink& dest) {
+        write_header(dest);
+        flush_blocks(dest);
+        framed_lz4::write_uint32(dest, 0);
+        header_written = false;
+    }
+
+private:
+    template <typename Sink>
+    void write_header(Sink& dest) {
+        if (header_written) {
+            return;
+        }
+        boost::iostreams::write(dest, framed_lz4::magic, sizeof(framed_lz4::magic));
+        boost::iostreams::write(dest, reinterpret_cast<const char*>(&framed_lz4::version), sizeof(uint8_t));
+        framed_lz4::write_uint32(dest, block_size);
+        framed_lz4::write_uint32(dest, high_compression ? framed_lz4::high_compression_flag : 0);
+        header_written = true;
+    }
+
+    template <typename Sink>
+    void flush_blocks(Sink& dest) {
+        if (input_buffer.empty()) {
+            return;
+        }
+        const size_t nb_blocks = (input_buffer.size() + block_size - 1) / block_size;
+        const int bound = LZ4_compressBound(block_size);
+        output_buffer.resize(nb_blocks * bound);
+        compressed_sizes.assign(nb_blocks, 0);
+        framed_lz4::parallel_for(nb_blocks, nb_threads, [&](size_t i) {
+            const size_t begin = i * block_size;
+            const int raw_size = std::min(size_t(block_size), input_buffer.size() - begin);
+            char* out = output_buffer.data() + i * bound;
+            if (high_compression) {
+                compressed_sizes[i] = LZ4_compress_HC(&input_buffer[begin], out, raw_size, bound, LZ4HC_CLEVEL_DEFAULT);
+            } else {
+                compressed_sizes[i] = LZ4_compress_default(&input_buffer[begin], out, raw_size, bound);
+            }
+        });
+        for (size_t i = 0; i < nb_blocks; ++i) {
+            if (compressed_sizes[i] <= 0) {
+                throw LZ4Exception();
+            }
+            const size_t raw_size = std::min(size_t(block_size), input_buffer.size() - i * block_size);
+            framed_lz4::write_uint32(dest, compressed_sizes[i]);
+            framed_lz4::write_uint32(dest, raw_size);
+            boost::iostreams::write(dest, output_buffer.data() + i * bound, compressed_sizes[i]);
+        }
+        input_buffer.clear();
+    }
+};
+
+/**
+ * Decompression filter reading the framed LZ4 format, or the legacy one
+ *
+ * In the framed format, blocks are read by batch of nb_threads blocks
+ * that are decompressed in parallel.
+ *
+ * In the legacy format, the blocks are decompressed one by one directly
+ * in the output buffer, which must be able to contain a complete
+ * uncompressed block (like for LZ4Decompressor).
+ */
+class FramedLZ4Decompressor : public boost::iostreams::multichar_input_filter {
+    enum class Format { Unknown, Framed, Legacy };
+
+    size_t nb_threads;
+    Format format = Format::Unknown;
+    bool end_reached = false;
+    uint32_t block_size = 0;
+    std::vector<char> input_buffer;
+    std::vector<char> output_buffer;
+    size_t output_pos = 0;
+    // framed format: offset of the blocks in input_buffer and output_buffer
+    std::vector<size_t> input_offsets;
+    std::vector<size_t> output_offsets;
+    // legacy format: bytes of the first chunk already consumed while looking for the header
+    std::vector<char> legacy_prefix;
+
+public:
+    /**
+     * @param nb_threads number of blocks decompressed in parallel, 0 for one by core
+     */
+    FramedLZ4Decompressor(size_t nb_threads = 0)
+        : nb_threads(nb_threads ? nb_threads : framed_lz4::default_nb_threads()) {}
+
+    template <typename Source>
+    std::streamsize read(Source& src, char* dest, std::streamsize size) {
+        if (format == Format::Unknown) {
+            read_header(src);
+        }
+        if (format == Format::Legacy) {
+            return read_legacy(src, dest, size);
+        }
+        if (output_pos == output_buffer.size() && !read_batch(src)) {
+            return -1;
+        }
+        std::streamsize nb = std::min(std::streamsize(output_buffer.size() - output_pos), size);
+        memcpy(dest, output_buffer.data() + output_pos, nb);
+        output_pos += nb;
+        return nb;
+    }
+
+    template <typename Source>
+    void close(Source&) {
+        format = Format::Unknown;
+        end_reached = false;
+        output_buffer.clear();
+        output_pos = 0;
+        legacy_prefix.clear();
+    }
+
+private:
+    template <typename Source>
+    void read_header(Source& src) {
+        char header[framed_lz4::header_size];
+        auto nb_read = framed_lz4::read_fully(src, header, sizeof(header));
+        const char* magic_end = framed_lz4::magic + sizeof(framed_lz4::magic);
+        if (nb_read == sizeof(header) && std::equal(framed_lz4::magic, magic_end, header)
+            && uint8_t(header[sizeof(framed_lz4::magic)]) == framed_lz4::version) {
+            format = Format::Framed;
+            block_size = framed_lz4::read_uint32(header + sizeof(framed_lz4::magic) + sizeof(uint8_t));
+            return;
+        }
+        format = Format::Legacy;
+        legacy_prefix.assign(header, header + nb_read);
+    }
+
+    // read and decompress the next nb_threads blocks, return false at the end of the stream
+    template <typename Source>
+    bool read_batch(Source& src) {
+        output_buffer.clear();
+        output_pos = 0;
+        input_offsets.clear();
+        output_offsets.clear();
+        size_t input_size = 0, output_size = 0;
+        const size_t max_compressed_size = LZ4_compressBound(block_size);
+        while (!end_reached && input_offsets.size() < nb_threads) {
+            char frame_header[framed_lz4::frame_header_size];
+            if (framed_lz4::read_fully(src, frame_header, sizeof(uint32_t)) != sizeof(uint32_t)) {
+                throw LZ4Exception();  // truncated stream
+            }
+            const uint32_t compressed_size = framed_lz4::read_uint32(frame_header);
+            if (compressed_size == 0) {
+                end_reached = true;
+                break;
+            }
+            if (framed_lz4::read_fully(src, frame_header + sizeof(uint32_t), sizeof(uint32_t)) != sizeof(uint32_t)) {
+                throw LZ4Exception();
+            }
+            const uint32_t raw_size = framed_lz4::read_uint32(frame_header + sizeof(uint32_t));
+            if (compressed_size > max_compressed_size || raw_size > block_size) {
+                throw LZ4Exception();
+            }
+            input_buffer.resize(input_size + compressed_size);
+            if (framed_lz4::read_fully(src, &input_buffer[input_size], compressed_size)
+                != std::streamsize(compressed_size)) {
+                throw LZ4Exception();
+            }
+            input_offsets.push_back(input_size);
+            output_offsets.push_back(output_size);
+            input_size += compressed_size;
+            output_size += raw_size;
+        }
+        if (input_offsets.empty()) {
+            return false;
+        }
+        input_offsets.push_back(input_size);
+        output_offsets.push_back(output_size);
+        output_buffer.resize(output_size);
+
+        const size_t nb_blocks = input_offsets.size() - 1;
+        std::atomic<bool> error{false};
+        framed_lz4::parallel_for(nb_blocks, nb_threads, [&](size_t i) {
+            const int compressed_size = input_offsets[i + 1] - input_offsets[i];
+            const int raw_size = output_offsets[i + 1] - output_offsets[i];
+            if (LZ4_decompress_safe(&input_buffer[input_offsets[i]], &output_buffer[output_offsets[i]],
+                                    compressed_size, raw_size)
+                != raw_size) {
+                error = true;
+            }
+        });
+        if (error) {
+            throw LZ4Exception();
+        }
+        return true;
+    }
+
+    template <typename Source>
+    std::streamsize read_legacy(Source& src, char* dest, std::streamsize size) {
+        // complete the pending bytes up to the size of the next chunk
+        const size_t nb_pending = legacy_prefix.size();
+        if (nb_pending < sizeof(uint32_t)) {
+            legacy_prefix.resize(sizeof(uint32_t));
+            auto nb_read = framed_lz4::read_fully(src, &legacy_prefix[nb_pending], sizeof(uint32_t) - nb_pending);
+            legacy_prefix.resize(nb_pending + nb_read);
+        }
+        if (legacy_prefix.empty()) {
+            return -1;  // end of the stream
+        }
+        if (legacy_prefix.size() < sizeof(uint32_t)) {
+            throw LZ4Exception();
+        }
+        const uint32_t chunk_size = framed_lz4::read_uint32(legacy_prefix.data());
+        input_buffer.assign(legacy_prefix.begin() + sizeof(uint32_t), legacy_prefix.end());
+        legacy_prefix.clear();
+        if (input_buffer.size() > chunk_size) {
+            // the beginning of the next chunk has been read with the header
+            legacy_prefix.assign(input_buffer.begin() + chunk_size, input_buffer.end());
+            input_buffer.resize(chunk_size);
+        } else {
+            const size_t already_read = input_buffer.size();
+            input_buffer.resize(chunk_size);
+            if (framed_lz4::read_fully(src, &input_buffer[already_read], chunk_size - already_read)
+                != std::streamsize(chunk_size - already_read)) {
+                throw LZ4Exception();
+            }
+        }
+        const int output_size = LZ4_decompress_safe(input_buffer.data(), dest, chunk_size, size);
+        if (output_size < 0) {
+            throw LZ4Exception();
+        }
+        return output_size;
+    }
+};
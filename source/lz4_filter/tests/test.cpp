@@ -29,6 +29,7 @@ www.navitia.io
 */
 
 #include "lz4_filter/filter.h"
+#include "lz4_filter/framed_filter.h"
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE test_lz4_filter
 #include <boost/test/unit_test.hpp>
@@ -37,6 +38,8 @@ www.navitia.io
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/device/file.hpp>
 #include <string>
+#include <sstream>
+#include <iterator>
 
 BOOST_AUTO_TEST_CASE(tiny_string_compression) {
     std::string str = "foo";
@@ -95,3 +98,105 @@ BOOST_AUTO_TEST_CASE(big_string_compression) {
     }
     BOOST_CHECK_EQUAL(str, result);
 }
+
+static std::string framed_roundtrip(const std::string& str, FramedLZ4Compressor compressor, size_t nb_threads) {
+    std::stringstream ss;
+    {
+        boost::iostreams::filtering_ostream out;
+        out.push(compressor);
+        out.push(ss);
+        out << str;
+    }
+    std::string result;
+    {
+        boost::iostreams::filtering_istream in;
+        in.push(FramedLZ4Decompressor(nb_threads));
+        in.push(ss);
+        result.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    return result;
+}
+
+static std::string big_string() {
+    std::string str;
+    for (int i = 0; i < 100000; i++) {
+        str += "stop_point:" + std::to_string(i * 7919 % 1000) + ";";
+    }
+    return str;
+}
+
+BOOST_AUTO_TEST_CASE(framed_empty_string_compression) {
+    BOOST_CHECK_EQUAL(framed_roundtrip("", FramedLZ4Compressor(), 4), "");
+}
+
+BOOST_AUTO_TEST_CASE(framed_tiny_string_compression) {
+    BOOST_CHECK_EQUAL(framed_roundtrip("foo", FramedLZ4Compressor(), 4), "foo");
+}
+
+BOOST_AUTO_TEST_CASE(framed_big_string_compression) {
+    const auto str = big_string();
+    // small blocks to have several batches of blocks
+    for (size_t nb_threads : {1, 3, 8}) {
+        BOOST_CHECK(framed_roundtrip(str, FramedLZ4Compressor(1000, false, nb_threads), nb_threads) == str);
+        BOOST_CHECK(framed_roundtrip(str, FramedLZ4Compressor(1000, true, nb_threads), 8 / nb_threads) == str);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(framed_high_compression_is_smaller) {
+    const auto str = big_string();
+    auto compressed_size = [&](bool high_compression) {
+        std::stringstream ss;
+        {
+            boost::iostreams::filtering_ostream out;
+            out.push(FramedLZ4Compressor(64 * 1024, high_compression));
+            out.push(ss);
+            out << str;
+        }
+        return ss.str().size();
+    };
+    BOOST_CHECK_LT(compressed_size(true), compressed_size(false));
+}
+
+// the framed decompressor must still read the files written by LZ4Compressor
+BOOST_AUTO_TEST_CASE(framed_decompressor_reads_legacy_format) {
+    std::string big = "foobariozafiozehfuiozefuigaezgfuzegfpuzheuerfhzeupgf";
+    for (int i = 0; i < 10; i++) {
+        big += big;
+    }
+    for (const std::string& str : {std::string(), std::string("foo"), big}) {
+        std::stringstream ss;
+        {
+            boost::iostreams::filtering_ostream out;
+            out.push(LZ4Compressor(2048));
+            out.push(ss);
+            out << str;
+        }
+        std::string result;
+        {
+            boost::iostreams::filtering_istream in;
+            in.push(FramedLZ4Decompressor(4), 8192, 8192);
+            in.push(ss);
+            result.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        BOOST_CHECK(result == str);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(framed_truncated_stream) {
+    const auto str = big_string();
+    std::stringstream ss;
+    {
+        boost::iostreams::filtering_ostream out;
+        out.push(FramedLZ4Compressor(1000));
+        out.push(ss);
+        out << str;
+    }
+    std::stringstream truncated(ss.str().substr(0, ss.str().size() / 2));
+    boost::iostreams::filtering_istream in;
+    in.push(FramedLZ4Decompressor(2));
+    in.push(truncated);
+    in.exceptions(std::ios::badbit);
+    std::string result;
+    BOOST_CHECK_THROW(result.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()),
+                      std::exception);
+}
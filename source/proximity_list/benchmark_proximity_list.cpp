@@ -0,0 +1,193 @@
+/* Copyright © 2001-2019, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+channel `#navitia` on riot https://riot.im/app/#/room/#navitia:matrix.org
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "proximity_list/proximity_list.h"
+#include "georef/georef.h"
+#include "type/data.h"
+#include "utils/init.h"
+
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+namespace po = boost::program_options;
+namespace pl = navitia::proximitylist;
+using navitia::type::GeographicalCoord;
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsed_seconds(const Clock::time_point& start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// queries/s of the given search over all the batches, the number of results is summed in nb_found
+template <typename Search>
+static double throughput(const std::vector<std::vector<GeographicalCoord>>& batches,
+                         const Search& search,
+                         size_t& nb_found) {
+    nb_found = 0;
+    size_t nb_queries = 0;
+    const auto start = Clock::now();
+    for (const auto& batch : batches) {
+        nb_found += search(batch);
+        nb_queries += batch.size();
+    }
+    return nb_queries / elapsed_seconds(start);
+}
+
+template <typename Tag>
+static void run(const std::vector<GeographicalCoord>& coords,
+                const std::vector<std::vector<GeographicalCoord>>& batches,
+                double radius,
+                int size) {
+    pl::ProximityList<unsigned int> kd_tree, grid;
+    for (size_t i = 0; i < coords.size(); ++i) {
+        kd_tree.add(coords[i], i);
+        grid.add(coords[i], i);
+    }
+    auto start = Clock::now();
+    kd_tree.build(pl::IndexType::KDTree);
+    std::cout << "KD-tree built in " << elapsed_seconds(start) << "s" << std::endl;
+    start = Clock::now();
+    grid.build(pl::IndexType::Grid);
+    std::cout << "grid built in " << elapsed_seconds(start) << "s (" << grid.grid_index->nb_cells() << " cells)"
+              << std::endl;
+
+    auto one_by_one = [&](const pl::ProximityList<unsigned int>* list) {
+        return [=](const std::vector<GeographicalCoord>& batch) {
+            size_t nb = 0;
+            for (const auto& coord : batch) {
+                nb += list->template find_within<Tag>(coord, radius, size).size();
+            }
+            return nb;
+        };
+    };
+    auto batched = [&](const pl::ProximityList<unsigned int>* list) {
+        return [=](const std::vector<GeographicalCoord>& batch) {
+            size_t nb = 0;
+            for (const auto& res : list->template find_within_many<Tag>(batch, radius, size)) {
+                nb += res.size();
+            }
+            return nb;
+        };
+    };
+
+    size_t nb_found = 0;
+    std::cout << "index\tapi\tqueries/s\tresults" << std::endl;
+    auto qps = throughput(batches, one_by_one(&kd_tree), nb_found);
+    std::cout << "kd-tree\tfind_within\t" << qps << "\t" << nb_found << std::endl;
+    qps = throughput(batches, batched(&kd_tree), nb_found);
+    std::cout << "kd-tree\tfind_within_many\t" << qps << "\t" << nb_found << std::endl;
+    qps = throughput(batches, one_by_one(&grid), nb_found);
+    std::cout << "grid\tfind_within\t" << qps << "\t" << nb_found << std::endl;
+    qps = throughput(batches, batched(&grid), nb_found);
+    std::cout << "grid\tfind_within_many\t" << qps << "\t" << nb_found << std::endl;
+}
+
+int main(int argc, char** argv) {
+    navitia::init_app();
+    po::options_description desc("Options of the proximity list benchmark");
+    std::string file;
+    size_t nb_points, batch_size, nb_batches;
+    double radius, extent;
+    int size;
+
+    // clang-format off
+    desc.add_options()
+        ("help", "Show this message")
+        ("file,f", po::value<std::string>(&file),
+         "Path to data.nav.lz4, the points are then the vertices of its street network, "
+         "random points are used otherwise")
+        ("points,p", po::value<size_t>(&nb_points)->default_value(1000000), "number of random points")
+        ("extent,e", po::value<double>(&extent)->default_value(50000),
+         "side in meters of the square of the random points and of the queries")
+        ("batch,b", po::value<size_t>(&batch_size)->default_value(1000), "number of coords of a batch")
+        ("batches,n", po::value<size_t>(&nb_batches)->default_value(100), "number of batches")
+        ("radius,r", po::value<double>(&radius)->default_value(500), "search radius in meters")
+        ("size,s", po::value<int>(&size)->default_value(-1), "max number of results by query, -1 for unlimited")
+        ("index_only", "only search the indexes, as the projections on the street network do");
+    // clang-format on
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help")) {
+        std::cout << "This is used to compare the throughput of the spatial indexes of the proximity lists"
+                  << std::endl;
+        std::cout << desc << std::endl;
+        return 1;
+    }
+
+    // around Paris
+    const GeographicalCoord center(2.35, 48.85);
+    const double coslat = std::cos(center.lat() * GeographicalCoord::N_DEG_TO_RAD);
+    const double lat_extent = extent / 111320.;
+    const double lon_extent = lat_extent / coslat;
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> dist(-0.5, 0.5);
+    auto random_coord = [&]() {
+        return GeographicalCoord(center.lon() + dist(gen) * lon_extent, center.lat() + dist(gen) * lat_extent);
+    };
+
+    std::vector<GeographicalCoord> coords;
+    if (vm.count("file")) {
+        navitia::type::Data data;
+        data.load_nav(file);
+        for (const auto& item : data.geo_ref->pl_walking.items) {
+            coords.push_back(item.coord);
+        }
+    } else {
+        coords.reserve(nb_points);
+        for (size_t i = 0; i < nb_points; ++i) {
+            coords.push_back(random_coord());
+        }
+    }
+    std::cout << coords.size() << " points, " << nb_batches << " batches of " << batch_size << " coords"
+              << std::endl;
+
+    // the queries are taken around the points so that they hit the populated areas
+    std::uniform_int_distribution<size_t> point(0, coords.empty() ? 0 : coords.size() - 1);
+    std::vector<std::vector<GeographicalCoord>> batches(nb_batches);
+    for (auto& batch : batches) {
+        for (size_t i = 0; i < batch_size && !coords.empty(); ++i) {
+            const auto& c = coords[point(gen)];
+            batch.emplace_back(c.lon() + dist(gen) * 0.001, c.lat() + dist(gen) * 0.001);
+        }
+    }
+
+    if (vm.count("index_only")) {
+        run<pl::IndexOnly>(coords, batches, radius, size);
+    } else {
+        run<pl::IndexCoord>(coords, batches, radius, size);
+    }
+    return 0;
+}
@@ -0,0 +1,150 @@
+/* Copyright © 2001-2019, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+channel `#navitia` on riot https://riot.im/app/#/room/#navitia:matrix.org
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "proximity_list/grid_index.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace navitia {
+namespace proximitylist {
+
+// the cell coords are packed on 21 bits each in the key of the cell
+static const int32_t cell_coord_offset = 1 << 20;
+static const uint64_t cell_coord_mask = (uint64_t(1) << 21) - 1;
+// with smaller cells, the cell coords of the earth would not fit in 21 bits
+static const float min_cell_size = 10.f;
+
+static uint64_t make_key(int32_t x, int32_t y, int32_t z) {
+    return ((uint64_t(x + cell_coord_offset) & cell_coord_mask) << 42)
+           | ((uint64_t(y + cell_coord_offset) & cell_coord_mask) << 21)
+           | (uint64_t(z + cell_coord_offset) & cell_coord_mask);
+}
+
+GridIndex::GridIndex(const float* projected_coords, size_t nb_points, float cell_size)
+    : cell_size(std::max(cell_size, min_cell_size)) {
+    std::vector<std::pair<uint64_t, uint32_t>> keyed_points;
+    keyed_points.reserve(nb_points);
+    for (size_t i = 0; i < nb_points; ++i) {
+        const float* coord = projected_coords + 3 * i;
+        keyed_points.emplace_back(make_key(cell_coord(coord[0]), cell_coord(coord[1]), cell_coord(coord[2])), i);
+    }
+    std::sort(keyed_points.begin(), keyed_points.end());
+
+    xs.reserve(nb_points);
+    ys.reserve(nb_points);
+    zs.reserve(nb_points);
+    point_ids.reserve(nb_points);
+    for (const auto& keyed_point : keyed_points) {
+        if (cell_keys.empty() || cell_keys.back() != keyed_point.first) {
+            cell_keys.push_back(keyed_point.first);
+            cell_offsets.push_back(point_ids.size());
+        }
+        const float* coord = projected_coords + 3 * keyed_point.second;
+        xs.push_back(coord[0]);
+        ys.push_back(coord[1]);
+        zs.push_back(coord[2]);
+        point_ids.push_back(keyed_point.second);
+    }
+    cell_offsets.push_back(point_ids.size());
+}
+
+int32_t GridIndex::cell_coord(float v) const {
+    const auto coord = std::floor(v / cell_size);
+    return int32_t(std::max(std::min(coord, float(cell_coord_offset - 1)), float(-cell_coord_offset)));
+}
+
+void GridIndex::scan(size_t begin,
+                     size_t end,
+                     const std::array<float, 3>& query,
+                     float sqr_radius,
+                     std::vector<float>& distances,
+                     std::vector<std::pair<float, uint32_t>>& result) const {
+    const size_t nb = end - begin;
+    distances.resize(nb);
+    const float* x = xs.data() + begin;
+    const float* y = ys.data() + begin;
+    const float* z = zs.data() + begin;
+    float* dist = distances.data();
+    // no branch in this loop, so that it is vectorized
+    for (size_t i = 0; i < nb; ++i) {
+        const float dx = x[i] - query[0];
+        const float dy = y[i] - query[1];
+        const float dz = z[i] - query[2];
+        dist[i] = dx * dx + dy * dy + dz * dz;
+    }
+    for (size_t i = 0; i < nb; ++i) {
+        if (dist[i] <= sqr_radius) {
+            result.emplace_back(dist[i], point_ids[begin + i]);
+        }
+    }
+}
+
+void GridIndex::radius_search(const std::array<float, 3>& query,
+                              float sqr_radius,
+                              int max_neighbors,
+                              std::vector<std::pair<float, uint32_t>>& result) const {
+    result.clear();
+    if (cell_keys.empty()) {
+        return;
+    }
+    std::vector<float> distances;
+    const float radius = std::sqrt(sqr_radius);
+    const int32_t min_x = cell_coord(query[0] - radius), max_x = cell_coord(query[0] + radius);
+    const int32_t min_y = cell_coord(query[1] - radius), max_y = cell_coord(query[1] + radius);
+    const int32_t min_z = cell_coord(query[2] - radius), max_z = cell_coord(query[2] + radius);
+
+    const int64_t nb_columns = int64_t(max_x - min_x + 1) * int64_t(max_y - min_y + 1);
+    if (nb_columns > int64_t(cell_keys.size())) {
+        // the search box is too big compared to the populated area, a full scan is cheaper
+        scan(0, point_ids.size(), query, sqr_radius, distances, result);
+    } else {
+        for (int32_t x = min_x; x <= max_x; ++x) {
+            for (int32_t y = min_y; y <= max_y; ++y) {
+                const auto first = std::lower_bound(cell_keys.begin(), cell_keys.end(), make_key(x, y, min_z));
+                const auto last = std::upper_bound(first, cell_keys.end(), make_key(x, y, max_z));
+                if (first != last) {
+                    scan(cell_offsets[first - cell_keys.begin()], cell_offsets[last - cell_keys.begin()], query,
+                         sqr_radius, distances, result);
+                }
+            }
+        }
+    }
+
+    if (max_neighbors >= 0 && size_t(max_neighbors) < result.size()) {
+        std::partial_sort(result.begin(), result.begin() + max_neighbors, result.end());
+        result.resize(max_neighbors);
+    } else {
+        std::sort(result.begin(), result.end());
+    }
+}
+
+}  // namespace proximitylist
+}  // namespace navitia
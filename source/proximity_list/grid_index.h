@@ -0,0 +1,91 @@
+/* Copyright © 2001-2019, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+channel `#navitia` on riot https://riot.im/app/#/room/#navitia:matrix.org
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace navitia {
+namespace proximitylist {
+
+/* Uniform grid over the points projected in 3D (see project_coord)
+ *
+ * The points are sorted by cell, the cells being sorted by (x, y, z), so
+ * that all the points of a column of cells along z are contiguous. A radius
+ * search is then a binary search and a linear scan for each column of cells
+ * intersecting the search box.
+ *
+ * The coordinates are stored in separate arrays so that the computation
+ * of the distances of a column is vectorized by the compiler.
+ * */
+class GridIndex {
+public:
+    // nb_points projected points, 3 floats by point
+    GridIndex(const float* projected_coords, size_t nb_points, float cell_size = 500.f);
+
+    /* Points whose squared distance to the query is at most sqr_radius, as
+     * (squared distance, index of the point in the coords given at build)
+     * sorted by distance, only the max_neighbors nearest ones are kept
+     * (-1 for unlimited).
+     *
+     * The result is cleared first.
+     * */
+    void radius_search(const std::array<float, 3>& query,
+                       float sqr_radius,
+                       int max_neighbors,
+                       std::vector<std::pair<float, uint32_t>>& result) const;
+
+    size_t size() const { return point_ids.size(); }
+    size_t nb_cells() const { return cell_keys.size(); }
+
+private:
+    float cell_size;
+    // sorted keys of the non empty cells, the points of the cell i are
+    // [cell_offsets[i], cell_offsets[i + 1])
+    std::vector<uint64_t> cell_keys;
+    std::vector<uint32_t> cell_offsets;
+    std::vector<float> xs, ys, zs;
+    std::vector<uint32_t> point_ids;
+
+    int32_t cell_coord(float v) const;
+    void scan(size_t begin,
+              size_t end,
+              const std::array<float, 3>& query,
+              float sqr_radius,
+              std::vector<float>& distances,
+              std::vector<std::pair<float, uint32_t>>& result) const;
+};
+
+}  // namespace proximitylist
+}  // namespace navitia
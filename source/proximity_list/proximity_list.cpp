@@ -1,6 +1,7 @@
 #include "proximity_list.h"
 #include "type/geographical_coord.h"
 
+#include <algorithm>
 #include <cmath>
 #include <array>
 #include <exception>
@@ -37,14 +38,25 @@ static float search_radius_correction_factor(const double& radius) {
                      * asin(radius / (2. * GeographicalCoord::EARTH_RADIUS_IN_METERS)) / radius;
 }
 
+// Maximum number of results of the IndexOnly searches
+static const std::size_t max_index_only_size = 100;
+
+// squared radius in the projected space
+static float projected_sqr_radius(double radius) {
+    radius = std::min(radius, 2 * GeographicalCoord::EARTH_RADIUS_IN_METERS);
+    float factor = search_radius_correction_factor(radius);
+    return pow(radius * static_cast<double>(factor), 2);
+}
+
 template <class T>
-void ProximityList<T>::build() {
+void ProximityList<T>::build(IndexType index_type) {
     log4cplus::Logger logger = log4cplus::Logger::getInstance("log");
     LOG4CPLUS_INFO(logger, "Building Proximitylist's NN index with " << items.size() << " items");
 
     // clean NN index
     NN_data.clear();
     NN_index.reset();
+    grid_index.reset();
 
     if (items.empty()) {
         LOG4CPLUS_WARN(logger, "No items for building the index");
@@ -55,11 +67,40 @@ void ProximityList<T>::build() {
         auto projected = project_coord(i.coord);
         std::copy(projected.begin(), projected.end(), std::back_inserter(NN_data));
     }
+    if (index_type == IndexType::Grid) {
+        grid_index = std::make_shared<const GridIndex>(NN_data.data(), items.size());
+        return;
+    }
     auto points = flann::Matrix<float>{&NN_data[0], NN_data.size() / 3, 3};
     NN_index = std::make_shared<navitia::proximitylist::index_t>(points, flann::KDTreeSingleIndexParams(10));
     NN_index->buildIndex();
 }
 
+template <class T>
+void ProximityList<T>::build(const float* projected_coords, IndexType index_type) {
+    log4cplus::Logger logger = log4cplus::Logger::getInstance("log");
+    LOG4CPLUS_INFO(logger, "Building Proximitylist's NN index on external coords with " << items.size() << " items");
+
+    NN_data.clear();
+    NN_index.reset();
+    grid_index.reset();
+
+    if (items.empty()) {
+        LOG4CPLUS_WARN(logger, "No items for building the index");
+        return;
+    }
+    if (index_type == IndexType::Grid) {
+        grid_index = std::make_shared<const GridIndex>(projected_coords, items.size());
+        return;
+    }
+
+    // the points are not reordered so that flann works in place on
+    // the given coords instead of copying them
+    auto points = flann::Matrix<float>{const_cast<float*>(projected_coords), items.size(), 3};
+    NN_index = std::make_shared<navitia::proximitylist::index_t>(points, flann::KDTreeSingleIndexParams(10, false));
+    NN_index->buildIndex();
+}
+
 template <typename T, typename Item>
 static auto extract(const Item& item, IndexCoord) -> typename ReturnTypeTrait<T, IndexCoord>::ValueType {
     return std::make_pair(item.element, item.coord);
@@ -113,11 +154,8 @@ static int radius_search(const std::shared_ptr<index_t>& NN_index,
     auto search_param = flann::SearchParams{};
     search_param.max_neighbors = size;  // -1 -> unlimited
 
-    radius = std::min(radius, 2 * GeographicalCoord::EARTH_RADIUS_IN_METERS);
-
-    float factor = search_radius_correction_factor(radius);
     int nb_found = NN_index->radiusSearch(flann::Matrix<float>{&query[0], 1, 3}, indices, distances,
-                                          pow(radius * static_cast<double>(factor), 2), search_param);
+                                          projected_sqr_radius(radius), search_param);
 
     LOG4CPLUS_TRACE(log4cplus::Logger::getInstance("log"),
                     "" << nb_found << " point found for the coord: " << coord.lon() << " " << coord.lat());
@@ -125,9 +163,30 @@ static int radius_search(const std::shared_ptr<index_t>& NN_index,
     return nb_found;
 }
 
+template <typename T, typename Items, typename Tag>
+static auto grid_search(const GridIndex& grid_index,
+                        const Items& items,
+                        const GeographicalCoord& coord,
+                        double radius,
+                        int size,
+                        std::vector<std::pair<float, uint32_t>>& found,
+                        Tag) -> std::vector<typename ReturnTypeTrait<T, Tag>::ValueType> {
+    grid_index.radius_search(project_coord(coord), projected_sqr_radius(radius), size, found);
+    std::vector<typename ReturnTypeTrait<T, Tag>::ValueType> res;
+    res.reserve(found.size());
+    for (const auto& distance_and_id : found) {
+        res.push_back(extract<T>(items[distance_and_id.second], Tag{}));
+    }
+    return res;
+}
+
 template <class T>
 auto ProximityList<T>::find_within_impl(const GeographicalCoord& coord, double radius, int size, IndexCoord) const
     -> std::vector<typename ReturnTypeTrait<T, IndexCoord>::ValueType> {
+    if (grid_index) {
+        std::vector<std::pair<float, uint32_t>> found;
+        return grid_search<T>(*grid_index, items, coord, radius, size, found, IndexCoord{});
+    }
     // Containers are auto-sized by NN_index, Flann will return all objects inside of the given radius
     std::vector<std::vector<int>> indices;
     std::vector<std::vector<index_t::DistanceType>> distances;
@@ -140,8 +199,13 @@ auto ProximityList<T>::find_within_impl(const GeographicalCoord& coord, double r
 template <class T>
 auto ProximityList<T>::find_within_impl(const GeographicalCoord& coord, double radius, int size, IndexOnly) const
     -> std::vector<typename ReturnTypeTrait<T, IndexOnly>::ValueType> {
+    if (grid_index) {
+        std::vector<std::pair<float, uint32_t>> found;
+        return grid_search<T>(*grid_index, items, coord, radius, size == -1 ? int(max_index_only_size) : size, found,
+                              IndexOnly{});
+    }
     // Using small sized std::array will avoid heap allocation and limit the research
-    const static std::size_t max_size = 100;
+    const static std::size_t max_size = max_index_only_size;
     std::array<int, max_size> indices_data;
     flann::Matrix<int> indices(&indices_data[0], 1, size == -1 ? max_size : size);
     std::array<index_t::DistanceType, max_size> distances_data;
@@ -150,6 +214,84 @@ auto ProximityList<T>::find_within_impl(const GeographicalCoord& coord, double r
     return make_result<T>(coord, items, indices_data, distances_data, nb_found, IndexOnly{});
 }
 
+template <typename T, typename Items, typename Tag>
+static auto find_within_many_kd_tree(const std::shared_ptr<index_t>& NN_index,
+                                     const Items& items,
+                                     const std::vector<GeographicalCoord>& coords,
+                                     double radius,
+                                     int size,
+                                     Tag) -> std::vector<std::vector<typename ReturnTypeTrait<T, Tag>::ValueType>> {
+    std::vector<float> queries;
+    queries.reserve(3 * coords.size());
+    for (const auto& coord : coords) {
+        auto projected = project_coord(coord);
+        std::copy(projected.begin(), projected.end(), std::back_inserter(queries));
+    }
+
+    auto search_param = flann::SearchParams{};
+    search_param.max_neighbors = size;  // -1 -> unlimited
+    std::vector<std::vector<int>> indices;
+    std::vector<std::vector<index_t::DistanceType>> distances;
+    NN_index->radiusSearch(flann::Matrix<float>{queries.data(), coords.size(), 3}, indices, distances,
+                           projected_sqr_radius(radius), search_param);
+
+    std::vector<std::vector<typename ReturnTypeTrait<T, Tag>::ValueType>> res;
+    res.reserve(coords.size());
+    for (size_t i = 0; i < coords.size(); ++i) {
+        res.push_back(make_result<T>(coords[i], items, indices[i], distances[i], indices[i].size(), Tag{}));
+    }
+    return res;
+}
+
+template <typename T, typename Items, typename Tag>
+static auto find_within_many_grid(const GridIndex& grid_index,
+                                  const Items& items,
+                                  const std::vector<GeographicalCoord>& coords,
+                                  double radius,
+                                  int size,
+                                  Tag) -> std::vector<std::vector<typename ReturnTypeTrait<T, Tag>::ValueType>> {
+    std::vector<std::vector<typename ReturnTypeTrait<T, Tag>::ValueType>> res;
+    res.reserve(coords.size());
+    // the buffer of the search is reused for all the coords
+    std::vector<std::pair<float, uint32_t>> found;
+    for (const auto& coord : coords) {
+        res.push_back(grid_search<T>(grid_index, items, coord, radius, size, found, Tag{}));
+    }
+    return res;
+}
+
+template <class T>
+auto ProximityList<T>::find_within_many_impl(const std::vector<GeographicalCoord>& coords,
+                                             double radius,
+                                             int size,
+                                             IndexCoord) const
+    -> std::vector<std::vector<typename ReturnTypeTrait<T, IndexCoord>::ValueType>> {
+    if (coords.empty()) {
+        return {};
+    }
+    if (grid_index) {
+        return find_within_many_grid<T>(*grid_index, items, coords, radius, size, IndexCoord{});
+    }
+    return find_within_many_kd_tree<T>(NN_index, items, coords, radius, size, IndexCoord{});
+}
+
+template <class T>
+auto ProximityList<T>::find_within_many_impl(const std::vector<GeographicalCoord>& coords,
+                                             double radius,
+                                             int size,
+                                             IndexOnly) const
+    -> std::vector<std::vector<typename ReturnTypeTrait<T, IndexOnly>::ValueType>> {
+    if (coords.empty()) {
+        return {};
+    }
+    // same limit as find_within
+    size = size == -1 ? int(max_index_only_size) : size;
+    if (grid_index) {
+        return find_within_many_grid<T>(*grid_index, items, coords, radius, size, IndexOnly{});
+    }
+    return find_within_many_kd_tree<T>(NN_index, items, coords, radius, size, IndexOnly{});
+}
+
 NotFound::~NotFound() noexcept {}
 
 template struct ProximityList<unsigned int>;
@@ -31,6 +31,7 @@ www.navitia.io
 #pragma once
 
 #include "type/geographical_coord.h"
+#include "proximity_list/grid_index.h"
 #include "utils/exception.h"
 #include "utils/logger.h"
 #include <memory>
@@ -65,6 +66,12 @@ struct IndexCoord {};
 template <typename T, typename Tag>
 struct ReturnTypeTrait;
 
+// Spatial index used by the proximity list
+enum class IndexType {
+    KDTree,  // flann KD-tree
+    Grid     // uniform grid, see GridIndex
+};
+
 template <typename T>
 struct ReturnTypeTrait<T, IndexOnly> {
     typedef T ValueType;
@@ -102,16 +109,28 @@ struct ProximityList {
     std::vector<Item> items;
     std::vector<float> NN_data;
     std::shared_ptr<index_t> NN_index = nullptr;
+    std::shared_ptr<const GridIndex> grid_index = nullptr;
 
     /// Rajoute un nouvel élément. Attention, il faut appeler build avant de pouvoir utiliser la structure
     void add(GeographicalCoord coord, T element) { items.push_back(Item(coord, element)); }
     void clear() {
         items.clear();
         NN_data.clear();
+        NN_index.reset();
+        grid_index.reset();
     }
 
     // build the Nearest Neighbours data from items, then the index
-    void build();
+    void build(IndexType index_type = IndexType::KDTree);
+
+    // build the index directly on already projected coords (3 floats
+    // by item, in the order of items) that are not owned by the
+    // proximity list (typically mapped from the flat .nav file) and
+    // must outlive it.
+    // The grid index copies them
+    void build(const float* projected_coords, IndexType index_type = IndexType::KDTree);
+
+    bool has_index() const { return NN_index || grid_index; }
 
     /*
      * This method can return two types of result
@@ -125,11 +144,24 @@ struct ProximityList {
     template <typename Tag = IndexCoord>
     auto find_within(const GeographicalCoord& coord, double radius = 500, int size = -1) const
         -> std::vector<typename ReturnTypeTrait<T, Tag>::ValueType> {
-        if (!NN_index || !size || !radius)
+        if (!has_index() || !size || !radius)
             return {};
         return find_within_impl(coord, radius, size, Tag{});
     }
 
+    /*
+     * Same as find_within for a batch of coords, the i-th result is the one of coords[i].
+     *
+     * With the KD-tree, all the coords are searched in one call to the index.
+     * */
+    template <typename Tag = IndexCoord>
+    auto find_within_many(const std::vector<GeographicalCoord>& coords, double radius = 500, int size = -1) const
+        -> std::vector<std::vector<typename ReturnTypeTrait<T, Tag>::ValueType>> {
+        if (!has_index() || !size || !radius)
+            return std::vector<std::vector<typename ReturnTypeTrait<T, Tag>::ValueType>>(coords.size());
+        return find_within_many_impl(coords, radius, size, Tag{});
+    }
+
     /// Fonction de confort pour retrouver l'élément le plus proche dans l'indexe
     T find_nearest(double lon, double lat) const { return find_nearest(GeographicalCoord(lon, lat)); }
 
@@ -172,6 +204,11 @@ private:
      * */
     auto find_within_impl(const GeographicalCoord& coord, double radius, int size, IndexOnly) const
         -> std::vector<typename ReturnTypeTrait<T, IndexOnly>::ValueType>;
+
+    auto find_within_many_impl(const std::vector<GeographicalCoord>& coords, double radius, int size, IndexCoord) const
+        -> std::vector<std::vector<typename ReturnTypeTrait<T, IndexCoord>::ValueType>>;
+    auto find_within_many_impl(const std::vector<GeographicalCoord>& coords, double radius, int size, IndexOnly) const
+        -> std::vector<std::vector<typename ReturnTypeTrait<T, IndexOnly>::ValueType>>;
 };
 
 }  // namespace proximitylist
@@ -368,3 +368,73 @@ BOOST_AUTO_TEST_CASE(test_poi_filter) {
     BOOST_CHECK(poi_names.find("bob") != poi_names.end());
     BOOST_CHECK(poi_names.find("bobette") != poi_names.end());
 }
+
+BOOST_AUTO_TEST_CASE(grid_index_and_batch) {
+    // about 1600 points around Nantes with a deterministic jitter
+    ProximityList<unsigned int> kd_tree;
+    ProximityList<unsigned int> grid;
+    unsigned int seed = 42;
+    auto jitter = [&]() {
+        seed = seed * 1103515245 + 12345;
+        return double((seed >> 16) % 1000) / 1000. * 0.0003;
+    };
+    unsigned int element = 0;
+    for (int i = 0; i < 40; ++i) {
+        for (int j = 0; j < 40; ++j) {
+            GeographicalCoord coord(-1.57 + i * 0.0005 + jitter(), 47.20 + j * 0.0003 + jitter());
+            kd_tree.add(coord, element);
+            grid.add(coord, element);
+            ++element;
+        }
+    }
+    kd_tree.build();
+    grid.build(IndexType::Grid);
+    BOOST_REQUIRE(grid.grid_index);
+    BOOST_CHECK(!grid.NN_index);
+
+    std::vector<GeographicalCoord> queries;
+    for (int i = 0; i < 50; ++i) {
+        queries.emplace_back(-1.57 + jitter() * 60, 47.20 + jitter() * 40);
+    }
+    // far from everything
+    queries.emplace_back(2.35, 48.85);
+
+    auto elements = [](const std::vector<std::pair<unsigned int, GeographicalCoord>>& res) {
+        std::vector<unsigned int> elts;
+        for (const auto& r : res) {
+            elts.push_back(r.first);
+        }
+        std::sort(elts.begin(), elts.end());
+        return elts;
+    };
+    auto sorted = [](std::vector<unsigned int> elts) {
+        std::sort(elts.begin(), elts.end());
+        return elts;
+    };
+
+    const auto kd_tree_batch = kd_tree.find_within_many(queries, 200);
+    const auto grid_batch = grid.find_within_many(queries, 200);
+    const auto kd_tree_nearest_batch = kd_tree.find_within_many<IndexOnly>(queries, 300, 5);
+    const auto grid_nearest_batch = grid.find_within_many<IndexOnly>(queries, 300, 5);
+    BOOST_REQUIRE_EQUAL(kd_tree_batch.size(), queries.size());
+    BOOST_REQUIRE_EQUAL(grid_batch.size(), queries.size());
+    BOOST_REQUIRE_EQUAL(kd_tree_nearest_batch.size(), queries.size());
+    BOOST_REQUIRE_EQUAL(grid_nearest_batch.size(), queries.size());
+
+    auto check_equal = [](const std::vector<unsigned int>& res, const std::vector<unsigned int>& expected) {
+        BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(), expected.begin(), expected.end());
+    };
+    for (size_t i = 0; i < queries.size(); ++i) {
+        const auto expected = elements(kd_tree.find_within(queries[i], 200));
+        check_equal(elements(grid.find_within(queries[i], 200)), expected);
+        check_equal(elements(kd_tree_batch[i]), expected);
+        check_equal(elements(grid_batch[i]), expected);
+
+        const auto expected_nearest = sorted(kd_tree.find_within<IndexOnly>(queries[i], 300, 5));
+        check_equal(sorted(grid.find_within<IndexOnly>(queries[i], 300, 5)), expected_nearest);
+        check_equal(sorted(kd_tree_nearest_batch[i]), expected_nearest);
+        check_equal(sorted(grid_nearest_batch[i]), expected_nearest);
+    }
+    BOOST_CHECK(grid_batch.back().empty());
+    BOOST_CHECK_EQUAL(grid.find_nearest(queries.front()), kd_tree.find_nearest(queries.front()));
+}
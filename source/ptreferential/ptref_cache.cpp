@@ -0,0 +1,89 @@
+/* Copyright © 2001-2019, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+channel `#navitia` on riot https://riot.im/app/#/room/#navitia:matrix.org
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "ptref_cache.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace navitia {
+namespace ptref {
+
+PtrefCache::PtrefCache(const type::Data& data, size_t max_cache, size_t nb_shards) {
+    nb_shards = std::max(size_t(1), std::min(nb_shards, max_cache));
+    const size_t shard_size = std::max(size_t(1), (max_cache + nb_shards - 1) / nb_shards);
+    for (size_t i = 0; i < nb_shards; ++i) {
+        // an expression is shared by the requested types, and the parsing is
+        // cheaper than the evaluation: keep as many of them as the results
+        parse_lrus.push_back(std::make_unique<ConcurrentLru<ParseCreator>>(ParseCreator(), shard_size));
+        eval_lrus.push_back(std::make_unique<ConcurrentLru<EvalCreator>>(EvalCreator(data, *this), shard_size));
+    }
+}
+
+PtrefCache::~PtrefCache() = default;
+
+size_t PtrefCache::shard(const std::string& key, size_t nb_shards) {
+    return std::hash<std::string>()(key) % nb_shards;
+}
+
+ast::Expr PtrefCache::ParseCreator::operator()(const std::string& request) const {
+    return ptref::parse(request);
+}
+
+type::Indexes PtrefCache::EvalCreator::operator()(const std::string& key) const {
+    const auto requested_type = static_cast<type::Type_e>(key.front());
+    const auto expr = cache.parse(key.substr(1));
+    return ptref::eval(requested_type, *expr, data);
+}
+
+std::shared_ptr<const ast::Expr> PtrefCache::parse(const std::string& request) {
+    return (*parse_lrus[shard(request, parse_lrus.size())])(request);
+}
+
+std::shared_ptr<const type::Indexes> PtrefCache::eval(const type::Type_e requested_type, const std::string& request) {
+    const auto key = static_cast<char>(requested_type) + request;
+    return (*eval_lrus[shard(key, eval_lrus.size())])(key);
+}
+
+PtrefCacheStats PtrefCache::get_stats() const {
+    PtrefCacheStats stats;
+    for (const auto& lru : eval_lrus) {
+        stats.nb_calls += lru->get_nb_calls();
+        stats.nb_cache_miss += lru->get_nb_cache_miss();
+    }
+    for (const auto& lru : parse_lrus) {
+        stats.nb_parse_calls += lru->get_nb_calls();
+        stats.nb_parse_cache_miss += lru->get_nb_cache_miss();
+    }
+    return stats;
+}
+
+}  // namespace ptref
+}  // namespace navitia
@@ -0,0 +1,97 @@
+/* Copyright © 2001-2019, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+channel `#navitia` on riot https://riot.im/app/#/room/#navitia:matrix.org
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+
+#include "ptreferential_ng.h"
+#include "utils/lru.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace navitia {
+namespace ptref {
+
+struct PtrefCacheStats {
+    size_t nb_calls = 0;
+    size_t nb_cache_miss = 0;
+    size_t nb_parse_calls = 0;
+    size_t nb_parse_cache_miss = 0;
+};
+
+/**
+ * Cache of the ptref filters of a Data
+ *
+ * Both the parsed expressions and the indexes they evaluate to are kept in
+ * LRUs. The cache belongs to the Data it has been built on and is never
+ * invalidated: a realtime update or a reload gives a new Data (and thus a new
+ * data_identifier) with its own empty cache.
+ *
+ * The LRUs are split in shards chosen by the hash of the request, so that the
+ * concurrent requests of the workers seldom wait for the same lock.
+ */
+struct PtrefCache {
+    // max_cache is the total number of evaluated requests kept, shared between the shards
+    PtrefCache(const type::Data& data, size_t max_cache, size_t nb_shards = 8);
+    ~PtrefCache();
+
+    std::shared_ptr<const ast::Expr> parse(const std::string& request);
+
+    // request is the full request as given by make_request
+    std::shared_ptr<const type::Indexes> eval(const type::Type_e requested_type, const std::string& request);
+
+    PtrefCacheStats get_stats() const;
+
+private:
+    struct ParseCreator {
+        typedef const std::string& argument_type;
+        typedef ast::Expr result_type;
+        ast::Expr operator()(const std::string& request) const;
+    };
+
+    // the key is the requested type encoded in its first char, followed by the request
+    struct EvalCreator {
+        typedef const std::string& argument_type;
+        typedef type::Indexes result_type;
+        const type::Data& data;
+        PtrefCache& cache;
+        EvalCreator(const type::Data& data, PtrefCache& cache) : data(data), cache(cache) {}
+        type::Indexes operator()(const std::string& key) const;
+    };
+
+    static size_t shard(const std::string& key, size_t nb_shards);
+
+    std::vector<std::unique_ptr<ConcurrentLru<ParseCreator>>> parse_lrus;
+    std::vector<std::unique_ptr<ConcurrentLru<EvalCreator>>> eval_lrus;
+};
+
+}  // namespace ptref
+}  // namespace navitia
@@ -31,6 +31,7 @@ www.navitia.io
 #include "ptreferential_ng.h"
 #include "ptreferential_utils.h"
 #include "ptreferential.h"
+#include "ptref_cache.h"
 #include "type/pt_data.h"
 #include "utils/logger.h"
 
@@ -477,6 +478,10 @@ std::string make_request(const Type_e requested_type,
     return res;
 }
 
+Indexes eval(const Type_e requested_type, const ast::Expr& expr, const type::Data& data) {
+    return Eval(requested_type, data)(expr);
+}
+
 Indexes make_query_ng(const Type_e requested_type,
                       const std::string& request,
                       const std::vector<std::string>& forbidden_uris,
@@ -488,6 +493,9 @@ Indexes make_query_ng(const Type_e requested_type,
     auto logger = log4cplus::Logger::getInstance("ptref");
     const auto request_ng =
         make_request(requested_type, request, forbidden_uris, odt_level, since, until, rt_level, data);
+    if (data.ptref_cache) {
+        return *data.ptref_cache->eval(requested_type, request_ng);
+    }
     const auto expr = parse(request_ng);
     LOG4CPLUS_TRACE(logger, "ptref_ng parsed: " << expr << " [requesting: "
                                                 << navitia::type::static_data::captionByType(requested_type) << "]");
@@ -116,6 +116,7 @@ std::ostream& operator<<(std::ostream& os, const BinaryOp<Diff>& op);
 }  // namespace ast
 
 ast::Expr parse(const std::string& s);
+type::Indexes eval(const type::Type_e requested_type, const ast::Expr& expr, const type::Data& data);
 std::string make_request(const type::Type_e requested_type,
                          const std::string& request,
                          const std::vector<std::string>& forbidden_uris,
@@ -31,6 +31,7 @@ www.navitia.io
 #include "ptreferential_utils.h"
 #include "ptreferential.h"
 #include "ptref_graph.h"
+#include "relation_index.h"
 #include "type/message.h"
 #include "type/data.h"
 #include "type/pt_data.h"
@@ -38,6 +39,7 @@ www.navitia.io
 #include "routing/dataraptor.h"
 
 #include <boost/range/algorithm/find.hpp>
+#include <boost/dynamic_bitset.hpp>
 #include <string>
 
 using navitia::type::Data;
@@ -66,16 +68,36 @@ Indexes get_intersection(const Indexes& idxs1, const Indexes& idxs2) {
 
 Indexes get_corresponding(Indexes indexes, Type_e from, const Type_e to, const Data& data) {
     const std::map<Type_e, Type_e> path = find_path(to);
-    std::set<idx_t> set_idx{indexes.begin(), indexes.end()};
     while (path.at(from) != from) {
-        set_idx = data.get_target_by_source(from, path.at(from), set_idx);
-        from = path.at(from);
+        const Type_e next = path.at(from);
+        // the targets are marked in a bitmap: merging ordered sets is way too
+        // slow for broad filters, like all the stop points of a network
+        boost::dynamic_bitset<> targets(data.get_nb_obj(next));
+        if (data.relation_index) {
+            data.relation_index->mark_targets(from, next, indexes, targets);
+        } else {
+            for (const auto idx : indexes) {
+                for (const auto target_idx : data.get_target_by_one_source(from, next, idx)) {
+                    if (target_idx >= targets.size()) {
+                        targets.resize(target_idx + 1);
+                    }
+                    targets.set(target_idx);
+                }
+            }
+        }
+        std::vector<idx_t> sorted_targets;
+        sorted_targets.reserve(targets.count());
+        for (auto i = targets.find_first(); i != boost::dynamic_bitset<>::npos; i = targets.find_next(i)) {
+            sorted_targets.push_back(idx_t(i));
+        }
+        indexes = Indexes{boost::container::ordered_unique_range_t(), sorted_targets.begin(), sorted_targets.end()};
+        from = next;
     }
     if (from != to) {
         // there was no path to find a requested type
         return Indexes{};
     }
-    return Indexes{boost::container::ordered_unique_range_t(), set_idx.begin(), set_idx.end()};
+    return indexes;
 }
 
 Type_e type_by_caption(const std::string& type) {
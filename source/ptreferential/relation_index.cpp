@@ -0,0 +1,92 @@
+/* Copyright © 2001-2019, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+channel `#navitia` on riot https://riot.im/app/#/room/#navitia:matrix.org
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "relation_index.h"
+
+namespace navitia {
+namespace ptref {
+
+constexpr size_t RelationIndex::nb_types;
+
+static void mark(const idx_t idx, boost::dynamic_bitset<>& bits) {
+    if (idx >= bits.size()) {
+        bits.resize(idx + 1);
+    }
+    bits.set(idx);
+}
+
+const RelationIndex::Relation& RelationIndex::get_relation(const type::Type_e source,
+                                                           const type::Type_e target) const {
+    auto& relation = relations[size_t(source) * nb_types + size_t(target)];
+    std::call_once(relation.built_flag, [&]() {
+        const size_t nb_sources = data.get_nb_obj(source);
+        relation.offsets.reserve(nb_sources + 1);
+        relation.offsets.push_back(0);
+        for (idx_t idx = 0; idx < nb_sources; ++idx) {
+            const auto idx_targets = data.get_target_by_one_source(source, target, idx);
+            relation.targets.insert(relation.targets.end(), idx_targets.begin(), idx_targets.end());
+            relation.offsets.push_back(relation.targets.size());
+        }
+        relation.targets.shrink_to_fit();
+        relation.built = true;
+    });
+    return relation;
+}
+
+void RelationIndex::mark_targets(const type::Type_e source,
+                                 const type::Type_e target,
+                                 const type::Indexes& sources,
+                                 boost::dynamic_bitset<>& targets) const {
+    const auto& relation = get_relation(source, target);
+    const size_t nb_sources = relation.offsets.size() - 1;
+    for (const auto idx : sources) {
+        if (idx >= nb_sources) {
+            // unknown to the relation (like invalid_idx), let the data decide
+            for (const auto target_idx : data.get_target_by_one_source(source, target, idx)) {
+                mark(target_idx, targets);
+            }
+            continue;
+        }
+        for (auto i = relation.offsets[idx]; i < relation.offsets[idx + 1]; ++i) {
+            mark(relation.targets[i], targets);
+        }
+    }
+}
+
+size_t RelationIndex::nb_built_relations() const {
+    size_t res = 0;
+    for (const auto& relation : relations) {
+        res += relation.built ? 1 : 0;
+    }
+    return res;
+}
+
+}  // namespace ptref
+}  // namespace navitia
@@ -0,0 +1,82 @@
+/* Copyright © 2001-2019, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+channel `#navitia` on riot https://riot.im/app/#/room/#navitia:matrix.org
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+
+#include "type/data.h"
+#include "type/type_interfaces.h"
+
+#include <boost/dynamic_bitset.hpp>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace navitia {
+namespace ptref {
+
+/**
+ * Relations between the adjacent types of the ptref graph
+ *
+ * Each relation is stored as a compressed sparse row: the targets of the
+ * source idx are targets[offsets[idx]] to targets[offsets[idx + 1]], sorted.
+ * A relation is built from Data::get_target_by_one_source the first time it
+ * is needed, thus the Data must not be modified once the index is built.
+ */
+class RelationIndex {
+public:
+    explicit RelationIndex(const type::Data& data) : data(data) {}
+
+    // marks in targets the objects of type target related to the sources of type source,
+    // targets is enlarged if needed
+    void mark_targets(const type::Type_e source,
+                      const type::Type_e target,
+                      const type::Indexes& sources,
+                      boost::dynamic_bitset<>& targets) const;
+
+    size_t nb_built_relations() const;
+
+private:
+    struct Relation {
+        std::once_flag built_flag;
+        std::atomic<bool> built{false};
+        std::vector<uint32_t> offsets;
+        std::vector<idx_t> targets;
+    };
+
+    const Relation& get_relation(const type::Type_e source, const type::Type_e target) const;
+
+    const type::Data& data;
+    static constexpr size_t nb_types = size_t(type::Type_e::size);
+    mutable std::array<Relation, nb_types * nb_types> relations;
+};
+
+}  // namespace ptref
+}  // namespace navitia
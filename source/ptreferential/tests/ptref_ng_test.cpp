@@ -291,6 +291,42 @@ BOOST_AUTO_TEST_CASE(get_connection) {
     BOOST_REQUIRE_EQUAL(b.data->pt_data->lines.at(*indexes.begin())->uri, "B");
 }
 
+BOOST_AUTO_TEST_CASE(ptref_cache) {
+    ed::builder b("20180710");
+    b.vj("A")("stop0", 700)("stop1", 800)("stop2", 900);
+    b.vj("B")("stop2", 700)("stop3", 800)("stop4", 900);
+    b.make();
+    const auto rt_level = navitia::type::RTLevel::Base;
+    const std::string request = "get vehicle_journey <- stop_area.id=stop2";
+    const auto expected = make_query_ng(Type_e::StopArea, request, {}, OdtLevel_e::all, {}, {}, rt_level, *b.data);
+    const auto expected_lines = make_query_ng(Type_e::Line, request, {}, OdtLevel_e::all, {}, {}, rt_level, *b.data);
+
+    b.data->build_ptref_cache(10);
+    BOOST_REQUIRE(b.data->ptref_cache);
+    for (int i = 0; i < 3; ++i) {
+        auto indexes = make_query_ng(Type_e::StopArea, request, {}, OdtLevel_e::all, {}, {}, rt_level, *b.data);
+        BOOST_CHECK_EQUAL_RANGE(indexes, expected);
+    }
+    // the same filter on another type is another result, but the same expression
+    auto indexes = make_query_ng(Type_e::Line, request, {}, OdtLevel_e::all, {}, {}, rt_level, *b.data);
+    BOOST_CHECK_EQUAL_RANGE(indexes, expected_lines);
+
+    auto stats = b.data->ptref_cache->get_stats();
+    BOOST_CHECK_EQUAL(stats.nb_calls, 4);
+    BOOST_CHECK_EQUAL(stats.nb_cache_miss, 2);
+    BOOST_CHECK_EQUAL(stats.nb_parse_calls, 2);
+    BOOST_CHECK_EQUAL(stats.nb_parse_cache_miss, 1);
+
+    // a parsing error is raised for every request, even once in the cache
+    BOOST_CHECK_THROW(make_query_ng(Type_e::StopArea, "stop_area.id=", {}, OdtLevel_e::all, {}, {}, rt_level, *b.data),
+                      parsing_error);
+    BOOST_CHECK_THROW(make_query_ng(Type_e::StopArea, "stop_area.id=", {}, OdtLevel_e::all, {}, {}, rt_level, *b.data),
+                      parsing_error);
+
+    b.data->build_ptref_cache(0);
+    BOOST_CHECK(!b.data->ptref_cache);
+}
+
 BOOST_AUTO_TEST_CASE(get_disruption_by_tag) {
     ed::builder b("20180710");
 
@@ -34,6 +34,8 @@ www.navitia.io
 #include "ptreferential/ptreferential.h"
 #include "ptreferential/ptreferential_api.h"
 #include "ptreferential/ptref_graph.h"
+#include "ptreferential/ptreferential_utils.h"
+#include "ptreferential/relation_index.h"
 #include "ed/build_helper.h"
 
 #include <boost/graph/strong_components.hpp>
@@ -792,6 +794,44 @@ BOOST_AUTO_TEST_CASE(find_path_coord) {
     BOOST_CHECK_THROW(make_query(nt::Type_e::JourneyPatternPoint, "admin.uri=\"42\"", *(b.data)), ptref_error);
 }
 
+BOOST_AUTO_TEST_CASE(relation_index) {
+    ed::builder b("20180710");
+    b.vj_with_network("N1", "A")("stop0", 700)("stop1", 800)("stop2", 900);
+    b.vj_with_network("N1", "B")("stop2", 700)("stop3", 800);
+    b.vj_with_network("N2", "C")("stop3", 700)("stop4", 800)("stop5", 900);
+    b.make();
+
+    const std::vector<std::pair<Type_e, Type_e>> pairs = {
+        {Type_e::Network, Type_e::StopPoint},       {Type_e::StopArea, Type_e::Network},
+        {Type_e::VehicleJourney, Type_e::StopArea}, {Type_e::StopPoint, Type_e::VehicleJourney},
+        {Type_e::Line, Type_e::JourneyPattern},     {Type_e::POI, Type_e::VehicleJourney}};
+    std::vector<nt::Indexes> expected;
+    for (const auto& p : pairs) {
+        expected.push_back(get_corresponding(b.data->get_all_index(p.first), p.first, p.second, *b.data));
+    }
+    BOOST_CHECK_EQUAL_RANGE(expected[0], b.data->get_all_index(Type_e::StopPoint));
+    BOOST_CHECK(expected[5].empty());
+
+    b.data->build_ptref_cache(0);
+    BOOST_REQUIRE(b.data->relation_index);
+    BOOST_CHECK_EQUAL(b.data->relation_index->nb_built_relations(), 0);
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        const auto& p = pairs[i];
+        BOOST_CHECK_EQUAL_RANGE(get_corresponding(b.data->get_all_index(p.first), p.first, p.second, *b.data),
+                                expected[i]);
+    }
+    BOOST_CHECK_GT(b.data->relation_index->nb_built_relations(), 0);
+
+    // only the sources are followed
+    const auto network_idx = b.data->pt_data->networks_map.at("N2")->idx;
+    const auto sps = get_corresponding(nt::make_indexes({network_idx}), Type_e::Network, Type_e::StopPoint, *b.data);
+    std::set<std::string> sp_uris;
+    for (const auto idx : sps) {
+        sp_uris.insert(b.data->pt_data->stop_points[idx]->uri);
+    }
+    BOOST_CHECK_EQUAL_RANGE(sp_uris, std::set<std::string>({"stop3", "stop4", "stop5"}));
+}
+
 BOOST_AUTO_TEST_CASE(has_code_type_should_take_multiple_values) {
     ed::builder b("201601011T1739");
     b.sa("sa1")("stop1", {{"code_1", {"value 1", "value 2"}}});
@@ -30,6 +30,7 @@ www.navitia.io
 
 #include "raptor_api.h"
 #include "raptor.h"
+#include "thread_pool.h"
 #include "georef/street_network.h"
 #include "type/data.h"
 #include "utils/timer.h"
@@ -139,7 +140,7 @@ int main(int argc, char** argv) {
     navitia::init_app();
     po::options_description desc("Options de l'outil de benchmark");
     std::string file, output, stop_input_file, start, target;
-    int iterations, date, hour, nb_second_pass;
+    int iterations, date, hour, nb_second_pass, timeframe, profile_threads;
 
     auto logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("logger"));
     logger.setLogLevel(log4cplus::WARN_LOG_LEVEL);
@@ -160,7 +161,13 @@ int main(int argc, char** argv) {
             ("hour,h", po::value<int>(&hour)->default_value(-1),
                     "Beginning hour of a particular journey")
             ("verbose,v", "Verbose debugging output")
+            ("wheelchair", "Journeys for wheelchairs, the stop times of the vehicles not accessible are skipped")
             ("nb_second_pass", po::value<int>(&nb_second_pass)->default_value(0), "nb second pass")
+            ("timeframe", po::value<int>(&timeframe)->default_value(0),
+                    "Duration in seconds of the departure window of each journey (0 for a single departure)")
+            ("profile_threads", po::value<int>(&profile_threads)->default_value(1),
+                    "Number of threads computing the departure window as a profile query, "
+                    "compared to the sequential computation when greater than 1")
             ("stop_files", po::value<std::string>(&stop_input_file), "File with list of start and target")
             ("output,o", po::value<std::string>(&output)->default_value("benchmark.csv"),
                      "Output file");
@@ -170,6 +177,11 @@ int main(int argc, char** argv) {
     po::store(po::parse_command_line(argc, argv, desc), vm);
     po::notify(vm);
     bool verbose = vm.count("verbose");
+    type::AccessibiliteParams accessibilite_params;
+    if (vm.count("wheelchair")) {
+        accessibilite_params.properties.set(type::hasProperties::WHEELCHAIR_BOARDING, true);
+        accessibilite_params.vehicle_properties.set(type::hasVehicleProperties::WHEELCHAIR_ACCESSIBLE, true);
+    }
 
     if (vm.count("help")) {
         std::cout << "This is used to benchmark journey computation" << std::endl;
@@ -247,58 +259,72 @@ int main(int argc, char** argv) {
     RAPTOR router(data);
     auto georef_worker = georef::StreetNetwork(*data.geo_ref);
 
-    std::cout << "On lance le benchmark de l'algo " << std::endl;
-    boost::progress_display show_progress(demands.size());
-    Timer t("Calcul avec l'algorithme ");
-    // ProfilerStart("bench.prof");
-    int nb_reponses = 0, nb_journeys = 0;
+    const auto timeframe_duration = timeframe > 0 ? boost::make_optional<uint32_t>(timeframe) : boost::none;
+
+    auto run_benchmark = [&](const uint32_t nb_profile_threads) {
+        std::cout << "On lance le benchmark de l'algo avec " << nb_profile_threads << " thread(s)" << std::endl;
+        ThreadPool profile_pool(nb_profile_threads - 1);
+        boost::progress_display show_progress(demands.size());
+        Timer t("Calcul avec l'algorithme ");
+        // ProfilerStart("bench.prof");
+        int nb_reponses = 0, nb_journeys = 0;
 #ifdef __BENCH_WITH_CALGRIND__
-    CALLGRIND_START_INSTRUMENTATION;
+        CALLGRIND_START_INSTRUMENTATION;
 #endif
-    for (auto demand : demands) {
-        ++show_progress;
-        Timer t2;
-        auto date = data.pt_data->validity_patterns.front()->beginning_date + boost::gregorian::days(demand.date + 1)
-                    - boost::gregorian::date(1970, 1, 1);
-        if (verbose) {
-            std::cout << demand.start << ", " << demand.start << ", " << demand.target << ", "
-                      << static_cast<int>(demand.start_mode) << ", " << static_cast<int>(demand.target_mode) << ", "
-                      << date << ", " << demand.hour << "\n";
-        }
+        for (auto demand : demands) {
+            ++show_progress;
+            Timer t2;
+            auto date = data.pt_data->validity_patterns.front()->beginning_date
+                        + boost::gregorian::days(demand.date + 1) - boost::gregorian::date(1970, 1, 1);
+            if (verbose) {
+                std::cout << demand.start << ", " << demand.start << ", " << demand.target << ", "
+                          << static_cast<int>(demand.start_mode) << ", " << static_cast<int>(demand.target_mode)
+                          << ", " << date << ", " << demand.hour << "\n";
+            }
 
-        type::EntryPoint origin = make_entry_point(demand.start, data);
-        type::EntryPoint destination = make_entry_point(demand.target, data);
-
-        origin.streetnetwork_params.mode = demand.start_mode;
-        origin.streetnetwork_params.offset = data.geo_ref->offsets[demand.start_mode];
-        origin.streetnetwork_params.max_duration = navitia::seconds(30 * 60);
-        origin.streetnetwork_params.speed_factor = 1;
-        destination.streetnetwork_params.mode = demand.target_mode;
-        destination.streetnetwork_params.offset = data.geo_ref->offsets[demand.target_mode];
-        destination.streetnetwork_params.max_duration = navitia::seconds(30 * 60);
-        destination.streetnetwork_params.speed_factor = 1;
-        type::AccessibiliteParams accessibilite_params;
-        const auto departure_datetime = DateTimeUtils::set(date.days(), demand.hour);
-        navitia::PbCreator pb_creator(&data, boost::gregorian::not_a_date_time, null_time_period);
-        make_response(pb_creator, router, origin, destination, {departure_datetime}, true, accessibilite_params, {}, {},
-                      georef_worker, type::RTLevel::Base, 2_min, DateTimeUtils::SECONDS_PER_DAY, 10, nb_second_pass);
-        auto resp = pb_creator.get_response();
-
-        if (resp.journeys_size() > 0) {
-            ++nb_reponses;
-            nb_journeys += resp.journeys_size();
-
-            Result result(resp.journeys(0));
-            result.time = t2.ms();
-            results.push_back(result);
+            type::EntryPoint origin = make_entry_point(demand.start, data);
+            type::EntryPoint destination = make_entry_point(demand.target, data);
+
+            origin.streetnetwork_params.mode = demand.start_mode;
+            origin.streetnetwork_params.offset = data.geo_ref->offsets[demand.start_mode];
+            origin.streetnetwork_params.max_duration = navitia::seconds(30 * 60);
+            origin.streetnetwork_params.speed_factor = 1;
+            destination.streetnetwork_params.mode = demand.target_mode;
+            destination.streetnetwork_params.offset = data.geo_ref->offsets[demand.target_mode];
+            destination.streetnetwork_params.max_duration = navitia::seconds(30 * 60);
+            destination.streetnetwork_params.speed_factor = 1;
+            const auto departure_datetime = DateTimeUtils::set(date.days(), demand.hour);
+            navitia::PbCreator pb_creator(&data, boost::gregorian::not_a_date_time, null_time_period);
+            make_response(pb_creator, router, origin, destination, {departure_datetime}, true, accessibilite_params,
+                          {}, {}, georef_worker, type::RTLevel::Base, 2_min, DateTimeUtils::SECONDS_PER_DAY, 10,
+                          nb_second_pass, 0, 0, boost::none, NightBusFilter::default_max_factor,
+                          NightBusFilter::default_base_factor, timeframe_duration, 1, &profile_pool);
+            auto resp = pb_creator.get_response();
+
+            if (resp.journeys_size() > 0) {
+                ++nb_reponses;
+                nb_journeys += resp.journeys_size();
+
+                Result result(resp.journeys(0));
+                result.time = t2.ms();
+                results.push_back(result);
+            }
         }
-    }
-    // ProfilerStop();
+        // ProfilerStop();
 #ifdef __BENCH_WITH_CALGRIND__
-    CALLGRIND_STOP_INSTRUMENTATION;
+        CALLGRIND_STOP_INSTRUMENTATION;
 #endif
 
-    std::cout << "Number of requests: " << demands.size() << std::endl;
-    std::cout << "Number of results with solution: " << nb_reponses << std::endl;
-    std::cout << "Number of journey found: " << nb_journeys << std::endl;
+        std::cout << "Number of requests: " << demands.size() << std::endl;
+        std::cout << "Number of results with solution: " << nb_reponses << std::endl;
+        std::cout << "Number of journey found: " << nb_journeys << std::endl;
+        return t.ms();
+    };
+
+    const auto sequential_ms = run_benchmark(1);
+    if (profile_threads > 1) {
+        const auto profile_ms = run_benchmark(profile_threads);
+        std::cout << "Profile query on " << profile_threads << " threads: " << profile_ms << "ms against "
+                  << sequential_ms << "ms sequentially" << std::endl;
+    }
 }
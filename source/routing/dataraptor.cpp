@@ -85,7 +85,108 @@ void dataRAPTOR::JppsFromJp::load(const JourneyPatternContainer& jp_container) {
     }
 }
 
-void dataRAPTOR::load(const type::PT_Data& data, size_t cache_size) {
+void dataRAPTOR::StopTimeTable::load(const type::PT_Data& data, const JourneyPatternContainer& jp_container) {
+    boarding_times.clear();
+    alighting_times.clear();
+    local_traffic_zones.clear();
+    flags.clear();
+    first_st_pos.assign(data.vehicle_journeys);
+
+    const size_t nb_st = data.nb_stop_times();
+    boarding_times.reserve(nb_st);
+    alighting_times.reserve(nb_st);
+    local_traffic_zones.reserve(nb_st);
+    flags.reserve(nb_st);
+
+    for (const auto jp : jp_container.get_jps()) {
+        jp.second.for_each_vehicle_journey([&](const nt::VehicleJourney& vj) {
+            first_st_pos[VjIdx(vj)] = boarding_times.size();
+            for (const auto& st : vj.stop_time_list) {
+                boarding_times.push_back(st.boarding_time);
+                alighting_times.push_back(st.alighting_time);
+                local_traffic_zones.push_back(st.local_traffic_zone);
+                flags.push_back((st.pick_up_allowed() ? PICK_UP : 0) | (st.drop_off_allowed() ? DROP_OFF : 0));
+            }
+            return true;
+        });
+    }
+}
+
+static bool same_stop_times(const type::VehicleJourney& vj, const type::VehicleJourney& prev) {
+    if (vj.idx != prev.idx || vj.stop_time_list.size() != prev.stop_time_list.size()) {
+        return false;
+    }
+    for (auto it = vj.stop_time_list.begin(), prev_it = prev.stop_time_list.begin(); it != vj.stop_time_list.end();
+         ++it, ++prev_it) {
+        if (it->boarding_time != prev_it->boarding_time || it->alighting_time != prev_it->alighting_time
+            || it->properties != prev_it->properties || it->local_traffic_zone != prev_it->local_traffic_zone
+            || it->stop_point->idx != prev_it->stop_point->idx) {
+            return false;
+        }
+    }
+    for (const auto level : {type::RTLevel::Base, type::RTLevel::Adapted, type::RTLevel::RealTime}) {
+        const auto* vp = vj.validity_patterns[level];
+        const auto* prev_vp = prev.validity_patterns[level];
+        if ((vp == nullptr) != (prev_vp == nullptr)) {
+            return false;
+        }
+        if (vp != nullptr && vp->days != prev_vp->days) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool same_vj(const type::DiscreteVehicleJourney& vj, const type::DiscreteVehicleJourney& prev) {
+    return same_stop_times(vj, prev);
+}
+
+static bool same_vj(const type::FrequencyVehicleJourney& vj, const type::FrequencyVehicleJourney& prev) {
+    return vj.start_time == prev.start_time && vj.end_time == prev.end_time && vj.headway_secs == prev.headway_secs
+           && same_stop_times(vj, prev);
+}
+
+template <typename VJ>
+static bool same_vjs(const std::vector<const VJ*>& vjs, const std::vector<const VJ*>& prev_vjs) {
+    return vjs.size() == prev_vjs.size()
+           && std::equal(vjs.begin(), vjs.end(), prev_vjs.begin(),
+                         [](const VJ* vj, const VJ* prev) { return same_vj(*vj, *prev); });
+}
+
+// For each journey pattern, the journey pattern of prev_container
+// having exactly the same vehicle journeys (same idx, same stop
+// times, same validity patterns), if any.
+static IdxMap<JourneyPattern, boost::optional<JpIdx>> find_unchanged_jps(
+    const JourneyPatternContainer& jp_container,
+    const JourneyPatternContainer& prev_container) {
+    IdxMap<JourneyPattern, boost::optional<JpIdx>> res;
+    res.assign(jp_container.get_jps_values());
+    const auto& prev_jp_from_vj = prev_container.get_jp_from_vj();
+    for (const auto jp : jp_container.get_jps()) {
+        const type::VehicleJourney* first_vj = nullptr;
+        if (!jp.second.discrete_vjs.empty()) {
+            first_vj = jp.second.discrete_vjs.front();
+        } else if (!jp.second.freq_vjs.empty()) {
+            first_vj = jp.second.freq_vjs.front();
+        }
+        if (first_vj == nullptr || first_vj->idx >= prev_jp_from_vj.size()) {
+            continue;
+        }
+        const auto prev_jp_idx = prev_jp_from_vj[VjIdx(*first_vj)];
+        if (prev_jp_idx.val >= prev_container.nb_jps()) {
+            continue;
+        }
+        const auto& prev_jp = prev_container.get(prev_jp_idx);
+        if (jp.second.jpps.size() != prev_jp.jpps.size() || !same_vjs(jp.second.discrete_vjs, prev_jp.discrete_vjs)
+            || !same_vjs(jp.second.freq_vjs, prev_jp.freq_vjs)) {
+            continue;
+        }
+        res[jp.first] = prev_jp_idx;
+    }
+    return res;
+}
+
+void dataRAPTOR::load(const type::PT_Data& data, size_t cache_size, const dataRAPTOR* previous) {
     jp_container.load(data);
     labels_const.init_inf(data.stop_points);
     labels_const_reverse.init_min(data.stop_points);
@@ -93,13 +194,48 @@ void dataRAPTOR::load(const type::PT_Data& data, size_t cache_size) {
     connections.load(data);
     jpps_from_sp.load(data, jp_container);
     jpps_from_jp.load(jp_container);
-    next_stop_time_data.load(jp_container);
+    st_table.load(data, jp_container);
+
+    IdxMap<JourneyPattern, boost::optional<JpIdx>> previous_jps;
+    previous_jps.assign(jp_container.get_jps_values());
+    if (previous) {
+        previous_jps = find_unchanged_jps(jp_container, previous->jp_container);
+        IdxMap<JourneyPatternPoint, boost::optional<JppIdx>> previous_jpps;
+        previous_jpps.assign(jp_container.get_jpps_values());
+        for (const auto jp : previous_jps) {
+            if (!jp.second) {
+                continue;
+            }
+            const auto& jpps = jp_container.get(jp.first).jpps;
+            const auto& prev_jpps = previous->jp_container.get(*jp.second).jpps;
+            for (size_t i = 0; i < jpps.size(); ++i) {
+                previous_jpps[jpps[i]] = prev_jpps[i];
+            }
+        }
+        next_stop_time_data.load(jp_container, data, previous->next_stop_time_data, previous_jpps);
+    } else {
+        next_stop_time_data.load(jp_container);
+    }
+
+    nb_rebuilt_jps = 0;
+    for (const auto jp : previous_jps) {
+        if (!jp.second) {
+            ++nb_rebuilt_jps;
+        }
+    }
 
     for (auto level_cont : jp_validity_patterns) {
         const auto rt_level = level_cont.first;
         auto& jp_vp = level_cont.second;
         jp_vp.assign(366, boost::dynamic_bitset<>(jp_container.nb_jps()));
         for (const auto jp : jp_container.get_jps()) {
+            if (const auto& prev_jp_idx = previous_jps[jp.first]) {
+                const auto& prev_jp_vp = previous->jp_validity_patterns[rt_level];
+                for (int i = 0; i <= 365; ++i) {
+                    jp_vp[i][jp.first.val] = prev_jp_vp[i][prev_jp_idx->val];
+                }
+                continue;
+            }
             for (int i = 0; i <= 365; ++i) {
                 jp.second.for_each_vehicle_journey([&](const nt::VehicleJourney& vj) {
                     if (vj.validity_patterns[rt_level]->check2(i)) {
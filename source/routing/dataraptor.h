@@ -96,6 +96,40 @@ struct dataRAPTOR {
     };
     JppsFromJp jpps_from_jp;
 
+    // Structure of arrays of the stop times, read by the route scan of
+    // raptor instead of the StopTime themselves (that are only needed
+    // to read the solutions). The stop times of the vehicle journeys of
+    // a journey pattern are contiguous (a vj x stop matrix), the stop
+    // time of order i of a vj being at first_st_pos[vj] + i.
+    struct StopTimeTable {
+        enum Flags : uint8_t { PICK_UP = 1, DROP_OFF = 2 };
+
+        void load(const type::PT_Data&, const JourneyPatternContainer&);
+
+        inline uint32_t pos(const type::StopTime& st) const {
+            return first_st_pos[VjIdx(*st.vehicle_journey)] + st.order().val;
+        }
+        // same as StopTime::section_end
+        inline DateTime section_end(const uint32_t pos, const DateTime base_dt, const bool clockwise) const {
+            return base_dt + (clockwise ? alighting_times[pos] : boarding_times[pos]);
+        }
+        // same as StopTime::base_dt
+        inline DateTime base_dt(const uint32_t pos, const DateTime dt, const bool clockwise) const {
+            return dt - (clockwise ? boarding_times[pos] : alighting_times[pos]);
+        }
+        // same as StopTime::valid_end
+        inline bool valid_end(const uint32_t pos, const bool clockwise) const {
+            return flags[pos] & (clockwise ? DROP_OFF : PICK_UP);
+        }
+
+        std::vector<uint32_t> boarding_times;
+        std::vector<uint32_t> alighting_times;
+        std::vector<uint16_t> local_traffic_zones;
+        std::vector<uint8_t> flags;
+        IdxMap<type::VehicleJourney, uint32_t> first_st_pos;
+    };
+    StopTimeTable st_table;
+
     NextStopTimeData next_stop_time_data;
     std::unique_ptr<CachedNextStopTimeManager> cached_next_st_manager;
 
@@ -108,8 +142,20 @@ struct dataRAPTOR {
     // jp_validity_patterns[date][jp_idx] == any(vj.validity_pattern->check2(date) for vj in jp)
     flat_enum_map<type::RTLevel, std::vector<boost::dynamic_bitset<>>> jp_validity_patterns;
 
+    // number of journey patterns computed from scratch during the last load
+    size_t nb_rebuilt_jps = 0;
+
     dataRAPTOR() {}
-    void load(const navitia::type::PT_Data&, size_t cache_size = 10);
+    /** Build the raptor data from the given PT_Data.
+     *
+     * If previous is given (typically the dataRAPTOR of the Data we
+     * have been cloned from when applying realtime), the journey
+     * patterns whose vehicle journeys are unchanged reuse the sorted
+     * stop times and the validity patterns computed by previous, only
+     * the impacted journey patterns are computed from scratch.
+     * previous' PT_Data must still be alive during the load.
+     */
+    void load(const navitia::type::PT_Data&, size_t cache_size = 10, const dataRAPTOR* previous = nullptr);
 
     void warmup(const dataRAPTOR& other);
 };
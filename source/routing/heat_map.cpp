@@ -34,6 +34,8 @@ www.navitia.io
 #include "isochrone.h"
 #include "raptor_api.h"
 
+#include <atomic>
+#include <future>
 #include <vector>
 
 namespace navitia {
@@ -96,10 +98,8 @@ static std::pair<int, int> find_rank(const BoundBox& box,
 
 struct Projection {
     boost::optional<double> distance;
-    georef::vertex_t source;
-    georef::vertex_t target;
-    Projection(double distance, georef::vertex_t source, georef::vertex_t target)
-        : distance(distance), source(source), target(target) {}
+    size_t edge;  // in the edges of the heat map
+    Projection(double distance, size_t edge) : distance(distance), edge(edge) {}
 
     Projection() : distance(boost::none) {}
 };
@@ -131,59 +131,103 @@ static Boundary find_boundary(const std::pair<int, int>& rank_source,
     return Boundary(end_lon_box, end_lat_box, begin_lon_box, begin_lat_box);
 }
 
-static std::vector<std::vector<Projection>> find_projection(BoundBox box,
-                                                            const double height_step,
-                                                            const double width_step,
-                                                            const georef::GeoRef& worker,
-                                                            const double min_dist,
-                                                            const HeatMap& heat_map,
-                                                            const size_t step) {
-    std::vector<std::vector<Projection>> dist_pixel = {step, {step, Projection()}};
-    const size_t offset_lon = floor(min_dist / (width_step * N_DEG_TO_DISTANCE)) + 1;
-    const size_t offset_lat = floor(min_dist / (height_step * N_DEG_TO_DISTANCE)) + 1;
-
-    auto box_center = type::GeographicalCoord{(box.min.lon() + box.max.lon()) / 2, (box.min.lat() + box.max.lat()) / 2};
-
-    auto radius = box.min.distance_to(box.max);
+// the cell centers and the cosinus of their latitude, computed once by grid
+struct CellCenters {
+    std::vector<double> lon;
+    std::vector<double> lat;
+    std::vector<double> coslat;
+    CellCenters(const HeatMap& heat_map, const double height_step, const double width_step) {
+        for (const auto& line : heat_map.body) {
+            lon.push_back(line.first.min_coord + width_step / 2);
+        }
+        for (const auto& header : heat_map.header) {
+            lat.push_back(header.min_coord + height_step / 2);
+            coslat.push_back(cos(lat.back() * type::GeographicalCoord::N_DEG_TO_RAD));
+        }
+    }
+};
 
-    auto objects_inside = worker.pl_walking.find_within(box_center, radius);
+// an edge and the lat ranks of the cells of a lon rank it can be the nearest edge of
+struct EdgeCells {
+    size_t edge;
+    size_t min_lat;
+    size_t max_lat;
+};
 
-    if (objects_inside.empty()) {
-        return {};
+/*
+ * The edges by lon rank of the cells they can be the nearest edge of, i.e. whose
+ * distance to the edge may be below min_dist. Computed once by grid, in the order of the edges
+ */
+static std::vector<std::vector<EdgeCells>> bucket_edges(const BoundBox& box,
+                                                        const double height_step,
+                                                        const double width_step,
+                                                        const georef::GeoRef& worker,
+                                                        const double min_dist,
+                                                        const std::vector<HeatMapEdge>& edges,
+                                                        const size_t step) {
+    std::vector<std::vector<EdgeCells>> edges_by_lon(step);
+    const size_t offset_lon = floor(min_dist / (width_step * N_DEG_TO_DISTANCE)) + 1;
+    const size_t offset_lat = floor(min_dist / (height_step * N_DEG_TO_DISTANCE)) + 1;
+    for (size_t i = 0; i < edges.size(); ++i) {
+        const auto rank_source = find_rank(box, worker.graph[edges[i].source].coord, height_step, width_step);
+        const auto rank_target = find_rank(box, worker.graph[edges[i].target].coord, height_step, width_step);
+        const auto boundary = find_boundary(rank_source, rank_target, offset_lon, offset_lat, step);
+        for (size_t lon_rank = boundary.min_lon; lon_rank <= boundary.max_lon; lon_rank++) {
+            edges_by_lon[lon_rank].push_back({i, boundary.min_lat, boundary.max_lat});
+        }
     }
+    return edges_by_lon;
+}
 
-    const auto coslat = cos(objects_inside.front().second.lat() * type::GeographicalCoord::N_DEG_TO_RAD);
-    for (const auto& o : objects_inside) {
-        const auto element = o.first;
-        const auto& source = o.second;
+/*
+ * The nearest edge of the cells whose lon rank is in [lon_begin, lon_end),
+ * the i-th line of the result being the one of lon_begin + i
+ */
+static std::vector<std::vector<Projection>> find_projection(const georef::GeoRef& worker,
+                                                            const double min_dist,
+                                                            const CellCenters& centers,
+                                                            const std::vector<HeatMapEdge>& edges,
+                                                            const std::vector<std::vector<EdgeCells>>& edges_by_lon,
+                                                            const size_t step,
+                                                            const size_t lon_begin,
+                                                            const size_t lon_end) {
+    std::vector<std::vector<Projection>> dist_pixel = {lon_end - lon_begin, {step, Projection()}};
+    const auto coslat = cos(worker.graph[edges.front().source].coord.lat() * type::GeographicalCoord::N_DEG_TO_RAD);
+    for (size_t lon_rank = lon_begin; lon_rank < lon_end; lon_rank++) {
+        auto& pixels = dist_pixel[lon_rank - lon_begin];
+        for (const auto& edge_cells : edges_by_lon[lon_rank]) {
+            const auto& source = worker.graph[edges[edge_cells.edge].source].coord;
+            const auto& target = worker.graph[edges[edge_cells.edge].target].coord;
+            for (size_t lat_rank = edge_cells.min_lat; lat_rank <= edge_cells.max_lat; lat_rank++) {
+                auto center = type::GeographicalCoord(centers.lon[lon_rank], centers.lat[lat_rank]);
+                auto proj = center.approx_project(source, target, coslat);
+                auto length = double(proj.second);
+                if (length < min_dist && (!pixels[lat_rank].distance || length < *pixels[lat_rank].distance)) {
+                    pixels[lat_rank].distance = length;
+                    pixels[lat_rank].edge = edge_cells.edge;
+                }
+            }
+        }
+    }
+    return dist_pixel;
+}
 
-        if (!box.contains(source)) {
+std::vector<HeatMapEdge> find_edges_in_box(const georef::GeoRef& worker,
+                                           const BoundBox& box,
+                                           const std::vector<navitia::time_duration>& distances) {
+    std::vector<HeatMapEdge> edges;
+    auto box_center = type::GeographicalCoord{(box.min.lon() + box.max.lon()) / 2, (box.min.lat() + box.max.lat()) / 2};
+    auto radius = box.min.distance_to(box.max);
+    for (const auto& o : worker.pl_walking.find_within(box_center, radius)) {
+        if (!box.contains(o.second)) {
             continue;
         }
-        const auto rank_source = find_rank(box, source, height_step, width_step);
-        BOOST_FOREACH (const georef::edge_t& e, boost::out_edges(element, worker.graph)) {
+        BOOST_FOREACH (const georef::edge_t& e, boost::out_edges(o.first, worker.graph)) {
             const auto v = target(e, worker.graph);
-            const auto& target = worker.graph[v].coord;
-            const auto rank_target = find_rank(box, target, height_step, width_step);
-            const auto boundary = find_boundary(rank_source, rank_target, offset_lon, offset_lat, step);
-            for (uint lon_rank = boundary.min_lon; lon_rank <= boundary.max_lon; lon_rank++) {
-                for (uint lat_rank = boundary.min_lat; lat_rank <= boundary.max_lat; lat_rank++) {
-                    auto center = type::GeographicalCoord(heat_map.body[lon_rank].first.min_coord + width_step / 2,
-                                                          heat_map.header[lat_rank].min_coord + height_step / 2);
-                    auto proj = center.approx_project(source, target, coslat);
-                    auto length = double(proj.second);
-                    if (length < min_dist
-                        && (!dist_pixel[lon_rank][lat_rank].distance
-                            || length < *dist_pixel[lon_rank][lat_rank].distance)) {
-                        dist_pixel[lon_rank][lat_rank].distance = length;
-                        dist_pixel[lon_rank][lat_rank].source = element;
-                        dist_pixel[lon_rank][lat_rank].target = v;
-                    }
-                }
-            }
+            edges.push_back({o.first, v, distances[o.first], distances[v]});
         }
     }
-    return dist_pixel;
+    return edges;
 }
 
 HeatMap fill_heat_map(const BoundBox& box,
@@ -194,51 +238,260 @@ HeatMap fill_heat_map(const BoundBox& box,
                       const double max_duration,
                       const double speed,
                       const std::vector<navitia::time_duration>& distances,
-                      const size_t step) {
+                      const size_t step,
+                      const size_t nb_threads,
+                      const navitia::Deadline* deadline) {
+    return fill_heat_map(box, height_step, width_step, worker, min_dist, max_duration, speed,
+                         find_edges_in_box(worker, box, distances), step, nb_threads, deadline);
+}
+
+HeatMap fill_heat_map(const BoundBox& box,
+                      const double height_step,
+                      const double width_step,
+                      const georef::GeoRef& worker,
+                      const double min_dist,
+                      const double max_duration,
+                      const double speed,
+                      const std::vector<HeatMapEdge>& edges,
+                      const size_t step,
+                      const size_t nb_threads,
+                      const navitia::Deadline* deadline) {
     auto heat_map = HeatMap(step, box, height_step, width_step);
-    auto projection = find_projection(box, height_step, width_step, worker, min_dist, heat_map, step);
-    for (size_t i = 0; i < step; i++) {
-        for (size_t j = 0; j < step; j++) {
-            auto& duration = heat_map.body[i].second[j];
-            if (projection[i][j].distance) {
-                auto center = type::GeographicalCoord(heat_map.body[i].first.min_coord + width_step / 2,
-                                                      heat_map.header[j].min_coord + height_step / 2);
-                const auto source = worker.graph[projection[i][j].source].coord;
-                const auto target = worker.graph[projection[i][j].target].coord;
-                const auto coslat = cos(center.lat() * type::GeographicalCoord::N_DEG_TO_RAD);
+    const CellCenters centers(heat_map, height_step, width_step);
+    if (edges.empty()) {
+        return heat_map;
+    }
+    const auto edges_by_lon = bucket_edges(box, height_step, width_step, worker, min_dist, edges, step);
+
+    // the cells of a tile of lon ranks only depend on the tile, the tiles are thus filled in parallel
+    auto fill_tile = [&](const size_t lon_begin, const size_t lon_end) {
+        const auto projection =
+            find_projection(worker, min_dist, centers, edges, edges_by_lon, step, lon_begin, lon_end);
+        for (size_t i = lon_begin; i < lon_end; i++) {
+            for (size_t j = 0; j < step; j++) {
+                auto& duration = heat_map.body[i].second[j];
+                const auto& pixel = projection[i - lon_begin][j];
+                if (!pixel.distance) {
+                    continue;
+                }
+                const auto center = type::GeographicalCoord(centers.lon[i], centers.lat[j]);
+                const auto& edge = edges[pixel.edge];
+                const auto& source = worker.graph[edge.source].coord;
+                const auto& target = worker.graph[edge.target].coord;
                 const auto duration_to_source =
-                    distances[projection[i][j].source]
-                    + navitia::milliseconds(sqrt(center.approx_sqr_distance(source, coslat)) / speed * 1e3);
+                    edge.source_duration
+                    + navitia::milliseconds(sqrt(center.approx_sqr_distance(source, centers.coslat[j])) / speed * 1e3);
                 const auto duration_to_target =
-                    distances[projection[i][j].target]
-                    + navitia::milliseconds(sqrt(center.approx_sqr_distance(target, coslat)) / speed * 1e3);
+                    edge.target_duration
+                    + navitia::milliseconds(sqrt(center.approx_sqr_distance(target, centers.coslat[j])) / speed * 1e3);
                 const auto new_duration = std::min(duration_to_source, duration_to_target);
                 if (new_duration.total_seconds() < max_duration) {
                     duration = new_duration;
-                } else {
-                    duration = bt::pos_infin;
                 }
-            } else {
-                duration = bt::pos_infin;
             }
         }
+    };
+
+    // several tiles by thread to balance the empty and the dense parts of the box
+    const size_t nb_tiles = nb_threads > 1 ? std::min(step, 4 * nb_threads) : 1;
+    const size_t tile_size = (step + nb_tiles - 1) / nb_tiles;
+    std::atomic<size_t> next_tile{0};
+    auto fill_tiles = [&]() {
+        for (size_t tile = next_tile++; tile * tile_size < step; tile = next_tile++) {
+            if (deadline != nullptr) {
+                deadline->check();
+            }
+            fill_tile(tile * tile_size, std::min(step, (tile + 1) * tile_size));
+        }
+    };
+    std::vector<std::future<void>> futures;
+    for (size_t i = 1; i < std::min(nb_threads, nb_tiles); ++i) {
+        futures.push_back(std::async(std::launch::async, fill_tiles));
+    }
+    fill_tiles();
+    for (auto& future : futures) {
+        future.get();
     }
     return heat_map;
 }
 
-static std::string build_grid(const georef::GeoRef& worker,
-                              const BoundBox& box,
-                              const std::vector<navitia::time_duration>& distances,
-                              const double speed,
-                              const double max_duration,
-                              const uint resolution) {
+static HeatMap make_grid(const georef::GeoRef& worker,
+                         const HeatMapDistances& heat_map_distances,
+                         const double speed,
+                         const double max_duration,
+                         const uint resolution,
+                         const size_t nb_threads,
+                         const navitia::Deadline* deadline) {
+    const auto& box = heat_map_distances.box;
     double width_step = (box.max.lon() - box.min.lon()) / resolution;
     double height_step = (box.max.lat() - box.min.lat()) / resolution;
     auto min_dist = std::max(500., width_step * N_DEG_TO_DISTANCE);
     min_dist = std::max(min_dist, height_step * N_DEG_TO_DISTANCE);
-    auto heat_map =
-        fill_heat_map(box, height_step, width_step, worker, min_dist, max_duration, speed, distances, resolution);
-    return print_grid(heat_map);
+    return fill_heat_map(box, height_step, width_step, worker, min_dist, max_duration, speed,
+                         heat_map_distances.edges, resolution, nb_threads, deadline);
+}
+
+std::string build_grid(const georef::GeoRef& worker,
+                       const HeatMapDistances& heat_map_distances,
+                       const double speed,
+                       const double max_duration,
+                       const uint resolution,
+                       const size_t nb_threads,
+                       const navitia::Deadline* deadline) {
+    return print_grid(make_grid(worker, heat_map_distances, speed, max_duration, resolution, nb_threads, deadline));
+}
+
+type::MultiPolygon trace_cells(const HeatMap& heat_map, const DateTime min_duration, const DateTime max_duration) {
+    const int nb_lon = heat_map.body.size();
+    const int nb_lat = heat_map.header.size();
+    type::MultiPolygon res;
+    if (nb_lon == 0 || nb_lat == 0) {
+        return res;
+    }
+    auto is_in = [&](const int i, const int j) {
+        if (i < 0 || j < 0 || i >= nb_lon || j >= nb_lat) {
+            return false;
+        }
+        const auto& duration = heat_map.body[i].second[j];
+        return !duration.is_pos_infinity() && duration.total_seconds() >= int64_t(min_duration)
+               && duration.total_seconds() < int64_t(max_duration);
+    };
+
+    // 4-connected components of the cells
+    std::vector<int> components(nb_lon * nb_lat, -1);
+    int nb_components = 0;
+    for (int i = 0; i < nb_lon; ++i) {
+        for (int j = 0; j < nb_lat; ++j) {
+            if (!is_in(i, j) || components[i * nb_lat + j] != -1) {
+                continue;
+            }
+            std::vector<std::pair<int, int>> stack = {{i, j}};
+            components[i * nb_lat + j] = nb_components;
+            while (!stack.empty()) {
+                const auto cell = stack.back();
+                stack.pop_back();
+                for (const auto& n : {std::make_pair(cell.first - 1, cell.second),
+                                      std::make_pair(cell.first + 1, cell.second),
+                                      std::make_pair(cell.first, cell.second - 1),
+                                      std::make_pair(cell.first, cell.second + 1)}) {
+                    if (is_in(n.first, n.second) && components[n.first * nb_lat + n.second] == -1) {
+                        components[n.first * nb_lat + n.second] = nb_components;
+                        stack.push_back(n);
+                    }
+                }
+            }
+            ++nb_components;
+        }
+    }
+
+    // borders of the cells, oriented with the cell on their left, as a bitset of directions by corner
+    const int dx[] = {1, 0, -1, 0};
+    const int dy[] = {0, 1, 0, -1};
+    auto corner = [&](const int x, const int y) { return x * (nb_lat + 1) + y; };
+    std::vector<uint8_t> borders((nb_lon + 1) * (nb_lat + 1), 0);
+    for (int i = 0; i < nb_lon; ++i) {
+        for (int j = 0; j < nb_lat; ++j) {
+            if (!is_in(i, j)) {
+                continue;
+            }
+            borders[corner(i, j)] |= is_in(i, j - 1) ? 0 : 1 << 0;
+            borders[corner(i + 1, j)] |= is_in(i + 1, j) ? 0 : 1 << 1;
+            borders[corner(i + 1, j + 1)] |= is_in(i, j + 1) ? 0 : 1 << 2;
+            borders[corner(i, j + 1)] |= is_in(i - 1, j) ? 0 : 1 << 3;
+        }
+    }
+
+    // the borders are followed into rings, turning left when two cells only share a corner so that
+    // a ring goes around a single component. The outer rings are counterclockwise, the holes clockwise
+    const auto& lon = heat_map.body.front().first;
+    const auto& lat = heat_map.header.front();
+    std::vector<type::Polygon> polygons(nb_components);
+    auto remaining = borders;
+    for (int x0 = 0; x0 <= nb_lon; ++x0) {
+        for (int y0 = 0; y0 <= nb_lat; ++y0) {
+            while (remaining[corner(x0, y0)]) {
+                int d0 = 0;
+                while (!(remaining[corner(x0, y0)] & (1 << d0))) {
+                    ++d0;
+                }
+                std::vector<std::pair<int, int>> ring;
+                int x = x0, y = y0, d = d0, previous_d = -1;
+                long long area = 0;
+                while (true) {
+                    remaining[corner(x, y)] &= ~(1 << d);
+                    if (d != previous_d) {
+                        ring.emplace_back(x, y);
+                    }
+                    area += x * dy[d] - y * dx[d];
+                    previous_d = d;
+                    x += dx[d];
+                    y += dy[d];
+                    for (const int turn : {1, 0, 3}) {
+                        if (borders[corner(x, y)] & (1 << ((d + turn) % 4))) {
+                            d = (d + turn) % 4;
+                            break;
+                        }
+                    }
+                    if (x == x0 && y == y0 && d == d0) {
+                        break;
+                    }
+                }
+                if (previous_d == d0) {
+                    // the starting corner is in the middle of a side
+                    ring.erase(ring.begin());
+                }
+
+                // the cell on the left of the first border
+                const int cell_x = d0 == 0 || d0 == 3 ? x0 : x0 - 1;
+                const int cell_y = d0 == 0 || d0 == 1 ? y0 : y0 - 1;
+                auto& polygon = polygons[components[cell_x * nb_lat + cell_y]];
+                type::Polygon::ring_type* geo_ring = nullptr;
+                if (area > 0) {
+                    geo_ring = &polygon.outer();
+                } else {
+                    polygon.inners().emplace_back();
+                    geo_ring = &polygon.inners().back();
+                }
+                for (const auto& point : ring) {
+                    geo_ring->emplace_back(lon.min_coord + point.first * lon.step,
+                                           lat.min_coord + point.second * lat.step);
+                }
+            }
+        }
+    }
+    for (auto& polygon : polygons) {
+        boost::geometry::correct(polygon);
+        res.push_back(std::move(polygon));
+    }
+    return res;
+}
+
+std::vector<Isochrone> build_street_network_isochrones(const georef::GeoRef& worker,
+                                                       const double& speed,
+                                                       const type::Mode_e& mode,
+                                                       const DateTime init_dt,
+                                                       const RAPTOR& raptor,
+                                                       const type::GeographicalCoord& coord_origin,
+                                                       const std::vector<DateTime>& boundary_duration,
+                                                       const bool clockwise,
+                                                       const DateTime bound,
+                                                       const uint resolution,
+                                                       const size_t nb_threads) {
+    std::vector<Isochrone> isochrone;
+    if (boundary_duration.empty()) {
+        return isochrone;
+    }
+    // one search and one grid for the largest duration, all the bands are then traced on that grid
+    const auto heat_map_distances = compute_heat_map_distances(worker, speed, mode, init_dt, raptor, coord_origin,
+                                                               boundary_duration[0], clockwise, bound);
+    const auto heat_map =
+        make_grid(worker, heat_map_distances, speed, boundary_duration[0], resolution, nb_threads, raptor.deadline);
+    for (size_t i = 1; i < boundary_duration.size(); i++) {
+        isochrone.push_back(Isochrone(trace_cells(heat_map, boundary_duration[i], boundary_duration[i - 1]),
+                                      boundary_duration[i], boundary_duration[i - 1]));
+    }
+    std::reverse(isochrone.begin(), isochrone.end());
+    return isochrone;
 }
 
 static double walking_distance(const DateTime& max_duration, const DateTime& duration, const double speed) {
@@ -341,6 +594,59 @@ static BoundBox find_boundary_box(const georef::GeoRef& worker,
     return box;
 }
 
+template <typename Graph, typename WeightMap>
+static void dijkstra_from_init_points(const Graph& graph,
+                                      const WeightMap& weight_map,
+                                      const std::vector<georef::vertex_t>& init_points,
+                                      const georef::TransportationModeFilter& filter,
+                                      const float speed_factor,
+                                      const DateTime duration,
+                                      const navitia::Deadline* deadline,
+                                      std::vector<navitia::time_duration>& distances) {
+    std::vector<georef::vertex_t> predecessors(boost::num_vertices(graph));
+    auto visitor = georef::dijkstra_distance_visitor(navitia::seconds(duration), distances, deadline);
+    auto index_map = boost::identity_property_map();
+    using filtered_graph = boost::filtered_graph<Graph, boost::keep_all, georef::TransportationModeFilter>;
+    try {
+        boost::dijkstra_shortest_paths_no_init(filtered_graph(graph, {}, filter), init_points.begin(),
+                                               init_points.end(), &predecessors[0], &distances[0], weight_map,
+                                               index_map, std::less<navitia::time_duration>(),
+                                               georef::SpeedDistanceCombiner(speed_factor), navitia::seconds(0),
+                                               visitor);
+    } catch (georef::DestinationFound) {
+    }
+}
+
+HeatMapDistances compute_heat_map_distances(const georef::GeoRef& worker,
+                                            const double& speed,
+                                            const type::Mode_e& mode,
+                                            const DateTime init_dt,
+                                            const RAPTOR& raptor,
+                                            const type::GeographicalCoord& coord_origin,
+                                            const DateTime duration,
+                                            const bool clockwise,
+                                            const DateTime bound) {
+    const auto& stop_points = raptor.data.pt_data->stop_points;
+    HeatMapDistances res;
+    res.box =
+        find_boundary_box(worker, stop_points, init_dt, raptor, mode, coord_origin, clockwise, bound, duration, speed);
+    auto init_points = init_vertex(worker, stop_points, raptor, mode, coord_origin, clockwise, bound);
+    auto distances = init_distance(worker, stop_points, init_dt, raptor, mode, coord_origin, clockwise, bound, speed);
+    float speed_factor = float(speed) / georef::default_speed[mode];
+    const auto filter = georef::TransportationModeFilter(mode, worker);
+    // a single dijkstra from all the reached stop points and the origin
+    if (worker.has_compact_graph()) {
+        dijkstra_from_init_points(worker.compact_graph, worker.compact_graph.duration_map(), init_points, filter,
+                                  speed_factor, duration, raptor.deadline, distances);
+    } else {
+        dijkstra_from_init_points(worker.graph, boost::get(&georef::Edge::duration, worker.graph), init_points, filter,
+                                  speed_factor, duration, raptor.deadline, distances);
+    }
+    // the durations by vertex of the graph are only kept for the edges of the box
+    res.edges = find_edges_in_box(worker, res.box, distances);
+    return res;
+}
+
 std::string build_raster_isochrone(const georef::GeoRef& worker,
                                    const double& speed,
                                    const type::Mode_e& mode,
@@ -350,30 +656,11 @@ std::string build_raster_isochrone(const georef::GeoRef& worker,
                                    const DateTime duration,
                                    const bool clockwise,
                                    const DateTime bound,
-                                   const uint resolution) {
-    const auto& stop_points = raptor.data.pt_data->stop_points;
-    std::vector<georef::vertex_t> predecessors;
-    size_t n = boost::num_vertices(worker.graph);
-    predecessors.resize(n);
-    auto box =
-        find_boundary_box(worker, stop_points, init_dt, raptor, mode, coord_origin, clockwise, bound, duration, speed);
-    auto init_points = init_vertex(worker, stop_points, raptor, mode, coord_origin, clockwise, bound);
-    auto distances = init_distance(worker, stop_points, init_dt, raptor, mode, coord_origin, clockwise, bound, speed);
-    auto start = init_points.begin();
-    auto end = init_points.end();
-    float speed_factor = float(speed) / georef::default_speed[mode];
-    auto visitor = georef::dijkstra_distance_visitor(navitia::seconds(duration), distances);
-    auto index_map = boost::identity_property_map();
-    using filtered_graph = boost::filtered_graph<georef::Graph, boost::keep_all, georef::TransportationModeFilter>;
-    try {
-        boost::dijkstra_shortest_paths_no_init(
-            filtered_graph(worker.graph, {}, georef::TransportationModeFilter(mode, worker)), start, end,
-            &predecessors[0], &distances[0], boost::get(&georef::Edge::duration, worker.graph), index_map,
-            std::less<navitia::time_duration>(), georef::SpeedDistanceCombiner(speed_factor), navitia::seconds(0),
-            visitor);
-    } catch (georef::DestinationFound) {
-    }
-    return build_grid(worker, box, distances, speed, duration, resolution);
+                                   const uint resolution,
+                                   const size_t nb_threads) {
+    const auto heat_map_distances =
+        compute_heat_map_distances(worker, speed, mode, init_dt, raptor, coord_origin, duration, clockwise, bound);
+    return build_grid(worker, heat_map_distances, speed, duration, resolution, nb_threads, raptor.deadline);
 }
 
 }  // namespace routing
@@ -69,7 +69,7 @@ struct BoundBox {
         this->min = type::GeographicalCoord(lon_min, lat_min);
     }
 
-    bool contains(const type::GeographicalCoord& coord) {
+    bool contains(const type::GeographicalCoord& coord) const {
         return this->max.lon() >= coord.lon() && this->max.lat() >= coord.lat() && this->min.lon() <= coord.lon()
                && this->min.lat() <= coord.lat();
     }
@@ -108,6 +108,31 @@ std::vector<navitia::time_duration> init_distance(const georef::GeoRef& worker,
                                                   const DateTime& bound,
                                                   const double speed);
 
+// An edge of the walking graph starting in the box of a heat map, with the durations to its ends
+struct HeatMapEdge {
+    georef::vertex_t source;
+    georef::vertex_t target;
+    navitia::time_duration source_duration;
+    navitia::time_duration target_duration;
+};
+
+// The edges whose source is in the box, the durations being given by vertex of the graph
+std::vector<HeatMapEdge> find_edges_in_box(const georef::GeoRef& worker,
+                                           const BoundBox& box,
+                                           const std::vector<navitia::time_duration>& distances);
+
+HeatMap fill_heat_map(const BoundBox& box,
+                      const double height_step,
+                      const double width_step,
+                      const georef::GeoRef& worker,
+                      const double min_dist,
+                      const double max_duration,
+                      const double speed,
+                      const std::vector<HeatMapEdge>& edges,
+                      const size_t step,
+                      const size_t nb_threads = 1,
+                      const navitia::Deadline* deadline = nullptr);
+
 HeatMap fill_heat_map(const BoundBox& box,
                       const double height_step,
                       const double width_step,
@@ -116,10 +141,79 @@ HeatMap fill_heat_map(const BoundBox& box,
                       const double max_duration,
                       const double speed,
                       const std::vector<navitia::time_duration>& distances,
-                      const size_t step);
+                      const size_t step,
+                      const size_t nb_threads = 1,
+                      const navitia::Deadline* deadline = nullptr);
 
 std::string print_grid(const HeatMap& heat_map);
 
+// Street network part of a heat map, it does not depend on the resolution.
+// Only the edges of the box are kept, its size is thus bounded by the box and not by the graph
+struct HeatMapDistances {
+    BoundBox box;
+    std::vector<HeatMapEdge> edges;
+};
+
+// Last heat map computed by a worker, reused when only the resolution of the request changes
+struct HeatMapCache {
+    std::string key;
+    bt::ptime datetime;
+    HeatMapDistances heat_map_distances;
+};
+
+/*
+ * Durations to the vertices of the graph, with a single dijkstra from the
+ * origin and all the stop points reached by the raptor
+ */
+HeatMapDistances compute_heat_map_distances(const georef::GeoRef& worker,
+                                            const double& speed,
+                                            const type::Mode_e& mode,
+                                            const DateTime init_dt,
+                                            const RAPTOR& raptor,
+                                            const type::GeographicalCoord& coord_origin,
+                                            const DateTime duration,
+                                            const bool clockwise,
+                                            const DateTime bound);
+
+/*
+ * The grid of the heat map, printed as json
+ *
+ * The cells are filled by tiles of longitudes distributed between nb_threads threads,
+ * the deadline being checked before each tile
+ */
+std::string build_grid(const georef::GeoRef& worker,
+                       const HeatMapDistances& heat_map_distances,
+                       const double speed,
+                       const double max_duration,
+                       const uint resolution,
+                       const size_t nb_threads = 1,
+                       const navitia::Deadline* deadline = nullptr);
+
+/*
+ * Polygons covering the cells of the grid whose duration is in [min_duration, max_duration)
+ *
+ * The borders of the cells are followed into rings, a polygon being a 4-connected set of cells
+ */
+type::MultiPolygon trace_cells(const HeatMap& heat_map, const DateTime min_duration, const DateTime max_duration);
+
+/*
+ * Same bands as build_isochrones, traced on the grid of a heat map
+ *
+ * A single dijkstra is seeded with the origin and all the stop points reached
+ * by the raptor, all the bands are then derived from its grid
+ */
+std::vector<Isochrone> build_street_network_isochrones(const georef::GeoRef& worker,
+                                                       const double& speed,
+                                                       const type::Mode_e& mode,
+                                                       const DateTime init_dt,
+                                                       const RAPTOR& raptor,
+                                                       const type::GeographicalCoord& coord_origin,
+                                                       const std::vector<DateTime>& boundary_duration,
+                                                       const bool clockwise,
+                                                       const DateTime bound,
+                                                       const uint resolution,
+                                                       const size_t nb_threads = 1);
+
 std::string build_raster_isochrone(const georef::GeoRef& worker,
                                    const double& speed,
                                    const type::Mode_e& mode,
@@ -129,7 +223,8 @@ std::string build_raster_isochrone(const georef::GeoRef& worker,
                                    const DateTime duration,
                                    const bool clockwise,
                                    const DateTime bound,
-                                   const uint resolution);
+                                   const uint resolution,
+                                   const size_t nb_threads = 1);
 
 }  // namespace routing
 }  // namespace navitia
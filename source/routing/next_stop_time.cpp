@@ -40,6 +40,10 @@ www.navitia.io
 #include <boost/range/algorithm/sort.hpp>
 #include <boost/range/algorithm_ext/push_back.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
 namespace navitia {
 namespace routing {
 
@@ -91,6 +95,19 @@ void NextStopTimeData::TimesStopTimes<Getter>::init(const JourneyPattern& jp, co
     }
 }
 
+template <typename Getter>
+void NextStopTimeData::TimesStopTimes<Getter>::init_from(const TimesStopTimes& previous, const type::PT_Data& data) {
+    // the vehicle journeys are the same (same idx, same stop times),
+    // thus the order is the same, we only need to point on the new
+    // stop times
+    times = previous.times;
+    stop_times.reserve(previous.stop_times.size());
+    for (const auto* st : previous.stop_times) {
+        const auto* vj = data.vehicle_journeys[st->vehicle_journey->idx];
+        stop_times.push_back(&vj->stop_time_list[st->order().val]);
+    }
+}
+
 void NextStopTimeData::load(const JourneyPatternContainer& jp_container) {
     departure.assign(jp_container.get_jpps_values());
     arrival.assign(jp_container.get_jpps_values());
@@ -104,6 +121,27 @@ void NextStopTimeData::load(const JourneyPatternContainer& jp_container) {
     }
 }
 
+void NextStopTimeData::load(const JourneyPatternContainer& jp_container,
+                            const type::PT_Data& data,
+                            const NextStopTimeData& previous,
+                            const IdxMap<JourneyPatternPoint, boost::optional<JppIdx>>& previous_jpps) {
+    departure.assign(jp_container.get_jpps_values());
+    arrival.assign(jp_container.get_jpps_values());
+
+    for (const auto jp : jp_container.get_jps()) {
+        for (const auto& jpp_idx : jp.second.jpps) {
+            if (const auto& prev_jpp_idx = previous_jpps[jpp_idx]) {
+                departure[jpp_idx].init_from(previous.departure[*prev_jpp_idx], data);
+                arrival[jpp_idx].init_from(previous.arrival[*prev_jpp_idx], data);
+                continue;
+            }
+            const auto& jpp = jp_container.get(jpp_idx);
+            departure[jpp_idx].init(jp.second, jpp);
+            arrival[jpp_idx].init(jp.second, jpp);
+        }
+    }
+}
+
 inline static bool is_valid(const type::StopTime* st,
                             const DateTime date,
                             const bool clockwise,
@@ -361,23 +399,25 @@ static void vj_loop(const nt::FrequencyVehicleJourney* vj, F f) {
 template <typename VJ_T>
 static void fill_cache(const DateTime from,
                        const DateTime to,
-                       const type::RTLevel rt_level,
-                       const type::AccessibiliteParams& accessibilite_params,
                        const JourneyPattern& jp,
                        const std::vector<const VJ_T*>& vjs,
-                       IdxMap<JourneyPatternPoint, std::vector<CachedNextStopTime::DtSt>>& arrival_cache,
-                       IdxMap<JourneyPatternPoint, std::vector<CachedNextStopTime::DtSt>>& departure_cache) {
+                       CachedNextStopTimeBase::vDtStByJpp& arrival_cache,
+                       CachedNextStopTimeBase::vDtStByJpp& departure_cache) {
     const int to_int = static_cast<int>(DateTimeUtils::date(to));
     // In case of Vj that passes midnight, we should compute one day before "from"
     const int from_int = std::max(static_cast<int>(DateTimeUtils::date(from)) - 1, 0);
     for (const auto* vj : vjs) {
-        if (!vj->accessible(accessibilite_params.vehicle_properties)) {
-            continue;
-        }
-        // test validity pattern of vj
-        const auto* vp = vj->validity_patterns[rt_level];
+        // the accessibility is filtered at lookup, the entries only keep the properties of the vj
+        const auto vehicle_props = static_cast<uint8_t>(vj->_vehicle_properties.to_ulong());
         for (int day = from_int; day <= to_int; ++day) {
-            if (!vp->check(day)) {
+            // test validity pattern of vj for every RT level
+            uint8_t rt_levels = 0;
+            for (const auto rt_level : {type::RTLevel::Base, type::RTLevel::Adapted, type::RTLevel::RealTime}) {
+                if (vj->validity_patterns[rt_level]->check(day)) {
+                    rt_levels |= uint8_t(1) << static_cast<size_t>(rt_level);
+                }
+            }
+            if (!rt_levels) {
                 continue;
             }
             const auto shift = navitia::DateTimeUtils::SECONDS_PER_DAY * day;
@@ -388,13 +428,13 @@ static void fill_cache(const DateTime from,
                     if (st.drop_off_allowed()) {
                         auto arrival_time = st.alighting_time + shift + freq_shift;
                         if (from <= arrival_time && arrival_time <= to) {
-                            arrival_cache[jpp_idx].emplace_back(arrival_time, &st);
+                            arrival_cache[jpp_idx].emplace_back(arrival_time, rt_levels, vehicle_props, &st);
                         }
                     }
                     if (st.pick_up_allowed()) {
                         auto departure_time = st.boarding_time + shift + freq_shift;
                         if (departure_time <= to && from <= departure_time) {
-                            departure_cache[jpp_idx].emplace_back(departure_time, &st);
+                            departure_cache[jpp_idx].emplace_back(departure_time, rt_levels, vehicle_props, &st);
                         }
                     }
                 };
@@ -406,30 +446,23 @@ static void fill_cache(const DateTime from,
     }
 }
 
-bool CachedNextStopTimeKey::operator<(const CachedNextStopTimeKey& other) const {
-    if (from != other.from) {
-        return from < other.from;
-    } else if (rt_level != other.rt_level) {
-        return rt_level < other.rt_level;
-    }
-    return accessibilite_params < other.accessibilite_params;
-}
-
-CachedNextStopTime CachedNextStopTimeManager::CacheCreator::operator()(const CachedNextStopTimeKey& key) const {
-    CachedNextStopTime::vDtStByJpp departure, arrival;
+CachedNextStopTimeBase CachedNextStopTimeManager::CacheCreator::operator()(
+    const CachedNextStopTimeBase::Day& from) const {
+    const auto start = std::chrono::steady_clock::now();
+    CachedNextStopTimeBase::vDtStByJpp departure, arrival;
     const auto& jp_container = dataRaptor.jp_container;
 
     departure.assign(jp_container.get_jpps_values());
     arrival.assign(jp_container.get_jpps_values());
-    DateTime dt_from = DateTimeUtils::set(key.from, 0);
-    DateTime dt_to = DateTimeUtils::set(key.from + 2, 0);  // cache window is 2-days wide (journeys : 24h max)
+    DateTime dt_from = DateTimeUtils::set(from, 0);
+    DateTime dt_to = DateTimeUtils::set(from + 2, 0);  // cache window is 2-days wide (journeys : 24h max)
 
     for (const auto& jp : jp_container.get_jps_values()) {
-        fill_cache(dt_from, dt_to, key.rt_level, key.accessibilite_params, jp, jp.discrete_vjs, arrival, departure);
-        fill_cache(dt_from, dt_to, key.rt_level, key.accessibilite_params, jp, jp.freq_vjs, arrival, departure);
+        fill_cache(dt_from, dt_to, jp, jp.discrete_vjs, arrival, departure);
+        fill_cache(dt_from, dt_to, jp, jp.freq_vjs, arrival, departure);
     }
-    auto compare = [](const CachedNextStopTime::DtSt& lhs, const CachedNextStopTime::DtSt& rhs) noexcept {
-        return lhs.first < rhs.first;
+    auto compare = [](const CachedNextStopTimeBase::DtSt& lhs, const CachedNextStopTimeBase::DtSt& rhs) noexcept {
+        return lhs.dt < rhs.dt;
     };
     for (const auto jpp_dtst : arrival) {
         boost::sort(jpp_dtst.second, compare);
@@ -437,10 +470,13 @@ CachedNextStopTime CachedNextStopTimeManager::CacheCreator::operator()(const Cac
     for (const auto jpp_dtst : departure) {
         boost::sort(jpp_dtst.second, compare);
     }
-    return {departure, arrival};
+    CachedNextStopTimeBase res(departure, arrival);
+    const auto duration = std::chrono::steady_clock::now() - start;
+    *build_duration_us += std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    return res;
 }
 
-CachedNextStopTime::DtStFromJpp::DtStFromJpp(const vDtStByJpp& map) {
+CachedNextStopTimeBase::DtStFromJpp::DtStFromJpp(const vDtStByJpp& map) {
     size_t s = 0;
     for (const auto elt : map) {
         s += elt.second.size();
@@ -454,36 +490,74 @@ CachedNextStopTime::DtStFromJpp::DtStFromJpp(const vDtStByJpp& map) {
     dtsts.shrink_to_fit();
 }
 
-boost::iterator_range<CachedNextStopTime::vDtSt::const_iterator> CachedNextStopTime::DtStFromJpp::operator[](
+CachedNextStopTimeBase::DtStFromJpp::DtStFromJpp(const DtStFromJpp& all,
+                                                 const uint8_t rt_level_mask,
+                                                 const uint8_t required_vehicle_props) {
+    until.assign(all.until, 0);
+    for (const auto elt : all.until) {
+        for (const auto& dtst : all[elt.first]) {
+            if (dtst.is_valid(rt_level_mask, required_vehicle_props)) {
+                dtsts.push_back(dtst);
+            }
+        }
+        until[elt.first] = dtsts.size();
+    }
+    dtsts.shrink_to_fit();
+}
+
+boost::iterator_range<CachedNextStopTimeBase::vDtSt::const_iterator> CachedNextStopTimeBase::DtStFromJpp::operator[](
     const JppIdx& jpp_idx) const {
     const auto from = jpp_idx.val == 0 ? 0 : until[JppIdx(jpp_idx.val - 1)];
     const auto begin = dtsts.begin();
     return boost::make_iterator_range(begin + from, begin + until[jpp_idx]);
 }
 
+std::shared_ptr<const CachedNextStopTimeBase::Filtered> CachedNextStopTimeBase::filtered(
+    const uint8_t rt_level_mask,
+    const uint8_t required_vehicle_props) const {
+    std::lock_guard<std::mutex> lock(filtered_cache->mutex);
+    const uint16_t key = uint16_t(rt_level_mask) << 8 | required_vehicle_props;
+    const auto it = filtered_cache->by_filters.find(key);
+    if (it != filtered_cache->by_filters.end()) {
+        return it->second;
+    }
+    std::shared_ptr<const Filtered> res;
+    DtStFromJpp filtered_departure(departure, rt_level_mask, required_vehicle_props);
+    DtStFromJpp filtered_arrival(arrival, rt_level_mask, required_vehicle_props);
+    if (filtered_departure.size() != departure.size() || filtered_arrival.size() != arrival.size()) {
+        res = std::make_shared<const Filtered>(Filtered{std::move(filtered_departure), std::move(filtered_arrival)});
+    }
+    filtered_cache->by_filters[key] = res;
+    return res;
+}
+
+CachedNextStopTime::CachedNextStopTime(std::shared_ptr<const CachedNextStopTimeBase> b,
+                                       const type::RTLevel rt_level,
+                                       const type::VehicleProperties& vehicle_props)
+    : base(std::move(b)),
+      filtered(base->filtered(uint8_t(1) << static_cast<size_t>(rt_level),
+                              static_cast<uint8_t>(vehicle_props.to_ulong()))),
+      departure(filtered ? &filtered->departure : &base->departure),
+      arrival(filtered ? &filtered->arrival : &base->arrival) {}
+
 std::pair<const type::StopTime*, DateTime> CachedNextStopTime::next_stop_time(const StopEvent stop_event,
                                                                               const JppIdx jpp_idx,
                                                                               const DateTime dt,
                                                                               const bool clockwise) const {
-    const auto& v = (stop_event == StopEvent::pick_up ? departure[jpp_idx] : arrival[jpp_idx]);
-    const type::StopTime* null_st = nullptr;
-    decltype(v.begin()) search;
-    auto cmp = [](const CachedNextStopTime::DtSt& a, const CachedNextStopTime::DtSt& b) noexcept {
-        return a.first < b.first;
-    };
+    const auto& v = (stop_event == StopEvent::pick_up ? (*departure)[jpp_idx] : (*arrival)[jpp_idx]);
     if (clockwise) {
-        search = boost::lower_bound(v, std::make_pair(dt, null_st), cmp);
+        const auto search =
+            boost::lower_bound(v, dt, [](const DtSt& a, const DateTime b) noexcept { return a.dt < b; });
+        if (search != v.end()) {
+            return {search->st, search->dt};
+        }
     } else {
-        search = boost::upper_bound(v, std::make_pair(dt, null_st), cmp);
-        if (search == v.begin()) {
-            search = v.end();
-        } else if (!v.empty()) {
-            --search;
+        const auto search =
+            boost::upper_bound(v, dt, [](const DateTime a, const DtSt& b) noexcept { return a < b.dt; });
+        if (search != v.begin()) {
+            return {std::prev(search)->st, std::prev(search)->dt};
         }
     }
-    if (search != v.end()) {
-        return {search->second, search->first};
-    }
     return {nullptr, 0};
 }
 
@@ -496,8 +570,22 @@ std::shared_ptr<const CachedNextStopTime> CachedNextStopTimeManager::load(
     const DateTime from,
     const type::RTLevel rt_level,
     const type::AccessibiliteParams& accessibilite_params) {
-    CachedNextStopTimeKey key(DateTimeUtils::date(from), rt_level, accessibilite_params);
-    return lru(key);
+    return std::make_shared<const CachedNextStopTime>(lru(DateTimeUtils::date(from)), rt_level,
+                                                      accessibilite_params.vehicle_properties);
+}
+
+void CachedNextStopTimeManager::prebuild(const DateTime from) {
+    lru(DateTimeUtils::date(from));
+}
+
+CachedNextStopTimeStats CachedNextStopTimeManager::get_stats() const {
+    CachedNextStopTimeStats stats;
+    stats.nb_calls = lru.get_nb_calls();
+    stats.nb_cache_miss = lru.get_nb_cache_miss();
+    // every miss beyond the capacity of the lru has evicted a day
+    stats.nb_evictions = stats.nb_cache_miss > max_cache ? stats.nb_cache_miss - max_cache : 0;
+    stats.build_duration = *build_duration_us / 1e6;
+    return stats;
 }
 
 inline static bool within(u_int32_t val, std::pair<u_int32_t, u_int32_t> bound) {
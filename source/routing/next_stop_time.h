@@ -42,6 +42,11 @@ www.navitia.io
 #include <boost/optional.hpp>
 #include <boost/dynamic_bitset.hpp>
 
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+
 namespace navitia {
 
 namespace type {
@@ -63,6 +68,15 @@ struct NextStopTimeData {
 
     void load(const JourneyPatternContainer&);
 
+    // Same as load, but the jpps having a counterpart in
+    // previous_jpps (the same jpp of an unchanged journey pattern in
+    // previous) reuse the already sorted stop times of previous,
+    // remapped on the vehicle journeys of data.
+    void load(const JourneyPatternContainer&,
+              const type::PT_Data& data,
+              const NextStopTimeData& previous,
+              const IdxMap<JourneyPatternPoint, boost::optional<JppIdx>>& previous_jpps);
+
     // Returns the range of the stop times in increasing time order
     inline StopTimeIter stop_time_range_forward(const JppIdx jpp_idx, const StopEvent stop_event) const {
         if (stop_event == StopEvent::pick_up) {
@@ -139,6 +153,7 @@ private:
             return boost::make_iterator_range(stop_times.rend() - idx, stop_times.rend());
         }
         void init(const JourneyPattern& jp, const JourneyPatternPoint& jpp);
+        void init_from(const TimesStopTimes& previous, const type::PT_Data& data);
     };
     IdxMap<JourneyPatternPoint, TimesStopTimes<Departure>> departure;
     IdxMap<JourneyPatternPoint, TimesStopTimes<Arrival>> arrival;
@@ -199,43 +214,46 @@ private:
     const type::Data& data;
 };
 
-struct CachedNextStopTimeKey {
+// The stop times of a 2-days window, for every RT level and every
+// vehicle properties. It is shared by all the CachedNextStopTime of
+// the window, each one looking up in the entries valid for its RT
+// level and vehicle properties.
+struct CachedNextStopTimeBase {
     using Day = size_t;
 
-    Day from;                                        // first day concerned by the cache
-    type::RTLevel rt_level;                          // RT-level of the cache
-    type::AccessibiliteParams accessibilite_params;  // accessibility of the cache
-    CachedNextStopTimeKey(Day from, type::RTLevel rt_level, const type::AccessibiliteParams& accessibilite_params)
-        : from(from), rt_level(rt_level), accessibilite_params(accessibilite_params) {}
+    struct DtSt {
+        DateTime dt;
+        uint8_t rt_levels;      // bit i is set if the stop time is valid at RTLevel(i)
+        uint8_t vehicle_props;  // VehicleProperties of the vehicle journey
+        const type::StopTime* st;
 
-    bool operator<(const CachedNextStopTimeKey& other) const;
-};
+        DtSt(const DateTime dt, const uint8_t rt_levels, const uint8_t vehicle_props, const type::StopTime* st)
+            : dt(dt), rt_levels(rt_levels), vehicle_props(vehicle_props), st(st) {}
 
-struct CachedNextStopTime {
-    using DtSt = std::pair<DateTime, const type::StopTime*>;
+        bool is_valid(const uint8_t rt_level_mask, const uint8_t required_vehicle_props) const {
+            return (rt_levels & rt_level_mask) && !(required_vehicle_props & ~vehicle_props);
+        }
+    };
     using vDtSt = std::vector<DtSt>;
     using vDtStByJpp = IdxMap<JourneyPatternPoint, vDtSt>;
 
-    CachedNextStopTime(const vDtStByJpp& d, const vDtStByJpp& a) : departure(d), arrival(a) {}
-    // Returns the next stop time at given journey pattern point
-    // either a vehicle that leaves or that arrives depending on
-    // clockwise.
-    std::pair<const type::StopTime*, DateTime> next_stop_time(const StopEvent stop_event,
-                                                              const JppIdx jpp_idx,
-                                                              const DateTime dt,
-                                                              const bool clockwise) const;
+    CachedNextStopTimeBase(const vDtStByJpp& d, const vDtStByJpp& a)
+        : departure(d), arrival(a), filtered_cache(std::make_shared<FilteredCache>()) {}
 
-private:
     // This structure provide the same interface as a vDtStByJpp, but
     // in a condensed and read only view.
     struct DtStFromJpp {
         DtStFromJpp(const vDtStByJpp& map);
+        // only the entries of all valid for the RT levels and vehicle properties
+        DtStFromJpp(const DtStFromJpp& all, const uint8_t rt_level_mask, const uint8_t required_vehicle_props);
 
         // Returns the range corresponding to map[jpp_idx], i.e. from
         // dtsts[until[prev(jpp_idx)]] to dtsts[until[jpp_idx]]
         // (excluded).
         boost::iterator_range<vDtSt::const_iterator> operator[](const JppIdx& jpp_idx) const;
 
+        size_t size() const { return dtsts.size(); }
+
     private:
         // let map[JppIdx(40)] == []
         //     map[JppIdx(41)] == [a, l]
@@ -261,10 +279,65 @@ private:
     };
     DtStFromJpp departure;
     DtStFromJpp arrival;
+
+    // The entries valid for a RT level mask and vehicle properties
+    struct Filtered {
+        DtStFromJpp departure;
+        DtStFromJpp arrival;
+    };
+
+    // Built on the first call with these filters and kept with the base, so
+    // that the lookups stay binary searches. nullptr if every entry is valid
+    std::shared_ptr<const Filtered> filtered(const uint8_t rt_level_mask, const uint8_t required_vehicle_props) const;
+
+private:
+    struct FilteredCache {
+        std::mutex mutex;
+        // by rt_level_mask << 8 | required_vehicle_props
+        std::map<uint16_t, std::shared_ptr<const Filtered>> by_filters;
+    };
+    std::shared_ptr<FilteredCache> filtered_cache;
+};
+
+// The stop times of a 2-days window valid for a RT level and an
+// accessibility, taken from the shared CachedNextStopTimeBase.
+struct CachedNextStopTime {
+    using DtSt = CachedNextStopTimeBase::DtSt;
+
+    CachedNextStopTime(std::shared_ptr<const CachedNextStopTimeBase> base,
+                       const type::RTLevel rt_level,
+                       const type::VehicleProperties& vehicle_props);
+
+    // Returns the next stop time at given journey pattern point
+    // either a vehicle that leaves or that arrives depending on
+    // clockwise.
+    std::pair<const type::StopTime*, DateTime> next_stop_time(const StopEvent stop_event,
+                                                              const JppIdx jpp_idx,
+                                                              const DateTime dt,
+                                                              const bool clockwise) const;
+
+private:
+    std::shared_ptr<const CachedNextStopTimeBase> base;
+    std::shared_ptr<const CachedNextStopTimeBase::Filtered> filtered;
+    // the entries of base or of filtered
+    const CachedNextStopTimeBase::DtStFromJpp* departure;
+    const CachedNextStopTimeBase::DtStFromJpp* arrival;
+};
+
+struct CachedNextStopTimeStats {
+    size_t nb_calls = 0;
+    size_t nb_cache_miss = 0;
+    size_t nb_evictions = 0;
+    double build_duration = 0;  // cumulated duration of the cache builds, in seconds
 };
 
 struct CachedNextStopTimeManager {
-    explicit CachedNextStopTimeManager(const dataRAPTOR& dataRaptor, size_t max_cache) : lru({dataRaptor}, max_cache) {}
+    // max_cache is the number of days kept in the cache, every RT
+    // level and accessibility of a day sharing the same entry
+    explicit CachedNextStopTimeManager(const dataRAPTOR& dataRaptor, size_t max_cache)
+        : build_duration_us(std::make_shared<std::atomic<uint64_t>>(0)),
+          max_cache(max_cache),
+          lru({dataRaptor, build_duration_us}, max_cache) {}
     CachedNextStopTimeManager& operator=(CachedNextStopTimeManager&&) = default;
     ~CachedNextStopTimeManager();
 
@@ -272,17 +345,28 @@ struct CachedNextStopTimeManager {
                                                    const type::RTLevel rt_level,
                                                    const type::AccessibiliteParams& accessibilite_params);
 
+    // Builds the cache of the day of from if it is not already
+    // there, so that the next loads of this day are hits
+    void prebuild(const DateTime from);
+
     void warmup(const CachedNextStopTimeManager& other) { this->lru.warmup(other.lru); }
 
+    CachedNextStopTimeStats get_stats() const;
+
 private:
     struct CacheCreator {
-        typedef CachedNextStopTimeKey const& argument_type;
-        typedef CachedNextStopTime result_type;
+        typedef CachedNextStopTimeBase::Day const& argument_type;
+        typedef CachedNextStopTimeBase result_type;
         const dataRAPTOR& dataRaptor;
-        CacheCreator(const dataRAPTOR& d) : dataRaptor(d) {}
-        CachedNextStopTime operator()(const CachedNextStopTimeKey& key) const;
+        std::shared_ptr<std::atomic<uint64_t>> build_duration_us;
+        CacheCreator(const dataRAPTOR& d, std::shared_ptr<std::atomic<uint64_t>> build_duration_us)
+            : dataRaptor(d), build_duration_us(std::move(build_duration_us)) {}
+        CachedNextStopTimeBase operator()(const CachedNextStopTimeBase::Day& from) const;
     };
 
+    // shared with the creator of the lru, that is not reachable once built
+    std::shared_ptr<std::atomic<uint64_t>> build_duration_us;
+    size_t max_cache;
     ConcurrentLru<CacheCreator> lru;
 };
 
@@ -93,6 +93,9 @@ bool RAPTOR::apply_vj_extension(const Visitor& v,
                 continue;
             }
 
+            if (!working_labels.pt_is_initialized(sp_idx)) {
+                marked_sps_pt.push_back(sp_idx);
+            }
             working_labels.mut_dt_pt(sp_idx) = workingDt;
             best_labels_pts[sp_idx] = workingDt;
             result = true;
@@ -109,17 +112,12 @@ bool RAPTOR::foot_path(const Visitor& v) {
     const auto& cnx_list = v.clockwise() ? data.dataRaptor->connections.forward_connections
                                          : data.dataRaptor->connections.backward_connections;
 
-    for (const auto sp_cnx : cnx_list) {
-        // for all stop point, we check if we can improve the stop points they are in connection with
-        const auto& sp_idx = sp_cnx.first;
-
-        if (!working_labels.pt_is_initialized(sp_idx)) {
-            continue;
-        }
-
+    marked_sps_transfer.clear();
+    for (const auto sp_idx : marked_sps_pt) {
+        // for all improved stop point, we check if we can improve the stop points they are in connection with
         const DateTime previous = working_labels.dt_pt(sp_idx);
 
-        for (const auto& conn : sp_cnx.second) {
+        for (const auto& conn : cnx_list[sp_idx]) {
             const SpIdx destination_sp_idx = conn.sp_idx;
             const DateTime next = v.combine(previous, conn.duration);
 
@@ -128,31 +126,39 @@ bool RAPTOR::foot_path(const Visitor& v) {
             }
 
             // if we can improve the best label, we mark it
+            if (!working_labels.transfer_is_initialized(destination_sp_idx)) {
+                marked_sps_transfer.push_back(destination_sp_idx);
+            }
             working_labels.mut_dt_transfer(destination_sp_idx) = next;
             best_labels_transfers[destination_sp_idx] = next;
             result = true;
         }
     }
 
-    for (const auto sp_jpps : jpps_from_sp) {
-        if (!working_labels.transfer_is_initialized(sp_jpps.first)) {
-            continue;
-        }
-
+    for (const auto sp_idx : marked_sps_transfer) {
         // we mark the jpp order
-        for (const auto& jpp : sp_jpps.second) {
-            if (v.comp(jpp.order, Q[jpp.jp_idx])) {
-                Q[jpp.jp_idx] = jpp.order;
-            }
+        for (const auto& jpp : jpps_from_sp[sp_idx]) {
+            mark_jp(jpp.jp_idx, jpp.order, v.clockwise());
         }
     }
 
     return result;
 }
 
+void RAPTOR::mark_jp(const JpIdx jp_idx, const int order, const bool clockwise) {
+    auto& q_order = Q[jp_idx];
+    if (q_order == (clockwise ? std::numeric_limits<int>::max() : -1)) {
+        marked_jps.push_back(jp_idx);
+    }
+    if (clockwise ? order < q_order : order > q_order) {
+        q_order = order;
+    }
+}
+
 void RAPTOR::clear(const bool clockwise, const DateTime bound) {
     const int queue_value = clockwise ? std::numeric_limits<int>::max() : -1;
     Q.assign(data.dataRaptor->jp_container.get_jps_values(), queue_value);
+    marked_jps.clear();
     if (labels.empty()) {
         labels.resize(5);
     }
@@ -178,11 +184,7 @@ void RAPTOR::init(const map_stop_point_duration& dep,
         labels[0].mut_dt_transfer(sp_dt.first) = begin_dt;
         best_labels_transfers[sp_dt.first] = begin_dt;
         for (const auto& jpp : jpps_from_sp[sp_dt.first]) {
-            if (clockwise && Q[jpp.jp_idx] > jpp.order) {
-                Q[jpp.jp_idx] = jpp.order;
-            } else if (!clockwise && Q[jpp.jp_idx] < jpp.order) {
-                Q[jpp.jp_idx] = jpp.order;
-            }
+            mark_jp(jpp.jp_idx, jpp.order, clockwise);
         }
     }
 }
@@ -391,6 +393,21 @@ std::vector<Path> RAPTOR::compute_all(const map_stop_point_duration& departures,
     return from_journeys_to_path(journeys);
 }
 
+std::ostream& operator<<(std::ostream& os, const std::vector<RAPTOR::RoundCounters>& counters) {
+    for (const auto& c : counters) {
+        os << " " << c.nb_marked_jps << "/" << c.nb_marked_sps;
+    }
+    return os;
+}
+
+RAPTOR& RAPTOR::get_profile_worker(const size_t i) {
+    while (profile_workers.size() <= i) {
+        profile_workers.push_back(std::make_unique<RAPTOR>(data));
+    }
+    profile_workers[i]->deadline = deadline;
+    return *profile_workers[i];
+}
+
 RAPTOR::Journeys RAPTOR::compute_all_journeys(const map_stop_point_duration& departures,
                                               const map_stop_point_duration& destinations,
                                               const DateTime& departure_datetime,
@@ -425,6 +442,8 @@ RAPTOR::Journeys RAPTOR::compute_all_journeys(const map_stop_point_duration& dep
     first_raptor_loop(calc_dep, departure_datetime, rt_level, bound, max_transfers, accessibilite_params, clockwise);
 
     auto end_first_pass = std::chrono::system_clock::now();
+    log4cplus::Logger logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("logger"));
+    LOG4CPLUS_DEBUG(logger, "[1st pass] marked journey patterns/stop points by round:" << round_counters);
 
     // Now, we do the second pass.  In case of clockwise (resp
     // anticlockwise) search, the goal of the second pass is to find
@@ -451,6 +470,7 @@ RAPTOR::Journeys RAPTOR::compute_all_journeys(const map_stop_point_duration& dep
 
     size_t nb_snd_pass = 0, nb_useless = 0, last_usefull_2nd_pass = 0, supplementary_2nd_pass = 0;
     for (const auto& start : starting_points) {
+        check_deadline();
         Journey fake_journey =
             convert_to_bound(start, lower_bound_fb, data.dataRaptor->min_connection_time, transfer_penalty, clockwise);
         if (solutions.contains_better_than(fake_journey)) {
@@ -478,7 +498,6 @@ RAPTOR::Journeys RAPTOR::compute_all_journeys(const map_stop_point_duration& dep
 
         ++nb_snd_pass;
     }
-    log4cplus::Logger logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("logger"));
     LOG4CPLUS_DEBUG(logger, "[2nd pass] lower bound fallback duration = "
                                 << lower_bound_fb << " s, lower bound connection duration = "
                                 << data.dataRaptor->min_connection_time << " s");
@@ -655,10 +674,13 @@ template <typename Visitor>
 void RAPTOR::raptor_loop(Visitor visitor, const nt::RTLevel rt_level, uint32_t max_transfers) {
     bool continue_algorithm = true;
     count = 0;  //< Count iteration of raptor algorithm
+    round_counters.clear();
 
     while (continue_algorithm && count <= max_transfers) {
+        check_deadline();
         ++count;
         continue_algorithm = false;
+        marked_sps_pt.clear();
         if (count == labels.size()) {
             if (visitor.clockwise()) {
                 this->labels.push_back(this->data.dataRaptor->labels_const);
@@ -668,84 +690,92 @@ void RAPTOR::raptor_loop(Visitor visitor, const nt::RTLevel rt_level, uint32_t m
         }
         const auto& prec_labels = labels[count - 1];
         auto& working_labels = labels[this->count];
+        const auto& st_table = data.dataRaptor->st_table;
         /*
          * We need to store it so we can apply stay_in after applying normal vjs
          * We want to do it, to favoritize normal vj against stay_in vjs
          */
-        for (auto q_elt : Q) {
-            const JpIdx jp_idx = q_elt.first;
-            if (q_elt.second != visitor.init_queue_item()) {
-                bool is_onboard = false;
-                DateTime workingDt = visitor.worst_datetime();
-                DateTime base_dt = workingDt;
-                typename Visitor::stop_time_iterator it_st;
-                uint16_t l_zone = std::numeric_limits<uint16_t>::max();
-                const auto& jpps_to_explore =
-                    visitor.jpps_from_order(data.dataRaptor->jpps_from_jp, jp_idx, q_elt.second);
-                for (const auto& jpp : jpps_to_explore) {
-                    if (is_onboard) {
-                        ++it_st;
-                        // We update workingDt with the new arrival time
-                        // We need at each journey pattern point when we have a st
-                        // If we don't it might cause problem with overmidnight vj
-                        const type::StopTime& st = *it_st;
-                        workingDt = st.section_end(base_dt, visitor.clockwise());
-                        // We check if there are no drop_off_only and if the local_zone is okay
-                        if (st.valid_end(visitor.clockwise())
-                            && (l_zone == std::numeric_limits<uint16_t>::max() || l_zone != st.local_traffic_zone)
-                            && visitor.comp(workingDt, best_labels_pts[jpp.sp_idx])
-                            && valid_stop_points[jpp.sp_idx.val])  // we need to check the accessibility
-                        {
-                            working_labels.mut_dt_pt(jpp.sp_idx) = workingDt;
-                            best_labels_pts[jpp.sp_idx] = working_labels.dt_pt(jpp.sp_idx);
-                            continue_algorithm = true;
+        // exploring the journey patterns in their order is more cache friendly
+        std::sort(marked_jps.begin(), marked_jps.end());
+        for (const JpIdx jp_idx : marked_jps) {
+            bool is_onboard = false;
+            DateTime workingDt = visitor.worst_datetime();
+            DateTime base_dt = workingDt;
+            typename Visitor::stop_time_iterator it_st;
+            // position of *it_st in st_table, the times are read from there during the scan
+            uint32_t st_pos = 0;
+            uint16_t l_zone = std::numeric_limits<uint16_t>::max();
+            const auto& jpps_to_explore = visitor.jpps_from_order(data.dataRaptor->jpps_from_jp, jp_idx, Q[jp_idx]);
+            for (const auto& jpp : jpps_to_explore) {
+                if (is_onboard) {
+                    ++it_st;
+                    st_pos = visitor.next_st_pos(st_pos);
+                    // We update workingDt with the new arrival time
+                    // We need at each journey pattern point when we have a st
+                    // If we don't it might cause problem with overmidnight vj
+                    workingDt = st_table.section_end(st_pos, base_dt, visitor.clockwise());
+                    // We check if there are no drop_off_only and if the local_zone is okay
+                    if (st_table.valid_end(st_pos, visitor.clockwise())
+                        && (l_zone == std::numeric_limits<uint16_t>::max()
+                            || l_zone != st_table.local_traffic_zones[st_pos])
+                        && visitor.comp(workingDt, best_labels_pts[jpp.sp_idx])
+                        && valid_stop_points[jpp.sp_idx.val])  // we need to check the accessibility
+                    {
+                        if (!working_labels.pt_is_initialized(jpp.sp_idx)) {
+                            marked_sps_pt.push_back(jpp.sp_idx);
                         }
+                        working_labels.mut_dt_pt(jpp.sp_idx) = workingDt;
+                        best_labels_pts[jpp.sp_idx] = working_labels.dt_pt(jpp.sp_idx);
+                        continue_algorithm = true;
                     }
+                }
 
-                    // We try to get on a vehicle, if we were already on a vehicle, but we arrived
-                    // before on the previous via a connection, we try to catch a vehicle leaving this
-                    // journey pattern point before
-                    const DateTime previous_dt = prec_labels.dt_transfer(jpp.sp_idx);
-                    if (prec_labels.transfer_is_initialized(jpp.sp_idx) && valid_stop_points[jpp.sp_idx.val]
-                        && (!is_onboard || visitor.better_or_equal(previous_dt, base_dt, *it_st))) {
-                        const auto tmp_st_dt =
-                            next_st->next_stop_time(visitor.stop_event(), jpp.idx, previous_dt, visitor.clockwise());
-                        if (tmp_st_dt.first != nullptr) {
-                            if (!is_onboard || &*it_st != tmp_st_dt.first) {
-                                // st_range is quite cache
-                                // unfriendly, so avoid using it if
-                                // not really needed.
-                                it_st = visitor.st_range(*tmp_st_dt.first).begin();
-                                is_onboard = true;
-                                l_zone = it_st->local_traffic_zone;
-                                // note that if we have found a better
-                                // pickup, and that this pickup does
-                                // not have the same local traffic
-                                // zone, we may miss some interesting
-                                // solutions.
-                            } else if (l_zone != it_st->local_traffic_zone) {
-                                // if we can pick up in this vj with 2
-                                // different zones, we can drop off
-                                // anywhere (we'll chose later at
-                                // which stop we pickup)
-                                l_zone = std::numeric_limits<uint16_t>::max();
-                            }
-                            workingDt = tmp_st_dt.second;
-                            base_dt = tmp_st_dt.first->base_dt(workingDt, visitor.clockwise());
-                            BOOST_ASSERT(!visitor.comp(workingDt, previous_dt));
+                // We try to get on a vehicle, if we were already on a vehicle, but we arrived
+                // before on the previous via a connection, we try to catch a vehicle leaving this
+                // journey pattern point before
+                const DateTime previous_dt = prec_labels.dt_transfer(jpp.sp_idx);
+                if (prec_labels.transfer_is_initialized(jpp.sp_idx) && valid_stop_points[jpp.sp_idx.val]
+                    && (!is_onboard || visitor.better_or_equal(previous_dt, base_dt, st_table, st_pos))) {
+                    const auto tmp_st_dt =
+                        next_st->next_stop_time(visitor.stop_event(), jpp.idx, previous_dt, visitor.clockwise());
+                    if (tmp_st_dt.first != nullptr) {
+                        if (!is_onboard || &*it_st != tmp_st_dt.first) {
+                            // st_range is quite cache
+                            // unfriendly, so avoid using it if
+                            // not really needed.
+                            it_st = visitor.st_range(*tmp_st_dt.first).begin();
+                            st_pos = st_table.pos(*tmp_st_dt.first);
+                            is_onboard = true;
+                            l_zone = st_table.local_traffic_zones[st_pos];
+                            // note that if we have found a better
+                            // pickup, and that this pickup does
+                            // not have the same local traffic
+                            // zone, we may miss some interesting
+                            // solutions.
+                        } else if (l_zone != st_table.local_traffic_zones[st_pos]) {
+                            // if we can pick up in this vj with 2
+                            // different zones, we can drop off
+                            // anywhere (we'll chose later at
+                            // which stop we pickup)
+                            l_zone = std::numeric_limits<uint16_t>::max();
                         }
+                        workingDt = tmp_st_dt.second;
+                        base_dt = st_table.base_dt(st_pos, workingDt, visitor.clockwise());
+                        BOOST_ASSERT(!visitor.comp(workingDt, previous_dt));
                     }
                 }
-                if (is_onboard) {
-                    const type::VehicleJourney* vj_stay_in = visitor.get_extension_vj(it_st->vehicle_journey);
-                    if (vj_stay_in) {
-                        bool applied = apply_vj_extension(visitor, rt_level, vj_stay_in, l_zone, base_dt);
-                        continue_algorithm = continue_algorithm || applied;
-                    }
+            }
+            if (is_onboard) {
+                const type::VehicleJourney* vj_stay_in = visitor.get_extension_vj(it_st->vehicle_journey);
+                if (vj_stay_in) {
+                    bool applied = apply_vj_extension(visitor, rt_level, vj_stay_in, l_zone, base_dt);
+                    continue_algorithm = continue_algorithm || applied;
                 }
             }
-            q_elt.second = visitor.init_queue_item();
+            Q[jp_idx] = visitor.init_queue_item();
         }
+        round_counters.push_back({marked_jps.size(), marked_sps_pt.size()});
+        marked_jps.clear();
         continue_algorithm = continue_algorithm && this->foot_path(visitor);
     }
 }
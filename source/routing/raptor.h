@@ -41,6 +41,7 @@ www.navitia.io
 #include "routing.h"
 #include "routing/journey.h"
 #include "utils/timer.h"
+#include "utils/deadline.h"
 #include "boost/dynamic_bitset.hpp"
 #include "dataraptor.h"
 #include "raptor_utils.h"
@@ -86,6 +87,29 @@ struct RAPTOR {
     // set to store if the stop_point is valid
     boost::dynamic_bitset<> valid_stop_points;
 
+    /// Frontier of the current round: the journey patterns having an
+    /// order in Q, and the stop points whose pt (resp. transfer) label
+    /// has been improved during this round. Thanks to them, a round only
+    /// explores what has changed during the previous one.
+    std::vector<JpIdx> marked_jps;
+    std::vector<SpIdx> marked_sps_pt;
+    std::vector<SpIdx> marked_sps_transfer;
+
+    /// Size of the frontier at each round of the last raptor_loop, for profiling
+    struct RoundCounters {
+        size_t nb_marked_jps = 0;
+        size_t nb_marked_sps = 0;
+    };
+    std::vector<RoundCounters> round_counters;
+
+    /// Other workers used to compute the slices of a profile request in
+    /// parallel, created on demand and kept as long as this one
+    std::vector<std::unique_ptr<RAPTOR>> profile_workers;
+
+    /// Deadline of the request, checked at each round and before each
+    /// second pass so that an expired request stops early (none when null)
+    const navitia::Deadline* deadline = nullptr;
+
     explicit RAPTOR(const navitia::type::Data& data)
         : data(data),
           best_labels_pts(data.pt_data->stop_points),
@@ -106,6 +130,16 @@ struct RAPTOR {
               const bool clockwise,
               const type::Properties& properties);
 
+    /// Return the i-th profile worker, creating it if needed (not thread safe)
+    RAPTOR& get_profile_worker(const size_t i);
+
+    /// Throw navitia::DeadlineExpired if the deadline of the request has expired
+    void check_deadline() const {
+        if (deadline != nullptr) {
+            deadline->check();
+        }
+    }
+
     // pt_data object getters by typed idx
     const type::StopPoint* get_sp(SpIdx idx) const { return data.pt_data->stop_points[idx.val]; }
 
@@ -190,6 +224,9 @@ struct RAPTOR {
     /// Boucle principale, parcourt les journey_patterns,
     void boucleRAPTOR(const bool clockwise, const nt::RTLevel rt_level, const uint32_t max_transfers);
 
+    /// Mark the journey pattern to be explored from the given order
+    void mark_jp(const JpIdx jp_idx, const int order, const bool clockwise);
+
     /// Apply foot pathes to labels
     /// Return true if it improves at least one label, false otherwise
     template <typename Visitor>
@@ -226,5 +263,7 @@ struct RAPTOR {
     ~RAPTOR() = default;
 };
 
+std::ostream& operator<<(std::ostream& os, const std::vector<RAPTOR::RoundCounters>& counters);
+
 }  // namespace routing
 }  // namespace navitia
@@ -42,7 +42,10 @@ www.navitia.io
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/range/algorithm/count.hpp>
 #include <unordered_set>
+#include <atomic>
 #include <chrono>
+#include <future>
+#include <memory>
 #include <string>
 
 namespace navitia {
@@ -107,6 +110,12 @@ static boost::optional<DateTime> get_timeframe_limit(const DateTime request_date
     return limit;
 }
 
+// a slice of a profile query, computed by the first thread claiming it
+struct ProfileSlice {
+    std::atomic<bool> claimed{false};
+    std::promise<void> done;
+};
+
 /**
  * @brief internal function to call raptor in a loop
  */
@@ -129,7 +138,8 @@ static std::vector<Path> call_raptor(navitia::PbCreator& pb_creator,
                                      const size_t max_extra_second_pass,
                                      const double night_bus_filter_max_factor,
                                      const int32_t night_bus_filter_base_factor,
-                                     boost::optional<uint32_t> timeframe_duration) {
+                                     boost::optional<uint32_t> timeframe_duration,
+                                     ThreadPool* profile_pool) {
     log4cplus::Logger logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("logger"));
     std::vector<Path> pathes;
 
@@ -138,34 +148,17 @@ static std::vector<Path> call_raptor(navitia::PbCreator& pb_creator,
     // TODO: remove the vector (and adapt protobuf of request).
     DateTime bound = clockwise ? DateTimeUtils::inf : DateTimeUtils::min;
 
-    for (const auto& datetime : datetimes) {
-        // Compute start time and Bound
-        DateTime request_date_secs = to_datetime(datetime, raptor.data);
-
-        // timeframe_limit in raptor referential
-        boost::optional<DateTime> timeframe_limit =
-            get_timeframe_limit(request_date_secs, clockwise, timeframe_duration);
-
-        // Compute Bound
-        if (max_duration != DateTimeUtils::inf) {
-            if (clockwise) {
-                bound = request_date_secs + max_duration;
-            } else {
-                bound = request_date_secs > max_duration ? request_date_secs - max_duration : 0;
-            }
-        }
-
-        // Raptor Loop
-        JourneySet journeys;
+    // Raptor Loop: call raptor from start_date_secs until the limit or the
+    // min_nb_journeys is reached, and return the datetime of the next call.
+    // It only uses the given raptor worker so that it can be run by several threads.
+    auto raptor_loop = [&](RAPTOR& worker, DateTime start_date_secs, const boost::optional<uint32_t>& min_nb,
+                           const boost::optional<DateTime>& limit, JourneySet& journeys) {
         uint32_t nb_try = 0;
-        int total_nb_journeys = 0;
-
-        raptor.set_valid_jp_and_jpp(DateTimeUtils::date(request_date_secs), accessibilite_params, forbidden_uri,
-                                    allowed_ids, rt_level);
+        int total_nb_journeys = journeys.size() + nb_direct_path;
 
         do {
-            auto raptor_journeys = raptor.compute_all_journeys(
-                departures, destinations, request_date_secs, rt_level, transfer_penalty, bound, max_transfers,
+            auto raptor_journeys = worker.compute_all_journeys(
+                departures, destinations, start_date_secs, rt_level, transfer_penalty, bound, max_transfers,
                 accessibilite_params, clockwise, direct_path_duration, max_extra_second_pass);
 
             LOG4CPLUS_DEBUG(logger, "raptor found " << raptor_journeys.size() << " solutions");
@@ -174,7 +167,7 @@ static std::vector<Path> call_raptor(navitia::PbCreator& pb_creator,
             filter_direct_path(raptor_journeys);
 
             // filter joureys that are too late.....with the magic formula...
-            NightBusFilter::Params params{request_date_secs, clockwise, night_bus_filter_max_factor,
+            NightBusFilter::Params params{start_date_secs, clockwise, night_bus_filter_max_factor,
                                           night_bus_filter_base_factor};
             filter_late_journeys(raptor_journeys, params);
 
@@ -194,10 +187,114 @@ static std::vector<Path> call_raptor(navitia::PbCreator& pb_creator,
             total_nb_journeys = journeys.size() + nb_direct_path;
 
             // Prepare next call for raptor with min_nb_journeys option
-            request_date_secs = prepare_next_call_for_raptor(raptor_journeys, clockwise);
+            start_date_secs = prepare_next_call_for_raptor(raptor_journeys, clockwise);
+
+        } while (keep_going(total_nb_journeys, nb_try, clockwise, start_date_secs, min_nb, limit, max_transfers));
+
+        return start_date_secs;
+    };
 
-        } while (keep_going(total_nb_journeys, nb_try, clockwise, request_date_secs, min_nb_journeys, timeframe_limit,
-                            max_transfers));
+    for (const auto& datetime : datetimes) {
+        // Compute start time and Bound
+        DateTime request_date_secs = to_datetime(datetime, raptor.data);
+
+        // timeframe_limit in raptor referential
+        boost::optional<DateTime> timeframe_limit =
+            get_timeframe_limit(request_date_secs, clockwise, timeframe_duration);
+
+        // Compute Bound
+        if (max_duration != DateTimeUtils::inf) {
+            if (clockwise) {
+                bound = request_date_secs + max_duration;
+            } else {
+                bound = request_date_secs > max_duration ? request_date_secs - max_duration : 0;
+            }
+        }
+
+        JourneySet journeys;
+
+        raptor.set_valid_jp_and_jpp(DateTimeUtils::date(request_date_secs), accessibilite_params, forbidden_uri,
+                                    allowed_ids, rt_level);
+
+        const auto slices = timeframe_limit && profile_pool && profile_pool->size() > 0
+                                ? split_timeframe(request_date_secs, *timeframe_limit, clockwise,
+                                                  profile_pool->size() + 1)
+                                : std::vector<std::pair<DateTime, DateTime>>();
+
+        if (slices.size() > 1) {
+            // Profile query: every slice of the window is computed by its own
+            // raptor worker, the first one by this thread. The other ones are
+            // posted to the pool shared by the workers of kraken, and a slice is
+            // computed by the first thread claiming it: when the pool is busy
+            // with other requests, this thread computes them itself.
+            std::vector<JourneySet> slice_journeys(slices.size());
+            std::vector<DateTime> next_date_secs(slices.size(), request_date_secs);
+            std::vector<RAPTOR*> workers = {&raptor};
+            for (size_t i = 1; i < slices.size(); ++i) {
+                workers.push_back(&raptor.get_profile_worker(i - 1));
+            }
+            auto compute_slice = [&](size_t i) {
+                if (i > 0) {
+                    workers[i]->set_valid_jp_and_jpp(DateTimeUtils::date(request_date_secs), accessibilite_params,
+                                                     forbidden_uri, allowed_ids, rt_level);
+                }
+                next_date_secs[i] =
+                    raptor_loop(*workers[i], slices[i].first, boost::none, slices[i].second, slice_journeys[i]);
+            };
+            // shared with the tasks of the pool, which may start after the end of the request:
+            // they only touch the locals of the request once the slice is claimed
+            auto profile_slices = std::make_shared<std::vector<ProfileSlice>>(slices.size());
+            auto run_slice = [profile_slices, &compute_slice](size_t i) {
+                auto& slice = (*profile_slices)[i];
+                if (slice.claimed.exchange(true)) {
+                    return;
+                }
+                try {
+                    compute_slice(i);
+                    slice.done.set_value();
+                } catch (...) {
+                    slice.done.set_exception(std::current_exception());
+                }
+            };
+            std::vector<std::future<void>> futures;
+            for (auto& slice : *profile_slices) {
+                futures.push_back(slice.done.get_future());
+            }
+            for (size_t i = 1; i < slices.size(); ++i) {
+                profile_pool->post([run_slice, i]() { run_slice(i); });
+            }
+            for (size_t i = 0; i < slices.size(); ++i) {
+                run_slice(i);
+            }
+            // every slice must be done before an error is thrown, the pool still uses the locals otherwise
+            for (auto& future : futures) {
+                future.wait();
+            }
+            for (auto& future : futures) {
+                future.get();
+            }
+
+            // the next call starts after the last journey found on the window
+            for (size_t i = 0; i < slices.size(); ++i) {
+                if (slice_journeys[i].empty()) {
+                    continue;
+                }
+                journeys.insert(slice_journeys[i].begin(), slice_journeys[i].end());
+                request_date_secs = clockwise ? std::max(request_date_secs, next_date_secs[i])
+                                              : std::min(request_date_secs, next_date_secs[i]);
+            }
+            filter_dominated_in_timeframe(journeys);
+
+            LOG4CPLUS_DEBUG(logger, "profile on " << slices.size() << " slices found " << journeys.size()
+                                                  << " non dominated journey(s)");
+
+            // the window is done, we go on after it if we still don't have enough journeys
+            if (min_nb_journeys && journeys.size() + nb_direct_path < *min_nb_journeys) {
+                request_date_secs = raptor_loop(raptor, request_date_secs, min_nb_journeys, boost::none, journeys);
+            }
+        } else {
+            request_date_secs = raptor_loop(raptor, request_date_secs, min_nb_journeys, timeframe_limit, journeys);
+        }
 
         // create date time for next
         if (request_date_secs != to_datetime(datetime, raptor.data)) {
@@ -514,6 +611,7 @@ static bt::ptime get_base_dt(const nt::StopTime* st_orig,
 static bt::ptime handle_pt_sections(pbnavitia::Journey* pb_journey,
                                     PbCreator& pb_creator,
                                     const navitia::routing::Path& path,
+                                    const fare::results& fare,
                                     const uint32_t depth) {
     log4cplus::Logger logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("logger"));
     pb_journey->set_nb_transfers(path.nb_changes);
@@ -705,8 +803,7 @@ static bt::ptime handle_pt_sections(pbnavitia::Journey* pb_journey,
 
     compute_most_serious_disruption(pb_journey, pb_creator);
 
-    // fare computation, done at the end for the journey to be complete
-    auto fare = pb_creator.data->fare->compute_fare(path);
+    // fare filling, done at the end for the journey to be complete
     try {
         pb_creator.fill_fare_section(pb_journey, fare);
     } catch (const navitia::exception& e) {
@@ -743,7 +840,10 @@ void make_pathes(PbCreator& pb_creator,
 
     log4cplus::Logger logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("logger"));
 
-    for (const Path& path : paths) {
+    // all the journeys are priced at once
+    const auto fares = pb_creator.data->fare->compute_fares(paths);
+    for (size_t path_idx = 0; path_idx < paths.size(); ++path_idx) {
+        const Path& path = paths[path_idx];
         bt::ptime arrival_time = bt::pos_infin;
         if (path.items.empty()) {
             continue;
@@ -824,7 +924,7 @@ void make_pathes(PbCreator& pb_creator,
                 }
             }
         }
-        arrival_time = handle_pt_sections(pb_journey, pb_creator, path, depth);
+        arrival_time = handle_pt_sections(pb_journey, pb_creator, path, fares[path_idx], depth);
         // for 'taxi like' odt, we want to start from the address, not the 1 stop point
         if (journey_begin_with_address_odt) {
             auto* section = pb_journey->mutable_sections(0);
@@ -908,14 +1008,16 @@ static void add_pt_pathes(PbCreator& pb_creator,
                           const std::vector<navitia::routing::Path>& paths,
                           const uint32_t depth) {
     log4cplus::Logger logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("logger"));
-    for (const Path& path : paths) {
+    const auto fares = pb_creator.data->fare->compute_fares(paths);
+    for (size_t path_idx = 0; path_idx < paths.size(); ++path_idx) {
+        const Path& path = paths[path_idx];
         // TODO: what do we want to do in this case?
         if (path.items.empty()) {
             continue;
         }
         bt::ptime departure_time = path.items.front().departures.front();
         pbnavitia::Journey* pb_journey = pb_creator.add_journeys();
-        bt::ptime arrival_time = handle_pt_sections(pb_journey, pb_creator, path, depth);
+        bt::ptime arrival_time = handle_pt_sections(pb_journey, pb_creator, path, fares[path_idx], depth);
 
         pb_journey->set_departure_date_time(navitia::to_posix_timestamp(departure_time));
         pb_journey->set_arrival_date_time(navitia::to_posix_timestamp(arrival_time));
@@ -1076,8 +1178,8 @@ boost::optional<routing::map_stop_point_duration> get_stop_points(const type::En
             }
             const auto admin = data.geo_ref->admins[it_admin->second];
 
-            for (auto stop_area : admin->main_stop_areas) {
-                for (auto stop_point : stop_area->stop_point_list) {
+            for (auto sa_idx : admin->main_stop_areas) {
+                for (auto stop_point : data.pt_data->stop_areas[sa_idx]->stop_point_list) {
                     add_free_stop_point(stop_point, concerned_path_finder, result);
                 }
             }
@@ -1095,8 +1197,8 @@ boost::optional<routing::map_stop_point_duration> get_stop_points(const type::En
     // we need to check if the admin has zone odt
     const auto& admins = find_admins(ep, data);
     for (const auto* admin : admins) {
-        for (const auto* odt_admin_stop_point : admin->odt_stop_points) {
-            add_free_stop_point(odt_admin_stop_point, concerned_path_finder, result);
+        for (const auto odt_admin_stop_point : admin->odt_stop_points) {
+            add_free_stop_point(data.pt_data->stop_points[odt_admin_stop_point], concerned_path_finder, result);
         }
     }
 
@@ -1192,6 +1294,54 @@ DateTime prepare_next_call_for_raptor(const RAPTOR::Journeys& journeys, const bo
     return clockwise ? earliest_departure : lastest_arrival;
 }
 
+std::vector<std::pair<DateTime, DateTime>> split_timeframe(const DateTime request_date_secs,
+                                                           const DateTime timeframe_limit,
+                                                           const bool clockwise,
+                                                           const size_t nb_slices) {
+    DateTime length = 0;
+    if (clockwise && timeframe_limit > request_date_secs) {
+        length = timeframe_limit - request_date_secs;
+    } else if (!clockwise && request_date_secs > timeframe_limit) {
+        length = request_date_secs - timeframe_limit;
+    }
+    const size_t nb = std::max<size_t>(1, std::min<size_t>(nb_slices, length));
+
+    std::vector<std::pair<DateTime, DateTime>> slices;
+    DateTime start = request_date_secs;
+    for (size_t i = 1; i <= nb; ++i) {
+        const auto offset = DateTime(uint64_t(length) * i / nb);
+        const DateTime limit = clockwise ? request_date_secs + offset : request_date_secs - offset;
+        slices.emplace_back(start, limit);
+        start = limit;
+    }
+    return slices;
+}
+
+static bool dominates_in_timeframe(const Journey& j1, const Journey& j2) {
+    const bool not_worse = j1.departure_dt >= j2.departure_dt && j1.arrival_dt <= j2.arrival_dt
+                           && j1.sections.size() <= j2.sections.size() && j1.sn_dur <= j2.sn_dur;
+    const bool better = j1.departure_dt > j2.departure_dt || j1.arrival_dt < j2.arrival_dt
+                        || j1.sections.size() < j2.sections.size() || j1.sn_dur < j2.sn_dur;
+    return not_worse && better;
+}
+
+void filter_dominated_in_timeframe(JourneySet& journeys) {
+    std::vector<JourneySet::const_iterator> dominated;
+    for (auto it = journeys.cbegin(); it != journeys.cend(); ++it) {
+        for (const auto& other : journeys) {
+            if (dominates_in_timeframe(other, *it)) {
+                dominated.push_back(it);
+                break;
+            }
+        }
+    }
+    // the dominance is transitive, so removing them all at the end is the same
+    // as removing them one by one
+    for (const auto& it : dominated) {
+        journeys.erase(it);
+    }
+}
+
 static std::vector<bt::ptime> parse_datetimes(const RAPTOR& raptor,
                                               const std::vector<uint64_t>& timestamps,
                                               navitia::PbCreator& pb_creator,
@@ -1233,7 +1383,8 @@ void make_pt_response(navitia::PbCreator& pb_creator,
                       const double night_bus_filter_max_factor,
                       const int32_t night_bus_filter_base_factor,
                       const boost::optional<DateTime>& timeframe_duration,
-                      const uint32_t depth) {
+                      const uint32_t depth,
+                      ThreadPool* profile_pool) {
     log4cplus::Logger logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("logger"));
 
     // Create datetime
@@ -1252,7 +1403,7 @@ void make_pt_response(navitia::PbCreator& pb_creator,
                     accessibilite_params, forbidden, allowed, clockwise, direct_path_duration, min_nb_journeys,
                     // nb_direct_path = 0 for distributed if direct_path_duration is none
                     direct_path_duration ? 1 : 0, max_duration, max_transfers, max_extra_second_pass,
-                    night_bus_filter_max_factor, night_bus_filter_base_factor, timeframe_duration);
+                    night_bus_filter_max_factor, night_bus_filter_base_factor, timeframe_duration, profile_pool);
 
     // Create pb response
     make_pt_pathes(pb_creator, pathes, depth);
@@ -1345,7 +1496,8 @@ void make_response(navitia::PbCreator& pb_creator,
                    const double night_bus_filter_max_factor,
                    const int32_t night_bus_filter_base_factor,
                    const boost::optional<uint32_t>& timeframe_duration,
-                   const uint32_t depth) {
+                   const uint32_t depth,
+                   ThreadPool* profile_pool) {
     log4cplus::Logger logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("logger"));
 
     // Create datetime
@@ -1408,7 +1560,8 @@ void make_response(navitia::PbCreator& pb_creator,
     const auto pathes = call_raptor(
         pb_creator, raptor, *departures, *destinations, datetimes, rt_level, transfer_penalty, accessibilite_params,
         forbidden, allowed, clockwise, direct_path_dur, min_nb_journeys, nb_direct_path, max_duration, max_transfers,
-        max_extra_second_pass, night_bus_filter_max_factor, night_bus_filter_base_factor, timeframe_duration);
+        max_extra_second_pass, night_bus_filter_max_factor, night_bus_filter_base_factor, timeframe_duration,
+        profile_pool);
 
     // Create pb response
     make_pathes(pb_creator, pathes, worker, direct_path, origin, destination, datetimes, clockwise, free_radius_from,
@@ -1592,7 +1745,10 @@ void make_graphical_isochrone(navitia::PbCreator& pb_creator,
                               const nt::RTLevel rt_level,
                               georef::StreetNetwork& worker,
                               const double& speed,
-                              const boost::optional<const type::EntryPoints&>& stop_points) {
+                              const boost::optional<const type::EntryPoints&>& stop_points,
+                              const navitia::type::Mode_e mode,
+                              const uint32_t resolution,
+                              const size_t nb_threads) {
     const auto isochrone_common = make_isochrone_common(raptor, center, departure_datetime, boundary_duration[0],
                                                         max_transfers, accessibilite_params, forbidden, allowed,
                                                         clockwise, rt_level, worker, pb_creator, stop_points);
@@ -1601,9 +1757,16 @@ void make_graphical_isochrone(navitia::PbCreator& pb_creator,
         return;
     }
 
-    std::vector<Isochrone> isochrone =
-        build_isochrones(raptor, isochrone_common->clockwise, isochrone_common->coord_origin,
-                         isochrone_common->departures, speed, boundary_duration, isochrone_common->init_dt);
+    std::vector<Isochrone> isochrone;
+    if (resolution > 0 && worker.geo_ref.nb_vertex_by_mode > 0) {
+        // the bands follow the street network instead of circles around the stop points
+        isochrone = build_street_network_isochrones(worker.geo_ref, speed, mode, isochrone_common->init_dt, raptor,
+                                                    isochrone_common->coord_origin, boundary_duration, clockwise,
+                                                    isochrone_common->bound, resolution, nb_threads);
+    } else {
+        isochrone = build_isochrones(raptor, isochrone_common->clockwise, isochrone_common->coord_origin,
+                                     isochrone_common->departures, speed, boundary_duration, isochrone_common->init_dt);
+    }
     for (const auto& iso : isochrone) {
         auto min_date_time = make_isochrone_date(isochrone_common->init_dt, iso.min_duration, clockwise);
         auto max_date_time = make_isochrone_date(isochrone_common->init_dt, iso.max_duration, clockwise);
@@ -1627,7 +1790,20 @@ void make_heat_map(navitia::PbCreator& pb_creator,
                    const double& end_speed,
                    const navitia::type::Mode_e end_mode,
                    const uint32_t resolution,
-                   const boost::optional<const type::EntryPoints&>& stop_points) {
+                   const boost::optional<const type::EntryPoints&>& stop_points,
+                   const size_t nb_threads,
+                   HeatMapCache* cache,
+                   const std::string& cache_key) {
+    // the raptor and the street network do not depend on the resolution, they are
+    // reused when the request only differs from the previous one by its resolution
+    if (cache && !cache_key.empty() && cache->key == cache_key) {
+        const auto heat_map =
+            build_grid(worker.geo_ref, cache->heat_map_distances, end_speed, max_duration, resolution, nb_threads,
+                       raptor.deadline);
+        add_heat_map(heat_map, pb_creator, center, clockwise, cache->datetime);
+        return;
+    }
+
     const auto isochrone_common =
         make_isochrone_common(raptor, center, departure_datetime, max_duration, max_transfers, accessibilite_params,
                               forbidden, allowed, clockwise, rt_level, worker, pb_creator, stop_points);
@@ -1642,10 +1818,17 @@ void make_heat_map(navitia::PbCreator& pb_creator,
         return;
     }
 
-    auto heat_map = build_raster_isochrone(worker.geo_ref, end_speed, end_mode, isochrone_common->init_dt, raptor,
-                                           isochrone_common->coord_origin, max_duration, clockwise,
-                                           isochrone_common->bound, resolution);
+    auto heat_map_distances =
+        compute_heat_map_distances(worker.geo_ref, end_speed, end_mode, isochrone_common->init_dt, raptor,
+                                   isochrone_common->coord_origin, max_duration, clockwise, isochrone_common->bound);
+    auto heat_map = build_grid(worker.geo_ref, heat_map_distances, end_speed, max_duration, resolution, nb_threads,
+                               raptor.deadline);
     add_heat_map(heat_map, pb_creator, center, clockwise, isochrone_common->datetime);
+    if (cache && !cache_key.empty()) {
+        cache->key = cache_key;
+        cache->datetime = isochrone_common->datetime;
+        cache->heat_map_distances = std::move(heat_map_distances);
+    }
 }
 
 }  // namespace routing
@@ -55,6 +55,8 @@ namespace navitia {
 namespace routing {
 
 struct RAPTOR;
+struct HeatMapCache;
+class ThreadPool;
 
 struct NightBusFilter {
     static constexpr double default_max_factor = 3;
@@ -77,6 +79,12 @@ void add_direct_path(PbCreator& pb_creator,
 
 /**
  * @brief Used for classic Pt request
+ *
+ * When a profile_pool with threads and a timeframe_duration are given, the
+ * window is computed as a profile query: it is split in profile_pool->size() + 1
+ * slices computed by the pool and this thread, and only the Pareto set of the
+ * journeys found on it is kept (filter_dominated_in_timeframe). Without it,
+ * every journey found on the window is returned.
  */
 void make_response(navitia::PbCreator& pb_creator,
                    RAPTOR& raptor,
@@ -99,7 +107,8 @@ void make_response(navitia::PbCreator& pb_creator,
                    const double night_bus_filter_max_factor = NightBusFilter::default_max_factor,
                    const int32_t night_bus_filter_base_factor = NightBusFilter::default_base_factor,
                    const boost::optional<uint32_t>& timeframe_duration = boost::none,
-                   const uint32_t depth = 1);
+                   const uint32_t depth = 1,
+                   ThreadPool* profile_pool = nullptr);
 
 void make_isochrone(navitia::PbCreator& pb_creator,
                     RAPTOR& raptor,
@@ -117,6 +126,12 @@ void make_isochrone(navitia::PbCreator& pb_creator,
 
 /**
  * @brief Used for Pt with distributed mode
+ *
+ * When a profile_pool with threads and a timeframe_duration are given, the
+ * window is computed as a profile query: it is split in profile_pool->size() + 1
+ * slices computed by the pool and this thread, and only the Pareto set of the
+ * journeys found on it is kept (filter_dominated_in_timeframe). Without it,
+ * every journey found on the window is returned.
  */
 void make_pt_response(navitia::PbCreator& pb_creator,
                       RAPTOR& raptor,
@@ -137,7 +152,8 @@ void make_pt_response(navitia::PbCreator& pb_creator,
                       const double night_bus_filter_max_factor = NightBusFilter::default_max_factor,
                       const int32_t night_bus_filter_base_factor = NightBusFilter::default_base_factor,
                       const boost::optional<uint32_t>& timeframe_duration = boost::none,
-                      const uint32_t depth = 1);
+                      const uint32_t depth = 1,
+                      ThreadPool* profile_pool = nullptr);
 
 boost::optional<routing::map_stop_point_duration> get_stop_points(const type::EntryPoint& ep,
                                                                   const type::Data& data,
@@ -191,6 +207,32 @@ void filter_late_journeys(RAPTOR::Journeys& journeys, const NightBusFilter::Para
  */
 DateTime prepare_next_call_for_raptor(const RAPTOR::Journeys& journeys, const bool clockwise);
 
+/**
+ * @brief Split the departure window of a profile request in consecutive slices
+ *
+ * Each slice is a (start, limit) pair in raptor referential, the limit of a
+ * slice being the start of the next one. There is at most one slice per second.
+ *
+ * @param request_date_secs The requested datetime, start of the window
+ * @param timeframe_limit The end of the window
+ * @param clockwise Leave after or Arrive before
+ * @param nb_slices The wanted number of slices
+ */
+std::vector<std::pair<DateTime, DateTime>> split_timeframe(const DateTime request_date_secs,
+                                                           const DateTime timeframe_limit,
+                                                           const bool clockwise,
+                                                           const size_t nb_slices);
+
+/**
+ * @brief Keep only the Pareto set of the journeys found on a departure window
+ *
+ * A journey is dominated if another one leaves later, arrives sooner, with
+ * less sections and less street network, one of them being strictly better.
+ *
+ * @param journeys The journeys found on the whole window
+ */
+void filter_dominated_in_timeframe(JourneySet& journeys);
+
 void make_graphical_isochrone(navitia::PbCreator& pb_creator,
                               RAPTOR& raptor_max,
                               const type::EntryPoint& center,
@@ -204,7 +246,10 @@ void make_graphical_isochrone(navitia::PbCreator& pb_creator,
                               const nt::RTLevel rt_level,
                               georef::StreetNetwork& worker,
                               const double& speed,
-                              const boost::optional<const type::EntryPoints&>& stop_points = boost::none);
+                              const boost::optional<const type::EntryPoints&>& stop_points = boost::none,
+                              const navitia::type::Mode_e mode = navitia::type::Mode_e::Walking,
+                              const uint32_t resolution = 0,
+                              const size_t nb_threads = 1);
 
 void make_heat_map(navitia::PbCreator& pb_creator,
                    RAPTOR& raptor,
@@ -221,7 +266,10 @@ void make_heat_map(navitia::PbCreator& pb_creator,
                    const double& speed,
                    const navitia::type::Mode_e mode,
                    const uint32_t resolution,
-                   const boost::optional<const type::EntryPoints&>& stop_points = boost::none);
+                   const boost::optional<const type::EntryPoints&>& stop_points = boost::none,
+                   const size_t nb_threads = 1,
+                   HeatMapCache* cache = nullptr,
+                   const std::string& cache_key = "");
 
 void make_pathes(PbCreator& pb_creator,
                  const std::vector<navitia::routing::Path>& paths,
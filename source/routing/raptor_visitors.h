@@ -13,6 +13,15 @@ struct raptor_visitor {
     inline bool better_or_equal(const DateTime& a, const DateTime& current_dt, const type::StopTime& st) const {
         return a <= st.section_end(current_dt, !clockwise());
     }
+    inline bool better_or_equal(const DateTime& a,
+                                const DateTime& current_dt,
+                                const dataRAPTOR::StopTimeTable& st_table,
+                                const uint32_t st_pos) const {
+        return a <= st_table.section_end(st_pos, current_dt, !clockwise());
+    }
+
+    // position in dataRAPTOR::st_table of the next stop time of the vj
+    inline uint32_t next_st_pos(const uint32_t st_pos) const { return st_pos + 1; }
 
     inline boost::iterator_range<std::vector<dataRAPTOR::JppsFromJp::Jpp>::const_iterator>
     jpps_from_order(const dataRAPTOR::JppsFromJp& jpps_from_jp, JpIdx jp_idx, uint16_t jpp_order) const {
@@ -68,6 +77,15 @@ struct raptor_reverse_visitor {
     inline bool better_or_equal(const DateTime& a, const DateTime& current_dt, const type::StopTime& st) const {
         return a >= st.section_end(current_dt, !clockwise());
     }
+    inline bool better_or_equal(const DateTime& a,
+                                const DateTime& current_dt,
+                                const dataRAPTOR::StopTimeTable& st_table,
+                                const uint32_t st_pos) const {
+        return a >= st_table.section_end(st_pos, current_dt, !clockwise());
+    }
+
+    // position in dataRAPTOR::st_table of the previous stop time of the vj
+    inline uint32_t next_st_pos(const uint32_t st_pos) const { return st_pos - 1; }
 
     inline boost::iterator_range<std::vector<dataRAPTOR::JppsFromJp::Jpp>::const_reverse_iterator>
     jpps_from_order(const dataRAPTOR::JppsFromJp& jpps_from_jp, JpIdx jp_idx, uint16_t jpp_order) const {
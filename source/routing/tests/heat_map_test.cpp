@@ -38,6 +38,8 @@ www.navitia.io
 #include "routing/routing.h"
 #include "tests/utils_test.h"
 #include "routing/heat_map.h"
+#include "routing/raptor_api.h"
+#include "type/pb_converter.h"
 #include "utils/init.h"
 #include "routing/tests/routing_api_test_data.h"
 #include "utils/logger.h"
@@ -92,6 +94,57 @@ BOOST_AUTO_TEST_CASE(print_map_test) {
     BOOST_CHECK(heat_map_string == print_grid(heat_map));
 }
 
+BOOST_AUTO_TEST_CASE(trace_cells_test) {
+    /*
+     * lat    4     5      6
+     * lon
+     *  1    0min  1min  2min
+     *  2    3min  4min  5min
+     *  3    6min  7min  infini
+     *
+     */
+    std::vector<SingleCoord> header;
+    std::vector<std::pair<SingleCoord, std::vector<navitia::time_duration>>> body;
+    int length = 3;
+    for (int i = 0; i < length; i++) {
+        header.push_back((SingleCoord(i + length + 1, 1)));
+        std::vector<navitia::time_duration> local_duration;
+        for (int j = 0; j < length; j++) {
+            local_duration.push_back(navitia::minutes(j + i * length));
+        }
+        body.push_back(std::make_pair(SingleCoord(i, 1), local_duration));
+    }
+    auto heat_map = HeatMap(header, body);
+    heat_map.body[2].second[2] = bt::pos_infin;
+
+    auto shape = trace_cells(heat_map, 0, 8 * 60);
+    BOOST_REQUIRE_EQUAL(shape.size(), 1);
+    BOOST_CHECK_CLOSE(boost::geometry::area(shape), 8, 1e-6);
+    BOOST_CHECK(shape.front().inners().empty());
+    // the corners of an L shape, the ring being closed
+    BOOST_CHECK_EQUAL(shape.front().outer().size(), 7);
+
+    shape = trace_cells(heat_map, 4 * 60, 8 * 60);
+    BOOST_REQUIRE_EQUAL(shape.size(), 1);
+    BOOST_CHECK_CLOSE(boost::geometry::area(shape), 4, 1e-6);
+
+    // the cells only sharing a corner are different polygons
+    shape = trace_cells(heat_map, 2 * 60, 5 * 60);
+    BOOST_CHECK_EQUAL(shape.size(), 2);
+    BOOST_CHECK_CLOSE(boost::geometry::area(shape), 3, 1e-6);
+
+    // a hole in the middle
+    heat_map.body[1].second[1] = bt::pos_infin;
+    shape = trace_cells(heat_map, 0, 8 * 60);
+    BOOST_REQUIRE_EQUAL(shape.size(), 1);
+    BOOST_CHECK_EQUAL(shape.front().inners().size(), 1);
+    BOOST_CHECK_CLOSE(boost::geometry::area(shape), 7, 1e-6);
+    BOOST_CHECK(boost::geometry::within(navitia::type::GeographicalCoord(0.5, 4.5), shape));
+    BOOST_CHECK(!boost::geometry::within(navitia::type::GeographicalCoord(1.5, 5.5), shape));
+
+    BOOST_CHECK(trace_cells(heat_map, 10 * 60, 20 * 60).empty());
+}
+
 BOOST_AUTO_TEST_CASE(heat_map_test) {
     /*
      *
@@ -210,4 +263,83 @@ BOOST_AUTO_TEST_CASE(heat_map_test) {
     for (size_t i = 3; i < result.size(); i++) {
         BOOST_CHECK(result[i].is_pos_infinity());
     }
+
+    // the cells filled in parallel are the same
+    for (size_t grid_step : {step, size_t(20)}) {
+        const auto grid_height_step = (A.lat() - D.lat()) / grid_step;
+        const auto grid_width_step = (D.lon() - A.lon()) / grid_step;
+        const auto reference = fill_heat_map(box, grid_height_step, grid_width_step, *b.data->geo_ref, min_dist,
+                                             max_duration, speed, distances, grid_step);
+        for (size_t nb_threads : {2, 3, 8}) {
+            const auto parallel = fill_heat_map(box, grid_height_step, grid_width_step, *b.data->geo_ref, min_dist,
+                                                max_duration, speed, distances, grid_step, nb_threads);
+            BOOST_CHECK_EQUAL(print_grid(parallel), print_grid(reference));
+        }
+    }
+
+    // the street network part can be reused for another resolution
+    const auto heat_map_distances =
+        compute_heat_map_distances(*b.data->geo_ref, speed, mode, init_dt, raptor, A, max_duration, true, bound);
+    BOOST_CHECK_EQUAL(build_grid(*b.data->geo_ref, heat_map_distances, speed, max_duration, resolution), isochrone);
+    BOOST_CHECK_EQUAL(build_grid(*b.data->geo_ref, heat_map_distances, speed, max_duration, 50, 4),
+                      build_raster_isochrone(*b.data->geo_ref, speed, mode, init_dt, raptor, A, max_duration, true,
+                                             bound, 50));
+
+    // the bands of a graphical isochrone traced on the grid do not overlap
+    const auto isochrones = build_street_network_isochrones(*b.data->geo_ref, speed, mode, init_dt, raptor, A,
+                                                            {max_duration, 1800, 0}, true, bound, resolution);
+    BOOST_REQUIRE_EQUAL(isochrones.size(), 2);
+    BOOST_CHECK_EQUAL(isochrones[0].min_duration, 0);
+    BOOST_CHECK_EQUAL(isochrones[0].max_duration, 1800);
+    BOOST_CHECK_EQUAL(isochrones[1].min_duration, 1800);
+    BOOST_CHECK(!isochrones[0].shape.empty());
+    navitia::type::MultiPolygon intersection;
+    boost::geometry::intersection(isochrones[0].shape, isochrones[1].shape, intersection);
+    BOOST_CHECK_SMALL(boost::geometry::area(intersection), 1e-12);
+}
+
+// a request only differing from the previous one by its resolution reuses its street network part
+BOOST_AUTO_TEST_CASE(make_heat_map_cache_test) {
+    routing_api_data<normal_speed_provider> data;
+    auto center = data.origin;
+    center.streetnetwork_params.mode = navitia::type::Mode_e::Walking;
+    center.streetnetwork_params.offset = 0;
+    center.streetnetwork_params.max_duration = navitia::seconds(30 * 60);
+    center.streetnetwork_params.speed_factor = 1;
+
+    const auto& geo_ref = *data.b.data->geo_ref;
+    RAPTOR raptor(*data.b.data);
+    navitia::georef::StreetNetwork sn_worker(geo_ref);
+    auto* data_ptr = data.b.data.get();
+    const double speed = navitia::georef::default_speed[navitia::type::Mode_e::Walking];
+    auto heat_map = [&](const uint32_t resolution, HeatMapCache* cache) {
+        navitia::PbCreator pb_creator(data_ptr, boost::gregorian::not_a_date_time, null_time_period);
+        make_heat_map(pb_creator, raptor, center, data.datetimes.front(), 2 * 60 * 60, 10, {}, {}, {}, true,
+                      navitia::type::RTLevel::Base, sn_worker, speed, navitia::type::Mode_e::Walking, resolution,
+                      boost::none, 1, cache, "request");
+        const auto resp = pb_creator.get_response();
+        BOOST_REQUIRE_EQUAL(resp.heat_maps_size(), 1);
+        return resp.heat_maps(0).heat_matrix();
+    };
+
+    HeatMapCache cache;
+    const auto first = heat_map(100, &cache);
+    BOOST_CHECK_EQUAL(cache.key, "request");
+    BOOST_CHECK_EQUAL(first, heat_map(100, nullptr));
+
+    // only the edges of the box are kept
+    const auto& cached = cache.heat_map_distances;
+    BOOST_REQUIRE(!cached.edges.empty());
+    BOOST_CHECK_LT(cached.edges.size(), boost::num_edges(geo_ref.graph));
+    for (const auto& edge : cached.edges) {
+        BOOST_CHECK(cached.box.contains(geo_ref.graph[edge.source].coord));
+    }
+
+    // the cached street network gives the same grid as a new computation
+    const auto reference = heat_map(50, nullptr);
+    BOOST_CHECK_EQUAL(heat_map(50, &cache), reference);
+
+    // the grid is only built from the cache: without its edges, no cell is reached
+    cache.heat_map_distances.edges.clear();
+    BOOST_CHECK_NE(heat_map(50, &cache), reference);
 }
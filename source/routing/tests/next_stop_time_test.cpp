@@ -2593,3 +2593,80 @@ BOOST_AUTO_TEST_CASE(freq_next_stop_time_with_distant_bounds) {
         BOOST_CHECK_EQUAL(st->stop_point->stop_area->name, spa2);
     }
 }
+
+/*
+ * The RT levels and the accessibilities of a day share the same
+ * cached stop times, only filtered at lookup
+ *
+ * VJ 1 (not accessible): sp1 8000 -> sp2 8100
+ * VJ 2 (accessible):     sp1 9000 -> sp2 9100
+ */
+BOOST_AUTO_TEST_CASE(cached_next_stop_time_shared_between_variants) {
+    ed::builder b("20120614");
+    b.vj("A", "11", "", false)("stop1", 8000, 8000)("stop2", 8100, 8100);
+    b.vj("A", "11", "", true)("stop1", 9000, 9000)("stop2", 9100, 9100);
+    b.finish();
+    b.data->pt_data->sort_and_index();
+    b.data->build_uri();
+    b.data->build_raptor();
+
+    auto& manager = *b.data->dataRaptor->cached_next_st_manager;
+    const auto jpp1 = get_first_jpp_idx(b, "stop1");
+    type::AccessibiliteParams no_params;
+    type::AccessibiliteParams wheelchair;
+    wheelchair.vehicle_properties.set(type::hasVehicleProperties::WHEELCHAIR_ACCESSIBLE, true);
+    const DateTime dt = DateTimeUtils::set(0, 8500);
+
+    auto res = manager.load(dt, type::RTLevel::Base, no_params)->next_stop_time(StopEvent::pick_up, jpp1, dt, true);
+    BOOST_REQUIRE(res.first != nullptr);
+    BOOST_CHECK_EQUAL(res.second, DateTimeUtils::set(0, 9000));
+
+    res = manager.load(dt, type::RTLevel::Base, no_params)->next_stop_time(StopEvent::pick_up, jpp1, dt, false);
+    BOOST_REQUIRE(res.first != nullptr);
+    BOOST_CHECK_EQUAL(res.second, DateTimeUtils::set(0, 8000));
+
+    // the not accessible vj is skipped
+    res = manager.load(dt, type::RTLevel::Base, wheelchair)->next_stop_time(StopEvent::pick_up, jpp1, dt, false);
+    BOOST_CHECK(res.first == nullptr);
+    const DateTime dt_before = DateTimeUtils::set(0, 7000);
+    res = manager.load(dt, type::RTLevel::Base, wheelchair)
+              ->next_stop_time(StopEvent::pick_up, jpp1, dt_before, true);
+    BOOST_REQUIRE(res.first != nullptr);
+    BOOST_CHECK_EQUAL(res.second, DateTimeUtils::set(0, 9000));
+    res = manager.load(dt, type::RTLevel::Base, wheelchair)
+              ->next_stop_time(StopEvent::drop_off, get_first_jpp_idx(b, "stop2"), DateTimeUtils::set(0, 9050), false);
+    BOOST_CHECK(res.first == nullptr);
+
+    const DateTime dt_next_day = DateTimeUtils::set(1, 7000);
+    res = manager.load(dt, type::RTLevel::RealTime, wheelchair)
+              ->next_stop_time(StopEvent::pick_up, jpp1, dt_next_day, true);
+    BOOST_REQUIRE(res.first != nullptr);
+    BOOST_CHECK_EQUAL(res.second, DateTimeUtils::set(1, 9000));
+
+    // only one build for every variant of the day
+    const auto stats = manager.get_stats();
+    BOOST_CHECK_EQUAL(stats.nb_calls, 6);
+    BOOST_CHECK_EQUAL(stats.nb_cache_miss, 1);
+    BOOST_CHECK_EQUAL(stats.nb_evictions, 0);
+}
+
+BOOST_AUTO_TEST_CASE(cached_next_stop_time_prebuild) {
+    ed::builder b("20120614");
+    b.vj("A", "11", "", true)("stop1", 8000, 8000)("stop2", 8100, 8100);
+    b.finish();
+    b.data->pt_data->sort_and_index();
+    b.data->build_uri();
+    b.data->build_raptor();
+
+    auto& manager = *b.data->dataRaptor->cached_next_st_manager;
+    manager.prebuild(DateTimeUtils::set(1, 0));
+    BOOST_CHECK_EQUAL(manager.get_stats().nb_cache_miss, 1);
+
+    // the prebuilt cache is used by the requests of the day
+    const DateTime dt = DateTimeUtils::set(1, 7000);
+    const auto res = manager.load(dt, type::RTLevel::Base, type::AccessibiliteParams())
+                         ->next_stop_time(StopEvent::pick_up, get_first_jpp_idx(b, "stop1"), dt, true);
+    BOOST_REQUIRE(res.first != nullptr);
+    BOOST_CHECK_EQUAL(res.second, DateTimeUtils::set(1, 8000));
+    BOOST_CHECK_EQUAL(manager.get_stats().nb_cache_miss, 1);
+}
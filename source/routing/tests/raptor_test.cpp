@@ -111,6 +111,28 @@ BOOST_AUTO_TEST_CASE(direct) {
     BOOST_REQUIRE_EQUAL(res1.size(), 0);
 }
 
+BOOST_AUTO_TEST_CASE(deadline_expired) {
+    ed::builder b("20120614");
+    b.vj("A")("stop1", 8000, 8050)("stop2", 8100, 8150);
+    b.data->pt_data->sort_and_index();
+    b.finish();
+    b.data->build_raptor();
+    RAPTOR raptor(*b.data);
+
+    navitia::Deadline deadline;
+    deadline.set(boost::posix_time::from_iso_string("20000101T000000"));
+    raptor.deadline = &deadline;
+    BOOST_CHECK_THROW(raptor.compute(b.data->pt_data->stop_areas[0], b.data->pt_data->stop_areas[1], 7900, 0,
+                                     DateTimeUtils::inf, type::RTLevel::Base, 2_min, true),
+                      navitia::DeadlineExpired);
+
+    // the same search goes to the end without deadline
+    raptor.deadline = nullptr;
+    const auto res = raptor.compute(b.data->pt_data->stop_areas[0], b.data->pt_data->stop_areas[1], 7900, 0,
+                                    DateTimeUtils::inf, type::RTLevel::Base, 2_min, true);
+    BOOST_CHECK_EQUAL(res.size(), 1);
+}
+
 BOOST_AUTO_TEST_CASE(change) {
     ed::builder b("20120614");
     b.vj("A")("stop1", 8000, 8050)("stop2", 8100, 8150)("stop3", 8200, 8250);
@@ -1643,6 +1665,85 @@ BOOST_AUTO_TEST_CASE(finish_on_foot_path) {
     BOOST_CHECK_EQUAL(raptor.count, 2);
 }
 
+/*
+ *    A --------------- B --------------- C --------------- D
+ *
+ * l1   ----------------x-----------------x----------------->
+ *
+ * l2                    --------E========
+ *
+ * l3            X ------------------ Y
+ *
+ * Same as finish_on_foot_path, we check the frontier explored at each round:
+ * only the journey patterns reached by an improved stop point are explored,
+ * l3 never is.
+ * */
+BOOST_AUTO_TEST_CASE(frontier_round_counters) {
+    ed::builder b("20120614");
+    b.vj("l1", "1", "", true)("A", 8000, 8000)("B", 8100, 8100)("C", 8300, 8300)("D", 8500, 8500);
+    b.vj("l2", "1", "toto", true)("B", 8130, 8130)("E", 8200, 8200);
+    b.vj("l3", "1", "", true)("X", 8000, 8000)("Y", 8200, 8200);
+
+    b.connection("B", "B", 10);
+    b.connection("C", "C", 0);
+    b.connection("E", "C", 150);
+
+    b.data->pt_data->sort_and_index();
+    b.data->build_uri();
+    b.data->build_raptor();
+    RAPTOR raptor(*(b.data));
+    type::PT_Data& d = *b.data->pt_data;
+
+    routing::map_stop_point_duration departs;
+    departs[routing::SpIdx(*d.stop_points_map["A"])] = {};
+
+    auto departure_time = DateTimeUtils::set(0, 7900);
+    auto rt_level = nt::RTLevel::Base;
+    raptor.set_valid_jp_and_jpp(DateTimeUtils::date(departure_time), {}, {}, {}, rt_level);
+    raptor.first_raptor_loop(departs, departure_time, rt_level, DateTimeUtils::inf,
+                             std::numeric_limits<uint32_t>::max(), {}, true);
+
+    BOOST_CHECK_EQUAL(raptor.count, 2);
+    BOOST_REQUIRE_EQUAL(raptor.round_counters.size(), 2);
+    // round 1: l1 from A, improving B, C and D
+    BOOST_CHECK_EQUAL(raptor.round_counters[0].nb_marked_jps, 1);
+    BOOST_CHECK_EQUAL(raptor.round_counters[0].nb_marked_sps, 3);
+    // round 2: l1 and l2 from the transfers at B and C, improving E
+    BOOST_CHECK_EQUAL(raptor.round_counters[1].nb_marked_jps, 2);
+    BOOST_CHECK_EQUAL(raptor.round_counters[1].nb_marked_sps, 1);
+}
+
+// the stop time table read by the route scan must give the same times and
+// properties as the stop times themselves
+BOOST_AUTO_TEST_CASE(stop_time_table) {
+    ed::builder b("20120614");
+    b.vj("l1")("A", 8000, 8010)("B", 8100, 8110)("C", 8200, 8210);
+    b.vj("l1")("A", 9000, 9010)("B", 9100, 9110, std::numeric_limits<uint16_t>::max(), true, true, 30, 60)("C", 9200,
+                                                                                                           9210);
+    b.vj("l2")("B", 8130, 8130, 1)("D", 8200, 8200, 1)("E", 8300, 8300, std::numeric_limits<uint16_t>::max(), true,
+                                                           false);
+    b.frequency_vj("l3", "08:00"_t, "18:00"_t, "00:10"_t)("A", "00:00"_t)("E", "00:20"_t);
+    b.finish();
+    b.data->pt_data->sort_and_index();
+    b.data->build_raptor();
+
+    const auto& st_table = b.data->dataRaptor->st_table;
+    BOOST_REQUIRE_EQUAL(st_table.boarding_times.size(), b.data->pt_data->nb_stop_times());
+    for (const auto* vj : b.data->pt_data->vehicle_journeys) {
+        const auto first_pos = st_table.pos(vj->stop_time_list.front());
+        for (const auto& st : vj->stop_time_list) {
+            const auto pos = st_table.pos(st);
+            BOOST_CHECK_EQUAL(pos, first_pos + st.order().val);
+            for (const bool clockwise : {true, false}) {
+                BOOST_CHECK_EQUAL(st_table.section_end(pos, 42, clockwise), st.section_end(42, clockwise));
+                BOOST_CHECK_EQUAL(st_table.base_dt(pos, 100000, clockwise), st.base_dt(100000, clockwise));
+                BOOST_CHECK_EQUAL(st_table.valid_end(pos, clockwise), st.valid_end(clockwise));
+            }
+            BOOST_CHECK_EQUAL(st_table.local_traffic_zones[pos], st.local_traffic_zone);
+        }
+    }
+}
+
 // instance:
 // A---1---B=======B
 //         A---1---B=======B
@@ -37,10 +37,12 @@ www.navitia.io
 #include "routing_api_test_data.h"
 #include "tests/utils_test.h"
 #include "routing/raptor.h"
+#include "routing/thread_pool.h"
 #include "georef/street_network.h"
 #include "type/data.h"
 #include "type/rt_level.h"
 #include <boost/range/algorithm/count.hpp>
+#include <future>
 #include "type/pb_converter.h"
 
 struct logger_initialized {
@@ -1816,6 +1818,7 @@ BOOST_AUTO_TEST_CASE(use_crow_fly) {
     navitia::type::StopArea sa;
     ng::Admin* admin = new ng::Admin();
     sp.stop_area = &sa;
+    sa.idx = 0;
     sa.admin_list.push_back(admin);
 
     sa.uri = "sa:foo";
@@ -1863,11 +1866,12 @@ BOOST_AUTO_TEST_CASE(use_crow_fly) {
     ep.uri = "admin";
     navitia::type::StopPoint sp2;
     navitia::type::StopArea sa2;
+    sa2.idx = 1;
     sp2.stop_area = &sa2;
     BOOST_CHECK(nr::use_crow_fly(ep, sp2, empty_sn_path, data));
     BOOST_CHECK(!nr::use_crow_fly(ep, sp2, filled_sn_path, data));
 
-    admin->main_stop_areas.push_back(&sa2);
+    admin->main_stop_areas.push_back(sa2.idx);
     BOOST_CHECK(nr::use_crow_fly(ep, sp2, empty_sn_path, data));
     BOOST_CHECK(nr::use_crow_fly(ep, sp2, filled_sn_path, data));
 }
@@ -2103,6 +2107,65 @@ BOOST_AUTO_TEST_CASE(with_disruptions_on_network) {
                       "SIGNIFICANT_DELAYS");  // we should have the network's disruption's effect
 }
 
+// the stop points and stop areas repeated across the journeys are filled once, unless their messages depend on
+// the action period of their section
+BOOST_AUTO_TEST_CASE(journeys_fill_memo) {
+    ed::builder b("20150314");
+    b.vj("l")("A", 8 * 3600 + 25 * 60)("B", 8 * 3600 + 35 * 60);
+    b.vj("l")("A", 9 * 3600 + 25 * 60)("B", 9 * 3600 + 35 * 60);
+    b.vj("l")("A", 10 * 3600 + 25 * 60)("B", 10 * 3600 + 35 * 60);
+
+    b.finish();
+    b.generate_dummy_basis();
+    b.data->pt_data->sort_and_index();
+    b.data->build_raptor();
+    b.data->build_uri();
+
+    auto default_period = boost::posix_time::time_period("20150314T000000"_dt, "20500317T000000"_dt);
+    b.impact(nt::RTLevel::Adapted)
+        .uri("morning_works")
+        .publish(default_period)
+        .application_periods(boost::posix_time::time_period("20150314T080000"_dt, "20150314T090000"_dt))
+        .severity(nt::disruption::Effect::SIGNIFICANT_DELAYS)
+        .on(nt::Type_e::StopArea, "B")
+        .msg("no luck");
+
+    nr::RAPTOR raptor(*b.data);
+    navitia::type::EntryPoint origin(b.data->get_type_of_id("A"), "A");
+    navitia::type::EntryPoint destination(b.data->get_type_of_id("B"), "B");
+    ng::StreetNetwork sn_worker(*b.data->geo_ref);
+    auto* data_ptr = b.data.get();
+    navitia::PbCreator pb_creator(data_ptr, "20150314T070000"_dt, null_time_period);
+    make_response(pb_creator, raptor, origin, destination,
+                  {ntest::to_posix_timestamp("20150314T080000"), ntest::to_posix_timestamp("20150314T090000"),
+                   ntest::to_posix_timestamp("20150314T100000")},
+                  true, nt::AccessibiliteParams(), {}, {}, sn_worker, nt::RTLevel::Base, 2_min);
+    const auto stats = pb_creator.get_fill_stats();
+    pbnavitia::Response resp = pb_creator.get_response();
+
+    BOOST_REQUIRE_EQUAL(resp.response_type(), pbnavitia::ITINERARY_FOUND);
+    BOOST_REQUIRE_EQUAL(resp.journeys_size(), 3);
+    BOOST_CHECK_GT(stats.nb_memo_hits, 0);
+
+    auto journeys = sort_journeys(resp);
+    std::vector<const pbnavitia::Section*> sections;
+    for (const auto& journey : journeys) {
+        BOOST_REQUIRE_EQUAL(journey.sections_size(), 1);
+        sections.push_back(&journey.sections(0));
+    }
+    // the copies are identical to the fills
+    for (const auto* section : sections) {
+        BOOST_REQUIRE_EQUAL(section->stop_date_times_size(), 2);
+        BOOST_CHECK_EQUAL(section->origin().SerializeAsString(), sections[0]->origin().SerializeAsString());
+        BOOST_CHECK_EQUAL(section->stop_date_times(0).stop_point().SerializeAsString(),
+                          sections[0]->stop_date_times(0).stop_point().SerializeAsString());
+    }
+    // the stop area B is disrupted only for the first journey
+    BOOST_CHECK_EQUAL(sections[0]->destination().stop_point().stop_area().impact_uris_size(), 1);
+    BOOST_CHECK_EQUAL(sections[1]->destination().stop_point().stop_area().impact_uris_size(), 0);
+    BOOST_CHECK_EQUAL(sections[2]->destination().stop_point().stop_area().impact_uris_size(), 0);
+}
+
 BOOST_AUTO_TEST_CASE(journey_with_forbidden) {
     std::vector<std::string> forbidden;
     ed::builder b("20120614");
@@ -3534,6 +3597,147 @@ BOOST_AUTO_TEST_CASE(journeys_with_time_frame_duration) {
     BOOST_REQUIRE_EQUAL(resp.response_type(), pbnavitia::NO_SOLUTION);
 }
 
+/**
+ * @brief The timeframe computed as a profile query by several threads must
+ * give the same journeys as the sequential loop on the same data
+ * (see journeys_with_time_frame_duration)
+ */
+BOOST_AUTO_TEST_CASE(journeys_with_time_frame_duration_in_profile_mode) {
+    ed::builder b("20180309");
+
+    b.sa("stop_area:sa1")("stop_point:sa1:s1", 2.39592, 48.84848, false);
+    b.sa("stop_area:sa3")("stop_point:sa3:s1", 2.36381, 48.86650, false);
+
+    auto dep_time = "08:00:00"_t;
+    auto arr_time = "08:05:00"_t;
+    for (int nb = 0; nb < 20; ++nb) {
+        b.vj("A", "1", "", false, "vjC_" + std::to_string(nb))("stop_point:sa1:s1", dep_time + nb * "00:10::00"_t)(
+            "stop_point:sa3:s1", arr_time + nb * "00:10::00"_t);
+    }
+    // a slower vj leaving at the same time as vjC_3 is dominated on the window
+    b.vj("B", "1", "", false, "vj_slow")("stop_point:sa1:s1", "08:30:00"_t)("stop_point:sa3:s1", "08:50:00"_t);
+
+    b.finish();
+    b.data->pt_data->sort_and_index();
+    b.data->build_raptor();
+    b.data->build_uri();
+    b.data->build_proximity_list();
+    b.data->meta->production_date =
+        boost::gregorian::date_period(boost::gregorian::date(2018, 3, 9), boost::gregorian::days(1));
+
+    nr::RAPTOR raptor(*(b.data));
+    navitia::type::EntryPoint origin(navitia::type::Type_e::StopPoint, "stop_point:sa1:s1");
+    navitia::type::EntryPoint destination(navitia::type::Type_e::StopPoint, "stop_point:sa3:s1");
+    ng::StreetNetwork sn_worker(*b.data->geo_ref);
+    auto* data_ptr = b.data.get();
+    const uint32_t timeframe_duration = 60 * 60;
+
+    auto get_departures = [&](const bool clockwise, const uint64_t timestamp, nr::ThreadPool* profile_pool) {
+        navitia::PbCreator pb_creator(data_ptr, "20180309T075900"_dt, null_time_period);
+        make_response(pb_creator, raptor, origin, destination, {timestamp}, clockwise,
+                      navitia::type::AccessibiliteParams(), {}, {}, sn_worker, nt::RTLevel::Base, 2_min, 24 * 60 * 60,
+                      10, 0, 0, 0, boost::none, 1.5, 900, timeframe_duration, 1, profile_pool);
+        const auto resp = pb_creator.get_response();
+        BOOST_REQUIRE_EQUAL(resp.response_type(), pbnavitia::ITINERARY_FOUND);
+        std::set<uint64_t> departures;
+        for (const auto& journey : resp.journeys()) {
+            BOOST_REQUIRE_EQUAL(journey.sections_size(), 1);
+            BOOST_CHECK_EQUAL(journey.sections(0).pt_display_informations().uris().line(), "A");
+            departures.insert(journey.sections(0).begin_date_time());
+        }
+        return departures;
+    };
+
+    // clockwise, from 07:59 to 08:59, the departures are 08:00, 08:10, ..., 08:50
+    // and, as in the sequential loop, the first one after the window (09:00)
+    const auto clockwise_dt = ntest::to_posix_timestamp("20180309T075900");
+    nr::ThreadPool profile_pool(3);
+    const auto sequential = get_departures(true, clockwise_dt, nullptr);
+    const auto profile = get_departures(true, clockwise_dt, &profile_pool);
+    BOOST_CHECK_EQUAL_COLLECTIONS(profile.begin(), profile.end(), sequential.begin(), sequential.end());
+    BOOST_CHECK_EQUAL(profile.size(), 7);
+    BOOST_CHECK_EQUAL(*profile.begin(), "20180309T080000"_pts);
+
+    // anti clockwise, arriving before 09:35 and after 08:35
+    const auto anti_clockwise_dt = ntest::to_posix_timestamp("20180309T093500");
+    const auto anti_profile = get_departures(false, anti_clockwise_dt, &profile_pool);
+    BOOST_CHECK_GE(anti_profile.size(), 6);
+    BOOST_CHECK_EQUAL(*anti_profile.rbegin(), "20180309T093000"_pts);
+
+    // the workers used by the slices are kept with the planner
+    BOOST_CHECK_EQUAL(raptor.profile_workers.size(), 3);
+
+    // the pool is shared with other requests: while its threads are busy, the
+    // slices are computed by the thread of the request, with the same result
+    std::promise<void> release_pool;
+    auto pool_released = release_pool.get_future().share();
+    for (size_t i = 0; i < profile_pool.size(); ++i) {
+        profile_pool.post([pool_released]() { pool_released.wait(); });
+    }
+    const auto busy_pool_profile = get_departures(true, clockwise_dt, &profile_pool);
+    release_pool.set_value();
+    BOOST_CHECK_EQUAL_COLLECTIONS(busy_pool_profile.begin(), busy_pool_profile.end(), profile.begin(), profile.end());
+}
+
+BOOST_AUTO_TEST_CASE(split_timeframe_test) {
+    using navitia::DateTimeUtils::set;
+
+    // clockwise: the window is split in consecutive slices
+    auto slices = nr::split_timeframe(set(0, 3600), set(0, 7200), true, 4);
+    BOOST_REQUIRE_EQUAL(slices.size(), 4);
+    BOOST_CHECK_EQUAL(slices[0].first, set(0, 3600));
+    BOOST_CHECK_EQUAL(slices[0].second, set(0, 4500));
+    BOOST_CHECK_EQUAL(slices[1].first, set(0, 4500));
+    BOOST_CHECK_EQUAL(slices[3].second, set(0, 7200));
+
+    // anti clockwise: the window goes backward
+    slices = nr::split_timeframe(set(0, 7200), set(0, 3600), false, 2);
+    BOOST_REQUIRE_EQUAL(slices.size(), 2);
+    BOOST_CHECK_EQUAL(slices[0].first, set(0, 7200));
+    BOOST_CHECK_EQUAL(slices[0].second, set(0, 5400));
+    BOOST_CHECK_EQUAL(slices[1].second, set(0, 3600));
+
+    // no more slices than seconds in the window
+    slices = nr::split_timeframe(set(0, 3600), set(0, 3602), true, 8);
+    BOOST_CHECK_EQUAL(slices.size(), 2);
+
+    // empty window: only one slice
+    slices = nr::split_timeframe(set(0, 3600), set(0, 3600), true, 8);
+    BOOST_CHECK_EQUAL(slices.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(filter_dominated_in_timeframe_test) {
+    ed::builder b("20180309");
+    b.vj("A")("stop1", "08:00"_t)("stop2", "09:00"_t);
+    b.finish();
+    const auto& stop_times = b.data->pt_data->vehicle_journeys.front()->stop_time_list;
+
+    auto make_journey = [&](const navitia::DateTime dep, const navitia::DateTime arr, const size_t nb_sections) {
+        nr::Journey journey;
+        journey.departure_dt = dep;
+        journey.arrival_dt = arr;
+        journey.sections.assign(nb_sections, nr::Journey::Section(stop_times[0], dep, stop_times[1], arr));
+        return journey;
+    };
+    nr::JourneySet journeys;
+    journeys.insert(make_journey(100, 200, 1));
+    journeys.insert(make_journey(150, 250, 1));
+    // leaves before and arrives after (100, 200): dominated
+    journeys.insert(make_journey(90, 210, 1));
+    // arrives sooner, but with a transfer: kept
+    journeys.insert(make_journey(150, 240, 2));
+    // same as (150, 240) with more transfers: dominated
+    journeys.insert(make_journey(140, 240, 3));
+
+    nr::filter_dominated_in_timeframe(journeys);
+
+    BOOST_CHECK_EQUAL(journeys.size(), 3);
+    for (const auto& journey : journeys) {
+        BOOST_CHECK_NE(journey.departure_dt, 90);
+        BOOST_CHECK_NE(journey.departure_dt, 140);
+    }
+}
+
 // basic journey without min_nb_journey nor timeframe_limit
 BOOST_AUTO_TEST_CASE(keep_going_tests_simple) {
     // no solution found: stop the search
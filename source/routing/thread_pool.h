@@ -0,0 +1,70 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+channel `#navitia` on riot https://riot.im/app/#/room/#navitia:matrix.org
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+
+#include <boost/utility.hpp>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace navitia {
+namespace routing {
+
+/** A fixed number of threads running the tasks posted by any thread
+ *
+ * Shared by the workers of kraken, it bounds the number of threads
+ * computing the profile queries whatever the load. The tasks must not
+ * throw nor wait for other tasks of the pool.
+ */
+class ThreadPool : boost::noncopyable {
+public:
+    explicit ThreadPool(size_t nb_threads);
+    /// the pending tasks are run before the threads are joined
+    ~ThreadPool();
+
+    size_t size() const { return threads.size(); }
+    void post(std::function<void()> task);
+
+private:
+    std::vector<std::thread> threads;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable task_posted;
+    bool stopped = false;
+
+    void run();
+};
+
+}  // namespace routing
+}  // namespace navitia
@@ -47,7 +47,7 @@ www.navitia.io
 
 #include <eos_portable_archive/portable_iarchive.hpp>
 #include <eos_portable_archive/portable_oarchive.hpp>
-#include "lz4_filter/filter.h"
+#include "lz4_filter/framed_filter.h"
 #include "utils/functions.h"
 #include "utils/threadbuf.h"
 
@@ -56,6 +56,11 @@ www.navitia.io
 #include "georef/georef.h"
 #include "fare/fare.h"
 #include "type/meta_data.h"
+#include "type/flat_nav.h"
+#include "autocomplete/autocomplete_filters.h"
+#include "ptreferential/ptref_cache.h"
+#include "ptreferential/relation_index.h"
+#include "type/datetime.h"
 #include "kraken/fill_disruption_from_database.h"
 
 namespace pt = boost::posix_time;
@@ -63,7 +68,7 @@ namespace pt = boost::posix_time;
 namespace navitia {
 namespace type {
 
-const unsigned int Data::data_version = 3;  //< *INCREMENT* every time serialized data are modified
+const unsigned int Data::data_version = 6;  //< *INCREMENT* every time serialized data are modified
 
 Data::Data(size_t data_identifier)
     : _last_rt_data_loaded(boost::posix_time::not_a_date_time),
@@ -71,9 +76,9 @@ Data::Data(size_t data_identifier)
       data_identifier(data_identifier),
       meta(std::make_unique<MetaData>()),
       pt_data(std::make_unique<PT_Data>()),
-      geo_ref(std::make_unique<navitia::georef::GeoRef>()),
+      geo_ref(std::make_shared<navitia::georef::GeoRef>()),
       dataRaptor(std::make_unique<navitia::routing::dataRAPTOR>()),
-      fare(std::make_unique<navitia::fare::Fare>()),
+      fare(std::make_shared<navitia::fare::Fare>()),
       find_admins([&](const GeographicalCoord& c, georef::AdminRtree& admin_tree) {
           return geo_ref->find_admins(c, admin_tree);
       }),
@@ -87,7 +92,7 @@ Data::~Data() {}
 
 template <class Archive>
 void Data::save(Archive& ar, const unsigned int) const {
-    ar& pt_data& geo_ref& meta& fare& last_load_at& loaded& last_load_succeeded& is_connected_to_rabbitmq&
+    ar& pt_data& *geo_ref& meta& *fare& last_load_at& loaded& last_load_succeeded& is_connected_to_rabbitmq&
         is_realtime_loaded;
 }
 template <class Archive>
@@ -100,7 +105,7 @@ void Data::load(Archive& ar, const unsigned int version) {
             % version % v;
         throw navitia::data::wrong_version(msg.str());
     }
-    ar& pt_data& geo_ref& meta& fare& last_load_at& loaded& last_load_succeeded& is_connected_to_rabbitmq&
+    ar& pt_data& *geo_ref& meta& *fare& last_load_at& loaded& last_load_succeeded& is_connected_to_rabbitmq&
         is_realtime_loaded;
 }
 SPLIT_SERIALIZABLE(Data)
@@ -127,6 +132,7 @@ void Data::load_nav(const std::string& filename) {
         std::ifstream ifs(filename.c_str(), std::ios::in | std::ios::binary);
         ifs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
         this->load(ifs);
+        this->load_flat(flat_nav_filename(filename));
         loaded = true;
         last_load_at = pt::microsec_clock::universal_time();
         last_load_succeeded = true;
@@ -143,9 +149,10 @@ void Data::load_nav(const std::string& filename) {
     LOG4CPLUS_DEBUG(logger, "Finished to load nav");
 }
 
-void Data::load(std::istream& ifs) {
+void Data::load(std::istream& ifs, size_t nb_threads) {
     boost::iostreams::filtering_streambuf<boost::iostreams::input> in;
-    in.push(LZ4Decompressor(2048 * 500), 8192 * 500, 8192 * 500);
+    // the buffer must be big enough to contain a whole chunk of the legacy format
+    in.push(FramedLZ4Decompressor(nb_threads), 8192 * 500, 8192 * 500);
     in.push(ifs);
     eos::portable_iarchive ia(in);
     ia >> *this;
@@ -192,20 +199,32 @@ void Data::load_disruptions(const std::string& database, const std::vector<std::
  * @brief Build Data Raptor
  *
  * @param cache_size Selected LRU size to optimize cache miss
+ * @param previous Data whose raptor data can be reused for the unchanged journey patterns
  */
-void Data::build_raptor(size_t cache_size) {
+void Data::build_raptor(size_t cache_size, const Data* previous) {
     // Add logger
     log4cplus::Logger logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("logger"));
     LOG4CPLUS_DEBUG(logger, "Start to build data Raptor");
-    dataRaptor->load(*this->pt_data, cache_size);
-    LOG4CPLUS_DEBUG(logger, "Finished to build data Raptor");
+    dataRaptor->load(*this->pt_data, cache_size, previous ? previous->dataRaptor.get() : nullptr);
+    LOG4CPLUS_DEBUG(logger, "Finished to build data Raptor, " << dataRaptor->nb_rebuilt_jps << " / "
+                                                               << dataRaptor->jp_container.nb_jps()
+                                                               << " journey patterns computed");
+}
+
+void Data::build_ptref_cache(size_t cache_size) {
+    relation_index = std::make_unique<navitia::ptref::RelationIndex>(*this);
+    if (cache_size == 0) {
+        ptref_cache.reset();
+        return;
+    }
+    ptref_cache = std::make_unique<navitia::ptref::PtrefCache>(*this, cache_size);
 }
 
 void Data::warmup(const Data& other) {
     this->dataRaptor->warmup(*other.dataRaptor);
 }
 
-void Data::save(const std::string& filename) const {
+void Data::save(const std::string& filename, bool high_compression) const {
     log4cplus::Logger logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("logger"));
     boost::filesystem::path p(filename);
     boost::filesystem::path dir = p.parent_path();
@@ -221,7 +240,7 @@ void Data::save(const std::string& filename) const {
     std::ofstream ofs(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
     ofs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
     try {
-        this->save(ofs);
+        this->save(ofs, high_compression);
     } catch (const boost::filesystem::filesystem_error& e) {
         if (e.code() == boost::system::errc::permission_denied)
             LOG4CPLUS_ERROR(logger, "Writing permission is denied for " << p);
@@ -244,12 +263,53 @@ void Data::save(const std::string& filename) const {
     }
 }
 
-void Data::save(std::ostream& ofs) const {
+void Data::save(std::ostream& ofs, bool high_compression) const {
     boost::iostreams::filtering_streambuf<boost::iostreams::output> out;
-    out.push(LZ4Compressor(2048 * 500), 1024 * 500, 1024 * 500);
+    out.push(FramedLZ4Compressor(1024 * 1024, high_compression), 1024 * 500, 1024 * 500);
     out.push(ofs);
-    eos::portable_oarchive oa(out);
-    oa << *this;
+    {
+        eos::portable_oarchive oa(out);
+        oa << *this;
+    }
+    // close the chain to write the last blocks, errors would be swallowed by its destructor
+    out.reset();
+}
+
+void Data::save_flat(const std::string& filename) const {
+    FlatNavWriter writer(data_version, nav_id());
+    geo_ref->add_flat_sections(writer);
+    try {
+        writer.save(filename);
+    } catch (const std::ofstream::failure& e) {
+        throw navitia::exception(std::string("Unable to write flat file: ") + e.what());
+    }
+}
+
+void Data::load_flat(const std::string& filename) {
+    log4cplus::Logger logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("logger"));
+    flat_nav.reset();
+    if (!boost::filesystem::exists(filename)) {
+        LOG4CPLUS_DEBUG(logger, "no flat file " << filename);
+        return;
+    }
+    try {
+        auto flat = std::make_shared<const FlatNav>(filename);
+        if (flat->data_version() != data_version || flat->nav_id() != nav_id()) {
+            LOG4CPLUS_WARN(logger, "flat file " << filename << " has not been written with the loaded data, ignored");
+            return;
+        }
+        LOG4CPLUS_INFO(logger, "flat file " << filename << " mapped");
+        flat_nav = std::move(flat);
+    } catch (const navitia::data::data_loading_error& e) {
+        LOG4CPLUS_WARN(logger, "unable to use flat file, ignored: " << e.what());
+    }
+}
+
+uint64_t Data::nav_id() const {
+    if (meta->publication_date.is_not_a_date_time()) {
+        return 0;
+    }
+    return navitia::to_posix_timestamp(meta->publication_date);
 }
 
 void Data::build_uri() {
@@ -263,10 +323,23 @@ void Data::build_uri() {
 
 void Data::build_proximity_list() {
     this->pt_data->build_proximity_list();
-    this->geo_ref->build_proximity_list();
+    if (is_geo_ref_shared) {
+        // the shared geo_ref is read by the workers of the data we have been cloned from, and the realtime never
+        // adds stop points nor moves them: the projections it holds are still valid, they must not be rebuilt
+        return;
+    }
+    this->geo_ref->build_proximity_list(flat_nav.get());
     this->geo_ref->project_stop_points(this->pt_data->stop_points);
 }
 
+void Data::build_compact_graph() {
+    if (is_geo_ref_shared) {
+        // built with the geo_ref we share
+        return;
+    }
+    this->geo_ref->build_compact_graph();
+}
+
 void Data::build_administrative_regions() {
     auto log = log4cplus::Logger::getInstance("ed::Data");
     georef::AdminRtree admin_tree = georef::build_admins_tree(geo_ref->admins);
@@ -315,17 +388,49 @@ void Data::build_administrative_regions() {
     for (const auto* sa : pt_data->stop_areas)
         for (auto admin : sa->admin_list)
             if (!admin->from_original_dataset)
-                admin->main_stop_areas.push_back(sa);
+                admin->main_stop_areas.push_back(sa->idx);
 }
 
 void Data::build_autocomplete() {
     geo_ref->build_autocomplete_list();
+    // the street network might have changed, its filters must be recomputed
+    autocomplete_filters.reset();
     build_autocomplete_partial();
 }
 
 void Data::build_autocomplete_partial() {
     pt_data->build_autocomplete(*geo_ref);
-    pt_data->compute_score_autocomplete(*geo_ref);
+    // the scores of the street network objects only depend on the number of stop points by
+    // admin, they are already computed in a shared geo_ref
+    pt_data->compute_score_autocomplete(*geo_ref, !is_geo_ref_shared);
+    build_autocomplete_filters();
+}
+
+void Data::build_autocomplete_filters() {
+    const size_t nb_admins = geo_ref->admins.size();
+    auto filters = std::make_shared<autocomplete::AutocompleteFilters>();
+
+    filters->main_stop_areas.resize(pt_data->stop_areas.size());
+    for (const auto* admin : geo_ref->admins) {
+        for (const auto sa_idx : admin->main_stop_areas) {
+            if (sa_idx < filters->main_stop_areas.size()) {
+                filters->main_stop_areas.set(sa_idx);
+            }
+        }
+    }
+    filters->stop_areas.build(pt_data->stop_areas, nb_admins);
+    filters->stop_points.build(pt_data->stop_points, nb_admins);
+
+    if (autocomplete_filters && autocomplete_filters->geo_ref) {
+        filters->geo_ref = autocomplete_filters->geo_ref;
+    } else {
+        auto geo_ref_filters = std::make_shared<autocomplete::GeoRefAutocompleteFilters>();
+        geo_ref_filters->admins.build(geo_ref->admins, nb_admins);
+        geo_ref_filters->ways.build(geo_ref->ways, nb_admins);
+        geo_ref_filters->pois.build(geo_ref->pois, nb_admins);
+        filters->geo_ref = std::move(geo_ref_filters);
+    }
+    autocomplete_filters = std::move(filters);
 }
 
 ValidityPattern* Data::get_similar_validity_pattern(ValidityPattern* vp) const {
@@ -383,6 +488,15 @@ void Data::complete() {
     pt::ptime start;
     int admin, sort, autocomplete;
 
+    // the admins reference the stop areas and stop points by idx, until
+    // the final sort their idx is their position in pt_data
+    for (size_t i = 0; i < pt_data->stop_areas.size(); ++i) {
+        pt_data->stop_areas[i]->idx = i;
+    }
+    for (size_t i = 0; i < pt_data->stop_points.size(); ++i) {
+        pt_data->stop_points[i]->idx = i;
+    }
+
     build_grid_validity_pattern();
 
     start = pt::microsec_clock::local_time();
@@ -397,7 +511,18 @@ void Data::complete() {
     compute_labels();
 
     start = pt::microsec_clock::local_time();
+    // the admins reference the stop areas and stop points by idx, they must follow the sort
+    const auto stop_areas_before_sort = pt_data->stop_areas;
+    const auto stop_points_before_sort = pt_data->stop_points;
     pt_data->sort_and_index();
+    for (auto* admin : geo_ref->admins) {
+        for (auto& sa_idx : admin->main_stop_areas) {
+            sa_idx = stop_areas_before_sort[sa_idx]->idx;
+        }
+        for (auto& sp_idx : admin->odt_stop_points) {
+            sp_idx = stop_points_before_sort[sp_idx]->idx;
+        }
+    }
     sort = (pt::microsec_clock::local_time() - start).total_milliseconds();
 
     start = pt::microsec_clock::local_time();
@@ -506,7 +631,7 @@ void Data::aggregate_odt() {
     // we first store the stops in a set not to have duplicates
     for (const auto& p : odt_stops_by_admin) {
         for (const auto& sp : p.second) {
-            p.first->odt_stop_points.push_back(sp);
+            p.first->odt_stop_points.push_back(sp->idx);
         }
     }
 }
@@ -845,17 +970,68 @@ struct Pipe {
 // stream the source object in a binary_oarchive, and then stream it
 // in our object.  To avoid having the whole binary_oarchive in
 // memory, we construct a pipe between 2 threads.
+/*
+ * Replace the admins of the stop areas and stop points by the ones of the
+ * given georef.
+ *
+ * When only the PT_Data is copied, its admins are copied with it (with
+ * their parents) and must be deleted once replaced.
+ */
+static void relink_admins(PT_Data& pt_data, const georef::GeoRef& geo_ref) {
+    std::vector<const georef::Admin*> copies;
+    auto relink = [&](std::vector<georef::Admin*>& admin_list) {
+        for (auto& admin : admin_list) {
+            copies.push_back(admin);
+            admin = geo_ref.admins.at(admin->idx);
+        }
+    };
+    for (auto* sa : pt_data.stop_areas) {
+        relink(sa->admin_list);
+    }
+    for (auto* sp : pt_data.stop_points) {
+        relink(sp->admin_list);
+    }
+
+    std::set<const georef::Admin*> to_delete;
+    while (!copies.empty()) {
+        const auto* admin = copies.back();
+        copies.pop_back();
+        if (to_delete.insert(admin).second) {
+            boost::push_back(copies, admin->admin_list);
+        }
+    }
+    for (const auto* admin : to_delete) {
+        delete admin;
+    }
+}
+
 void Data::clone_from(const Data& from) {
+    // the street network, the fares and the flat file are not modified by
+    // the realtime, they are shared instead of being copied
+    geo_ref = from.geo_ref;
+    fare = from.fare;
+    flat_nav = from.flat_nav;
+    autocomplete_filters = from.autocomplete_filters;
+    is_geo_ref_shared = true;
+
     Pipe p;
     std::thread write([&]() {
         boost::archive::binary_oarchive oa(p.out);
-        oa << from;
+        oa << from.pt_data << from.meta;
     });
     {
         boost::archive::binary_iarchive ia(p.in);
-        ia >> *this;
+        ia >> pt_data >> meta;
     }
     write.join();
+    relink_admins(*pt_data, *geo_ref);
+
+    version = from.version;
+    last_load_at = from.last_load_at;
+    loaded = from.loaded.load();
+    last_load_succeeded = from.last_load_succeeded;
+    is_connected_to_rabbitmq = from.is_connected_to_rabbitmq.load();
+    is_realtime_loaded = from.is_realtime_loaded.load();
 }
 
 void Data::set_last_rt_data_loaded(const boost::posix_time::ptime& p) const {
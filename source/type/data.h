@@ -127,13 +127,30 @@ public:
     // public transport (PT) referential
     std::unique_ptr<PT_Data> pt_data;
 
-    std::unique_ptr<navitia::georef::GeoRef> geo_ref;
+    // street network referential, not modified by the realtime so shared between clones
+    std::shared_ptr<navitia::georef::GeoRef> geo_ref;
 
     // precomputed data for raptor (public transport routing algorithm)
     std::unique_ptr<navitia::routing::dataRAPTOR> dataRaptor;
 
-    // Fare data
-    std::unique_ptr<navitia::fare::Fare> fare;
+    // Fare data, shared between clones
+    std::shared_ptr<navitia::fare::Fare> fare;
+
+    // true when geo_ref and fare are shared with the data we have been cloned from,
+    // they are then read only
+    bool is_geo_ref_shared = false;
+
+    // memory mapped flat companion of the .nav, if any. Shared between clones
+    std::shared_ptr<const FlatNav> flat_nav;
+
+    // admin filters and main stop areas of the autocomplete, rebuilt with it
+    std::shared_ptr<const navitia::autocomplete::AutocompleteFilters> autocomplete_filters;
+
+    // cache of the ptref filters, empty with every new or cloned data, null when disabled
+    std::unique_ptr<navitia::ptref::PtrefCache> ptref_cache;
+
+    // relations between the adjacent types of ptref, built with the cache of the filters
+    std::unique_ptr<navitia::ptref::RelationIndex> relation_index;
 
     // functor to find admins
     std::function<std::vector<georef::Admin*>(const GeographicalCoord&, georef::AdminRtree&)> find_admins;
@@ -200,12 +217,26 @@ public:
     // Loading methods
     void load_nav(const std::string& filename);
     void load_disruptions(const std::string& database, const std::vector<std::string>& contributors = {});
-    void build_raptor(size_t cache_size = 10);
+    /** Build raptor data
+     *
+     * When previous is given, its raptor data are reused for every
+     * journey pattern not impacted by the changes done since the clone
+     */
+    void build_raptor(size_t cache_size = 10, const Data* previous = nullptr);
 
     void warmup(const Data& other);
 
-    /** Save data */
-    void save(const std::string& filename) const;
+    /** Save data, with LZ4HC if high_compression (smaller file, slower to write) */
+    void save(const std::string& filename, bool high_compression = false) const;
+
+    /** Save the flat companion file of the .nav */
+    void save_flat(const std::string& filename) const;
+
+    /** Map the flat companion file, ignored if it does not exist or does not match the loaded data */
+    void load_flat(const std::string& filename);
+
+    /** Identifier of the .nav, used to check that a flat file has been written with it */
+    uint64_t nav_id() const;
 
     /** Build ExternalCode index */
     void build_uri();
@@ -213,9 +244,21 @@ public:
     /** Build Autocomplete index */
     void build_autocomplete();
     void build_autocomplete_partial();
+    /** Build the admin filters of the autocomplete, the street network part is kept if already built */
+    void build_autocomplete_filters();
+
+    /** Build the ptref indexes: the relations between adjacent types, filled
+     * on first use, and the cache of the filters, keeping at most cache_size
+     * results (0 disables it)
+     *
+     * Must be called once the data will not be modified anymore
+     */
+    void build_ptref_cache(size_t cache_size);
 
     /** Build ProximityList index */
     void build_proximity_list();
+    /** Build the compact copy of the street network graph, see GeoRef::build_compact_graph */
+    void build_compact_graph();
     /** Set admins*/
     void build_administrative_regions();
 
@@ -236,13 +279,20 @@ public:
      *
      * LZ4 compression is super fast but its efficiency is average
      * The goal is to achieve the same read performance with and without compression
+     *
+     * The blocks of the framed format are decompressed on nb_threads threads (0 for one by core),
+     * files in the legacy format are still read
      */
-    void load(std::istream& ifs);
+    void load(std::istream& ifs, size_t nb_threads = 0);
 
-    /** Save data in a compressed binary file using LZ4*/
-    void save(std::ostream& ifs) const;
+    /** Save data in a compressed binary file using the framed LZ4 format */
+    void save(std::ostream& ifs, bool high_compression = false) const;
 
-    // Deep clone from the given Data.
+    /** Clone from the given Data
+     *
+     * The public transport and meta data are deep copied, the parts that
+     * are not impacted by the realtime (geo_ref, fare, flat_nav) are shared
+     */
     void clone_from(const Data&);
 
     void set_last_rt_data_loaded(const boost::posix_time::ptime&) const;
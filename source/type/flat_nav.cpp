@@ -0,0 +1,160 @@
+/* Copyright © 2001-2019, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+channel `#navitia` on riot https://riot.im/app/#/room/#navitia:matrix.org
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "flat_nav.h"
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace navitia {
+namespace type {
+
+static uint64_t align(uint64_t offset) {
+    const uint64_t alignment = 8;
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+FlatNavWriter::FlatNavWriter(uint32_t data_version, uint64_t nav_id) {
+    header.data_version = data_version;
+    header.nav_id = nav_id;
+}
+
+void FlatNavWriter::add_section(const std::string& name, const void* data, size_t nb_items, size_t item_size) {
+    if (name.size() >= FlatNavSection::max_name_size) {
+        throw navitia::exception("flat section name too long: " + name);
+    }
+    PendingSection pending;
+    std::strncpy(pending.section.name, name.c_str(), FlatNavSection::max_name_size - 1);
+    pending.section.nb_items = nb_items;
+    pending.section.item_size = item_size;
+    pending.data = data;
+    sections.push_back(pending);
+}
+
+void FlatNavWriter::save(const std::string& filename) const {
+    FlatNavHeader h = header;
+    h.nb_sections = sections.size();
+
+    std::vector<FlatNavSection> table;
+    uint64_t offset = align(sizeof(FlatNavHeader) + sections.size() * sizeof(FlatNavSection));
+    for (const auto& pending : sections) {
+        table.push_back(pending.section);
+        table.back().offset = offset;
+        offset = align(offset + pending.section.nb_items * pending.section.item_size);
+    }
+
+    // The krakens of the host may have the previous file mapped: it is never rewritten in place, a new
+    // file is written next to it then renamed, the mappings keep the old inode until they are released
+    const std::string tmp_filename = filename + ".tmp";
+    try {
+        std::ofstream ofs(tmp_filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        ofs.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+        ofs.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        ofs.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(FlatNavSection));
+        const char padding[8] = {};
+        for (size_t i = 0; i < sections.size(); ++i) {
+            ofs.seekp(0, std::ios::end);
+            const uint64_t pos = ofs.tellp();
+            ofs.write(padding, table[i].offset - pos);
+            ofs.write(static_cast<const char*>(sections[i].data), table[i].nb_items * table[i].item_size);
+        }
+        ofs.close();
+    } catch (const std::ios_base::failure&) {
+        std::remove(tmp_filename.c_str());
+        throw navitia::exception("unable to write flat file " + tmp_filename);
+    }
+    if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+        std::remove(tmp_filename.c_str());
+        throw navitia::exception("unable to rename flat file " + tmp_filename + " to " + filename);
+    }
+}
+
+FlatNav::FlatNav(const std::string& filename) {
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw navitia::data::data_loading_error("unable to open flat file " + filename);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(FlatNavHeader)) {
+        ::close(fd);
+        throw navitia::data::data_loading_error("invalid flat file " + filename);
+    }
+    mapping_size = st.st_size;
+    void* addr = ::mmap(nullptr, mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+    // the mapping stays valid once the file descriptor is closed
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        throw navitia::data::data_loading_error("unable to map flat file " + filename);
+    }
+    mapping = static_cast<const char*>(addr);
+
+    const FlatNavHeader reference;
+    const auto& h = header();
+    if (std::memcmp(h.magic, reference.magic, sizeof(reference.magic)) != 0
+        || h.version != FlatNavHeader::format_version || h.bom != FlatNavHeader::byte_order_mark
+        || sizeof(FlatNavHeader) + h.nb_sections * sizeof(FlatNavSection) > mapping_size) {
+        ::munmap(const_cast<char*>(mapping), mapping_size);
+        throw navitia::data::data_loading_error("invalid flat file " + filename);
+    }
+    const auto* table = reinterpret_cast<const FlatNavSection*>(mapping + sizeof(FlatNavHeader));
+    for (uint32_t i = 0; i < h.nb_sections; ++i) {
+        const auto& section = table[i];
+        if (section.offset + section.nb_items * section.item_size > mapping_size) {
+            ::munmap(const_cast<char*>(mapping), mapping_size);
+            throw navitia::data::data_loading_error("truncated flat file " + filename);
+        }
+        sections[std::string(section.name, strnlen(section.name, FlatNavSection::max_name_size))] = &section;
+    }
+    // we'll read the file sequentially at least once
+    ::madvise(const_cast<char*>(mapping), mapping_size, MADV_WILLNEED);
+}
+
+FlatNav::~FlatNav() {
+    if (mapping != nullptr) {
+        ::munmap(const_cast<char*>(mapping), mapping_size);
+    }
+}
+
+std::string flat_nav_filename(const std::string& nav_filename) {
+    static const std::string suffix = ".lz4";
+    if (boost::algorithm::ends_with(nav_filename, suffix)) {
+        return nav_filename.substr(0, nav_filename.size() - suffix.size()) + ".flat";
+    }
+    return nav_filename + ".flat";
+}
+
+}  // namespace type
+}  // namespace navitia
@@ -0,0 +1,148 @@
+/* Copyright © 2001-2019, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+channel `#navitia` on riot https://riot.im/app/#/room/#navitia:matrix.org
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+
+#include "type/data_exceptions.h"
+
+#include <boost/range/iterator_range.hpp>
+#include <boost/utility.hpp>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace navitia {
+namespace type {
+
+/** Flat companion of the .nav.lz4 file, used in place through mmap.
+ *
+ * The file is made of a header, a table of sections and the sections
+ * themselves.  Each section is a flat array of trivially copyable
+ * items, aligned on 8 bytes, stored in the byte order of the host
+ * that wrote it.  Nothing is deserialized: the reader maps the file
+ * read only and gives views on the sections, thus N krakens of the
+ * same host share the same pages in the page cache.
+ *
+ * The flat file is tied to the .nav it has been written with by the
+ * data version and the publication date of the data.
+ *
+ * For now it only holds the proximity lists and the POI coordinates:
+ * the stop times, the journey pattern points, the connections and the
+ * street network graph are still loaded from the .nav, so the load time
+ * of kraken is not reduced yet.
+ */
+struct FlatNavHeader {
+    static constexpr uint32_t format_version = 1;
+    static constexpr uint32_t byte_order_mark = 0x01020304;
+
+    char magic[8] = {'N', 'A', 'V', 'F', 'L', 'A', 'T', '\0'};
+    uint32_t version = format_version;
+    uint32_t bom = byte_order_mark;
+    uint32_t data_version = 0;
+    uint32_t nb_sections = 0;
+    uint64_t nav_id = 0;  // identifies the .nav, see Data::nav_id()
+};
+
+struct FlatNavSection {
+    static constexpr size_t max_name_size = 48;
+
+    char name[max_name_size] = {};
+    uint64_t offset = 0;  // from the beginning of the file
+    uint64_t nb_items = 0;
+    uint64_t item_size = 0;
+};
+
+/// Writes a flat file section by section
+class FlatNavWriter {
+public:
+    FlatNavWriter(uint32_t data_version, uint64_t nav_id);
+
+    template <typename T>
+    void add_section(const std::string& name, const std::vector<T>& items) {
+        static_assert(std::is_trivially_copyable<T>::value, "flat sections can only contain trivially copyable items");
+        add_section(name, items.data(), items.size(), sizeof(T));
+    }
+
+    /// Writes a temporary file renamed into place, so that the file mapped by running krakens is never modified
+    void save(const std::string& filename) const;
+
+private:
+    struct PendingSection {
+        FlatNavSection section;
+        const void* data;
+    };
+    FlatNavHeader header;
+    std::vector<PendingSection> sections;
+
+    void add_section(const std::string& name, const void* data, size_t nb_items, size_t item_size);
+};
+
+/// A read only memory mapping of a flat file
+class FlatNav : boost::noncopyable {
+public:
+    /// Maps the file, throws data::data_loading_error if it is not a valid flat file
+    explicit FlatNav(const std::string& filename);
+    ~FlatNav();
+
+    uint32_t data_version() const { return header().data_version; }
+    uint64_t nav_id() const { return header().nav_id; }
+    bool has_section(const std::string& name) const { return sections.count(name) > 0; }
+
+    /// The items of a section, directly in the mapped memory.
+    /// Returns an empty range if the section does not exist
+    template <typename T>
+    boost::iterator_range<const T*> section(const std::string& name) const {
+        static_assert(std::is_trivially_copyable<T>::value, "flat sections can only contain trivially copyable items");
+        const auto it = sections.find(name);
+        if (it == sections.end()) {
+            return {nullptr, nullptr};
+        }
+        if (it->second->item_size != sizeof(T)) {
+            throw navitia::data::data_loading_error("flat section " + name + " does not have the expected item size");
+        }
+        const T* begin = reinterpret_cast<const T*>(mapping + it->second->offset);
+        return {begin, begin + it->second->nb_items};
+    }
+
+private:
+    const char* mapping = nullptr;
+    size_t mapping_size = 0;
+    std::map<std::string, const FlatNavSection*> sections;
+
+    const FlatNavHeader& header() const { return *reinterpret_cast<const FlatNavHeader*>(mapping); }
+};
+
+/// The flat file written alongside the given .nav file
+std::string flat_nav_filename(const std::string& nav_filename);
+
+}  // namespace type
+}  // namespace navitia
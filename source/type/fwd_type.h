@@ -46,6 +46,13 @@ using AdminRtree = class RTree<Admin*, double, 2, double, 8, 4>;
 namespace fare {
 struct Fare;
 }
+namespace autocomplete {
+struct AutocompleteFilters;
+}
+namespace ptref {
+struct PtrefCache;
+class RelationIndex;
+}  // namespace ptref
 namespace routing {
 struct dataRAPTOR;
 struct JourneyPattern;
@@ -53,6 +60,7 @@ struct JourneyPatternPoint;
 }  // namespace routing
 namespace type {
 struct MetaData;
+class FlatNav;
 
 struct GeographicalCoord;
 struct Line;
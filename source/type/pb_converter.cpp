@@ -33,7 +33,9 @@ www.navitia.io
 #include "georef/street_network.h"
 #include "utils/exception.h"
 #include "utils/exception.h"
+#include <algorithm>
 #include <functional>
+#include <limits>
 #include <boost/lexical_cast.hpp>
 #include <boost/date_time/date_defs.hpp>
 #include <boost/geometry/algorithms/length.hpp>
@@ -478,6 +480,97 @@ template void PbCreator::Filler::fill_pb_object<nt::StopArea>(const nt::StopArea
 template void PbCreator::Filler::fill_pb_object<nt::StopPoint>(const nt::StopPoint*, pbnavitia::PtObject*);
 template void PbCreator::Filler::fill_pb_object<nt::VehicleJourney>(const nt::VehicleJourney*, pbnavitia::PtObject*);
 
+// ptime are not totally ordered because of not_a_date_time, it can't be used as is in the fill memo key
+static int64_t to_memo_key(const pt::ptime& t) {
+    if (t.is_not_a_date_time()) {
+        return std::numeric_limits<int64_t>::min();
+    }
+    if (t.is_neg_infinity()) {
+        return std::numeric_limits<int64_t>::min() + 1;
+    }
+    if (t.is_pos_infinity()) {
+        return std::numeric_limits<int64_t>::max();
+    }
+    return (t - pt::ptime(boost::gregorian::date(1970, 1, 1))).total_microseconds();
+}
+
+// Whether the messages of the subtree filled at this depth can depend on the action period, ie whether one of its
+// objects has impacts. It may be conservative, it is then only memoized by action period.
+static bool has_period_dependent_messages(const nt::StopArea* sa, int) {
+    return sa->has_impacts();
+}
+
+static bool has_period_dependent_messages(const nt::StopPoint* sp, int depth) {
+    return sp->has_impacts() || (depth > 0 && sp->stop_area != nullptr && sp->stop_area->has_impacts());
+}
+
+static bool has_period_dependent_messages(const nt::Route* r, int depth);
+
+static bool has_period_dependent_messages(const nt::Line* l, int depth) {
+    if (l->has_impacts()) {
+        return true;
+    }
+    if (depth <= 0) {
+        return false;
+    }
+    // the lines of the line groups are not worth the walk
+    if (!l->line_group_list.empty() || (l->network != nullptr && l->network->has_impacts())) {
+        return true;
+    }
+    return std::any_of(l->route_list.begin(), l->route_list.end(),
+                       [&](const nt::Route* r) { return has_period_dependent_messages(r, depth - 1); });
+}
+
+static bool has_period_dependent_messages(const nt::Route* r, int depth) {
+    if (r->has_impacts() || (r->destination != nullptr && r->destination->has_impacts())) {
+        return true;
+    }
+    if (depth <= 0) {
+        return false;
+    }
+    // from there, the stop points of the thermometer are filled
+    if (depth > 2) {
+        return true;
+    }
+    return r->line != nullptr && has_period_dependent_messages(r->line, depth - 1);
+}
+
+template <typename NAV, typename PB>
+void PbCreator::Filler::fill_memoized(const NAV* nav_object, PB* pb_object) {
+    auto& memo = pb_creator.fill_memo;
+    const bool by_period =
+        dump_message_options.dump_message == DumpMessage::Yes && has_period_dependent_messages(nav_object, depth);
+    const auto& action_period = pb_creator.action_period;
+    const FillMemoKey key{get_pb_type<NAV>(),
+                          nav_object->idx,
+                          depth,
+                          dump_message_options.dump_message,
+                          dump_message_options.dump_line_section,
+                          by_period,
+                          by_period ? to_memo_key(action_period.begin()) : 0,
+                          by_period ? to_memo_key(action_period.last()) : 0};
+    // the side effects of the fill (contributors and impacts to dump) are kept until get_response, which also
+    // clears the memo
+    auto it = memo.find(key);
+    if (it == memo.end()) {
+        // most objects are in the response only once, they are not copied
+        fill_new_pb_object(nav_object, pb_object);
+        memo.emplace(key, nullptr);
+        ++pb_creator.fill_stats.nb_memo_misses;
+        return;
+    }
+    if (it->second == nullptr) {
+        // the target may not be empty, the fill is kept apart to be copied as is
+        auto filled = std::make_unique<PB>();
+        fill_new_pb_object(nav_object, filled.get());
+        it->second = std::move(filled);
+        ++pb_creator.fill_stats.nb_memo_misses;
+    } else {
+        ++pb_creator.fill_stats.nb_memo_hits;
+    }
+    pb_object->MergeFrom(static_cast<const PB&>(*it->second));
+}
+
 PbCreator::Filler PbCreator::Filler::copy(int depth, const DumpMessageOptions& dump_message_options) {
     if (depth <= 0) {
         return PbCreator::Filler(0, dump_message_options, pb_creator);
@@ -504,6 +597,10 @@ void PbCreator::Filler::fill_pb_object(const nt::Dataset* ds, pbnavitia::Dataset
 }
 
 void PbCreator::Filler::fill_pb_object(const nt::StopArea* sa, pbnavitia::StopArea* stop_area) {
+    fill_memoized(sa, stop_area);
+}
+
+void PbCreator::Filler::fill_new_pb_object(const nt::StopArea* sa, pbnavitia::StopArea* stop_area) {
     stop_area->set_uri(sa->uri);
     add_contributor(sa);
     stop_area->set_name(sa->name);
@@ -548,7 +645,8 @@ void PbCreator::Filler::fill_pb_object(const ng::Admin* adm, pbnavitia::Administ
     if (depth > 1) {
         // for the admin we add the main stop area, but with the minimum vital information
         auto minimum_filler = Filler(0, {DumpMessage::No, DumpLineSectionMessage::No}, pb_creator);
-        for (const auto& sa : adm->main_stop_areas) {
+        for (const auto sa_idx : adm->main_stop_areas) {
+            const auto* sa = pb_creator.data->pt_data->stop_areas[sa_idx];
             auto* pb_sa = admin->add_main_stop_areas();
 
             minimum_filler.fill_pb_object(sa, pb_sa);
@@ -561,6 +659,10 @@ void PbCreator::Filler::fill_pb_object(const ng::Admin* adm, pbnavitia::Administ
 }
 
 void PbCreator::Filler::fill_pb_object(const nt::StopPoint* sp, pbnavitia::StopPoint* stop_point) {
+    fill_memoized(sp, stop_point);
+}
+
+void PbCreator::Filler::fill_new_pb_object(const nt::StopPoint* sp, pbnavitia::StopPoint* stop_point) {
     stop_point->set_uri(sp->uri);
     add_contributor(sp);
     stop_point->set_name(sp->name);
@@ -663,6 +765,10 @@ void PbCreator::Filler::fill_pb_object(const nt::CommercialMode* m, pbnavitia::C
 }
 
 void PbCreator::Filler::fill_pb_object(const nt::Line* l, pbnavitia::Line* line) {
+    fill_memoized(l, line);
+}
+
+void PbCreator::Filler::fill_new_pb_object(const nt::Line* l, pbnavitia::Line* line) {
     fill_comments(l, line);
 
     if (!l->code.empty()) {
@@ -729,6 +835,10 @@ void PbCreator::Filler::fill_pb_object(const nt::Line* l, pbnavitia::Line* line)
 }
 
 void PbCreator::Filler::fill_pb_object(const nt::Route* r, pbnavitia::Route* route) {
+    fill_memoized(r, route);
+}
+
+void PbCreator::Filler::fill_new_pb_object(const nt::Route* r, pbnavitia::Route* route) {
     route->set_name(r->name);
     route->set_direction_type(r->direction_type);
 
@@ -1622,7 +1732,8 @@ void PbCreator::Filler::fill_pb_object(const nt::Contributor* c, pbnavitia::Feed
 
 template <typename N>
 void PbCreator::pb_fill(const std::vector<N*>& nav_list, int depth, const DumpMessageOptions& dump_message_options) {
-    auto* pb_object = get_mutable<typename std::remove_cv<N>::type>(response);
+    FillTimer timer(fill_stats);
+    auto* pb_object = get_mutable<typename std::remove_cv<N>::type>(*response);
     Filler(depth, dump_message_options, *this).fill_pb_object(nav_list, pb_object);
 }
 
@@ -1696,7 +1807,7 @@ void PbCreator::fill_co2_emission(pbnavitia::Section* pb_section, const type::Ve
 void PbCreator::fill_fare_section(pbnavitia::Journey* pb_journey, const fare::results& fare) {
     auto pb_fare = pb_journey->mutable_fare();
 
-    size_t cpt_ticket = response.tickets_size();
+    size_t cpt_ticket = response->tickets_size();
 
     boost::optional<std::string> currency;
     for (const fare::Ticket& ticket : fare.tickets) {
@@ -1712,7 +1823,7 @@ void PbCreator::fill_fare_section(pbnavitia::Journey* pb_journey, const fare::re
         pbnavitia::Ticket* pb_ticket = nullptr;
         if (ticket.is_default_ticket()) {
             if (!unknown_ticket) {
-                pb_ticket = response.add_tickets();
+                pb_ticket = response->add_tickets();
                 pb_ticket->set_name(ticket.caption);
                 pb_ticket->set_found(false);
                 pb_ticket->set_id("unknown_ticket");
@@ -1724,7 +1835,7 @@ void PbCreator::fill_fare_section(pbnavitia::Journey* pb_journey, const fare::re
                 pb_ticket = unknown_ticket;
             }
         } else {
-            pb_ticket = response.add_tickets();
+            pb_ticket = response->add_tickets();
 
             pb_ticket->set_name(ticket.caption);
             pb_ticket->set_found(true);
@@ -1848,22 +1959,22 @@ const ng::POI* PbCreator::get_nearest_parking(const nt::GeographicalCoord& coord
 }
 
 pbnavitia::RouteSchedule* PbCreator::add_route_schedules() {
-    return response.add_route_schedules();
+    return response->add_route_schedules();
 }
 
 pbnavitia::StopSchedule* PbCreator::add_stop_schedules() {
-    return response.add_stop_schedules();
+    return response->add_stop_schedules();
 }
 
 int PbCreator::route_schedules_size() {
-    return response.route_schedules_size();
+    return response->route_schedules_size();
 }
 pbnavitia::Passage* PbCreator::add_next_departures() {
-    return response.add_next_departures();
+    return response->add_next_departures();
 }
 
 pbnavitia::Passage* PbCreator::add_next_arrivals() {
-    return response.add_next_arrivals();
+    return response->add_next_arrivals();
 }
 
 pbnavitia::Section* PbCreator::create_section(pbnavitia::Journey* pb_journey,
@@ -2051,21 +2162,54 @@ void PbCreator::fill_pb_error(const pbnavitia::Error::error_id id,
                               const pbnavitia::ResponseType& resp_type,
                               const std::string& message) {
     fill_pb_error(id, message);
-    response.set_response_type(resp_type);
+    response->set_response_type(resp_type);
 }
 
 void PbCreator::fill_pb_error(const pbnavitia::Error::error_id id, const std::string& message) {
-    pbnavitia::Error* error = response.mutable_error();
+    pbnavitia::Error* error = response->mutable_error();
     error->set_id(id);
     error->set_message(message);
 }
 
+#ifdef NAVITIA_PB_CREATOR_ARENA
+google::protobuf::ArenaOptions PbCreator::make_arena_options() const {
+    google::protobuf::ArenaOptions options;
+    options.initial_block = arena_initial_block.get();
+    options.initial_block_size = arena_initial_block_size;
+    // big responses (journeys, schedules) need a lot of blocks, we don't want them to be too small
+    options.start_block_size = 64 * 1024;
+    options.max_block_size = 1024 * 1024;
+    return options;
+}
+
+pbnavitia::Response* PbCreator::make_response() {
+    return google::protobuf::Arena::CreateMessage<pbnavitia::Response>(&arena);
+}
+
+void PbCreator::reset_response() {
+    response = nullptr;
+    arena.Reset();
+    response = make_response();
+}
+#else
+pbnavitia::Response* PbCreator::make_response() {
+    return &owned_response;
+}
+
+void PbCreator::reset_response() {
+    owned_response.Clear();
+}
+#endif
+
 const pbnavitia::Response& PbCreator::get_response() {
-    Filler(0, {DumpMessage::No}, *this).fill_pb_object(contributors, response.mutable_feed_publishers());
+    FillTimer timer(fill_stats);
+    Filler(0, {DumpMessage::No}, *this).fill_pb_object(contributors, response->mutable_feed_publishers());
     contributors.clear();
-    Filler(0, {DumpMessage::No}, *this).fill_pb_object(impacts, response.mutable_impacts());
+    Filler(0, {DumpMessage::No}, *this).fill_pb_object(impacts, response->mutable_impacts());
     impacts.clear();
-    return response;
+    // the memoized objects would not register their contributors and impacts again
+    fill_memo.clear();
+    return *response;
 }
 
 void PbCreator::fill_additional_informations(google::protobuf::RepeatedField<int>* infos,
@@ -2103,82 +2247,82 @@ pbnavitia::GeographicalCoord PbCreator::get_coord(const pbnavitia::PtObject& pt_
 }
 
 pbnavitia::PtObject* PbCreator::add_places_nearby() {
-    return response.add_places_nearby();
+    return response->add_places_nearby();
 }
 
 pbnavitia::PtObject* PbCreator::add_places() {
-    return response.add_places();
+    return response->add_places();
 }
 
 pbnavitia::TrafficReports* PbCreator::add_traffic_reports() {
-    return response.add_traffic_reports();
+    return response->add_traffic_reports();
 }
 
 pbnavitia::LineReport* PbCreator::add_line_reports() {
-    return response.add_line_reports();
+    return response->add_line_reports();
 }
 
 pbnavitia::NearestStopPoint* PbCreator::add_nearest_stop_points() {
-    return response.add_nearest_stop_points();
+    return response->add_nearest_stop_points();
 }
 
 pbnavitia::JourneyPattern* PbCreator::add_journey_patterns() {
-    return response.add_journey_patterns();
+    return response->add_journey_patterns();
 }
 
 pbnavitia::JourneyPatternPoint* PbCreator::add_journey_pattern_points() {
-    return response.add_journey_pattern_points();
+    return response->add_journey_pattern_points();
 }
 
 pbnavitia::Trip* PbCreator::add_trips() {
-    return response.add_trips();
+    return response->add_trips();
 }
 
 pbnavitia::Impact* PbCreator::add_impacts() {
-    return response.add_impacts();
+    return response->add_impacts();
 }
 
 pbnavitia::RoutePoint* PbCreator::add_route_points() {
-    return response.add_route_points();
+    return response->add_route_points();
 }
 
 pbnavitia::Journey* PbCreator::add_journeys() {
-    return response.add_journeys();
+    return response->add_journeys();
 }
 
 pbnavitia::GraphicalIsochrone* PbCreator::add_graphical_isochrones() {
-    return response.add_graphical_isochrones();
+    return response->add_graphical_isochrones();
 }
 
 pbnavitia::HeatMap* PbCreator::add_heat_maps() {
-    return response.add_heat_maps();
+    return response->add_heat_maps();
 }
 
 pbnavitia::EquipmentReport* PbCreator::add_equipment_reports() {
-    return response.add_equipment_reports();
+    return response->add_equipment_reports();
 }
 
 bool PbCreator::has_error() {
-    return response.has_error();
+    return response->has_error();
 }
 
 bool PbCreator::has_response_type(const pbnavitia::ResponseType& resp_type) {
-    return resp_type == response.response_type();
+    return resp_type == response->response_type();
 }
 
 void PbCreator::set_response_type(const pbnavitia::ResponseType& resp_type) {
-    response.set_response_type(resp_type);
+    response->set_response_type(resp_type);
 }
 
 ::google::protobuf::RepeatedPtrField<pbnavitia::PtObject>* PbCreator::get_mutable_places() {
-    return response.mutable_places();
+    return response->mutable_places();
 }
 
 void PbCreator::make_paginate(const int total_result,
                               const int start_page,
                               const int items_per_page,
                               const int items_on_page) {
-    auto pagination = response.mutable_pagination();
+    auto pagination = response->mutable_pagination();
     pagination->set_totalresult(total_result);
     pagination->set_startpage(start_page);
     pagination->set_itemsperpage(items_per_page);
@@ -2186,31 +2330,31 @@ void PbCreator::make_paginate(const int total_result,
 }
 
 int PbCreator::departure_boards_size() {
-    return response.departure_boards_size();
+    return response->departure_boards_size();
 }
 
 int PbCreator::stop_schedules_size() {
-    return response.stop_schedules_size();
+    return response->stop_schedules_size();
 }
 
 int PbCreator::traffic_reports_size() {
-    return response.traffic_reports_size();
+    return response->traffic_reports_size();
 }
 
 int PbCreator::line_reports_size() {
-    return response.line_reports_size();
+    return response->line_reports_size();
 }
 
 int PbCreator::calendars_size() {
-    return response.calendars_size();
+    return response->calendars_size();
 }
 
 int PbCreator::equipment_reports_size() {
-    return response.equipment_reports_size();
+    return response->equipment_reports_size();
 }
 
 void PbCreator::sort_journeys() {
-    std::sort(response.mutable_journeys()->begin(), response.mutable_journeys()->end(),
+    std::sort(response->mutable_journeys()->begin(), response->mutable_journeys()->end(),
               [](const pbnavitia::Journey& journey1, const pbnavitia::Journey& journey2) {
                   auto duration1 = journey1.duration(), duration2 = journey2.duration();
                   if (duration1 != duration2) {
@@ -2221,7 +2365,7 @@ void PbCreator::sort_journeys() {
 }
 
 bool PbCreator::empty_journeys() {
-    return (response.journeys().size() == 0);
+    return (response->journeys().size() == 0);
 }
 
 void fill_pb_error(const pbnavitia::Error::error_id id,
@@ -2235,27 +2379,27 @@ void fill_pb_error(const pbnavitia::Error::error_id id,
 }
 
 pbnavitia::GeoStatus* PbCreator::mutable_geo_status() {
-    return response.mutable_geo_status();
+    return response->mutable_geo_status();
 }
 
 pbnavitia::Status* PbCreator::mutable_status() {
-    return response.mutable_status();
+    return response->mutable_status();
 }
 
 pbnavitia::Pagination* PbCreator::mutable_pagination() {
-    return response.mutable_pagination();
+    return response->mutable_pagination();
 }
 
 pbnavitia::Co2Emission* PbCreator::mutable_car_co2_emission() {
-    return response.mutable_car_co2_emission();
+    return response->mutable_car_co2_emission();
 }
 
 pbnavitia::StreetNetworkRoutingMatrix* PbCreator::mutable_sn_routing_matrix() {
-    return response.mutable_sn_routing_matrix();
+    return response->mutable_sn_routing_matrix();
 }
 
 pbnavitia::Metadatas* PbCreator::mutable_metadatas() {
-    return response.mutable_metadatas();
+    return response->mutable_metadatas();
 }
 
 void PbCreator::clear_feed_publishers() {
@@ -2263,15 +2407,15 @@ void PbCreator::clear_feed_publishers() {
 }
 
 pbnavitia::FeedPublisher* PbCreator::add_feed_publishers() {
-    return response.add_feed_publishers();
+    return response->add_feed_publishers();
 }
 
 void PbCreator::set_publication_date(pt::ptime ptime) {
-    response.set_publication_date(navitia::to_posix_timestamp(ptime));
+    response->set_publication_date(navitia::to_posix_timestamp(ptime));
 }
 
 void PbCreator::set_next_request_date_time(uint32_t next_request_date_time) {
-    response.set_next_request_date_time(next_request_date_time);
+    response->set_next_request_date_time(next_request_date_time);
 }
 
 }  // namespace navitia
@@ -37,6 +37,18 @@ www.navitia.io
 #include "ptreferential/ptreferential.h"
 #include "utils/logger.h"
 
+#include <chrono>
+#include <map>
+#include <memory>
+#include <tuple>
+
+#include <google/protobuf/stubs/common.h>
+// the arenas are enabled for all the messages since protobuf 3.14, before that they need the cc_enable_arenas option
+#if GOOGLE_PROTOBUF_VERSION >= 3014000
+#include <google/protobuf/arena.h>
+#define NAVITIA_PB_CREATOR_ARENA
+#endif
+
 namespace pt = boost::posix_time;
 namespace nt = navitia::type;
 namespace ng = navitia::georef;
@@ -187,6 +199,13 @@ inline pbnavitia::NavitiaType get_embedded_type(const nt::MetaVehicleJourney*) {
     return pbnavitia::TRIP;
 }
 
+// time spent in the fillers of a response, and use of its fill memo
+struct PbFillStats {
+    double fill_duration = 0;  // in seconds
+    size_t nb_memo_hits = 0;
+    size_t nb_memo_misses = 0;
+};
+
 struct PbCreator {
     std::set<const nt::Contributor*, Less> contributors;
     std::set<boost::shared_ptr<type::disruption::Impact>, Less> impacts;
@@ -235,8 +254,10 @@ struct PbCreator {
         this->contributors.clear();
         this->impacts.clear();
         this->routing_section_map.clear();
-        this->response.Clear();
+        this->reset_response();
         this->unknown_ticket = nullptr;
+        this->fill_memo.clear();
+        this->fill_stats = PbFillStats();
     }
 
     PbCreator(const PbCreator&) = delete;
@@ -247,12 +268,14 @@ struct PbCreator {
               P* proto,
               int depth,
               const DumpMessageOptions& dump_message_options = DumpMessageOptions{}) {
+        FillTimer timer(fill_stats);
         Filler(depth, dump_message_options, *this).fill_pb_object(item, proto);
     }
 
     template <typename N>
     void fill(const N& item, int depth, const DumpMessageOptions& dump_message_options = DumpMessageOptions{}) {
-        Filler(depth, dump_message_options, *this).fill_pb_object(item, &response);
+        FillTimer timer(fill_stats);
+        Filler(depth, dump_message_options, *this).fill_pb_object(item, response);
     }
 
     template <typename N>
@@ -262,6 +285,7 @@ struct PbCreator {
 
     template <typename P>
     void fill_message(const boost::shared_ptr<nt::disruption::Impact>& impact, P pb_object, int depth) {
+        FillTimer timer(fill_stats);
         Filler(depth, DumpMessageOptions{}, *this).fill_message(impact, pb_object);
     }
 
@@ -299,6 +323,7 @@ struct PbCreator {
     void fill_pb_error(const pbnavitia::Error::error_id, const std::string&);
     const pbnavitia::Response& get_response();
     void clear_feed_publishers();
+    const PbFillStats& get_fill_stats() const { return fill_stats; }
 
     pbnavitia::PtObject* add_places_nearby();
     pbnavitia::Journey* add_journeys();
@@ -344,7 +369,38 @@ struct PbCreator {
     void set_next_request_date_time(uint32_t next_request_date_time);
 
 private:
-    pbnavitia::Response response;
+#ifdef NAVITIA_PB_CREATOR_ARENA
+    // The responses are built on an arena: their messages are released at once between two requests and the first
+    // block of the arena is reused by the next response
+    static const size_t arena_initial_block_size = 256 * 1024;
+    std::unique_ptr<char[]> arena_initial_block{new char[arena_initial_block_size]};
+    google::protobuf::Arena arena{make_arena_options()};
+    google::protobuf::ArenaOptions make_arena_options() const;
+#else
+    pbnavitia::Response owned_response;
+#endif
+    pbnavitia::Response* response = make_response();
+    pbnavitia::Response* make_response();
+    void reset_response();
+
+    // The objects with a big subtree already filled in the response, by type, idx, depth, dump options and, only
+    // when their subtree has impacts, action period (it selects their messages). An object is filled in place the
+    // first time and only marked as seen with a null entry, the second fill is kept, the next occurrences are copied.
+    using FillMemoKey = std::
+        tuple<pbnavitia::NavitiaType, nt::idx_t, int, DumpMessage, DumpLineSectionMessage, bool, int64_t, int64_t>;
+    std::map<FillMemoKey, std::unique_ptr<google::protobuf::Message>> fill_memo;
+    PbFillStats fill_stats;
+
+    struct FillTimer {
+        PbFillStats& stats;
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        explicit FillTimer(PbFillStats& stats) : stats(stats) {}
+        ~FillTimer() {
+            const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+            stats.fill_duration += duration.count();
+        }
+    };
+
     struct Filler {
         struct PtObjVisitor;
         const int depth;
@@ -358,6 +414,9 @@ private:
 
         template <typename NAV, typename PB>
         void fill(NAV* nav_object, PB* pb_object);
+        // fills with fill_new_pb_object the first two times, copies from the fill memo of the PbCreator afterward
+        template <typename NAV, typename PB>
+        void fill_memoized(const NAV* nav_object, PB* pb_object);
         template <typename NAV, typename F>
         void fill_with_creator(NAV* nav_object, F creator);
 
@@ -463,13 +522,17 @@ private:
         void fill_pb_object(const nt::Contributor*, pbnavitia::Contributor*);
         void fill_pb_object(const nt::Dataset*, pbnavitia::Dataset*);
         void fill_pb_object(const nt::StopArea*, pbnavitia::StopArea*);
+        void fill_new_pb_object(const nt::StopArea*, pbnavitia::StopArea*);
         void fill_pb_object(const nt::StopPoint*, pbnavitia::StopPoint*);
+        void fill_new_pb_object(const nt::StopPoint*, pbnavitia::StopPoint*);
         void fill_pb_object(const nt::Company*, pbnavitia::Company*);
         void fill_pb_object(const nt::Network*, pbnavitia::Network*);
         void fill_pb_object(const nt::PhysicalMode*, pbnavitia::PhysicalMode*);
         void fill_pb_object(const nt::CommercialMode*, pbnavitia::CommercialMode*);
         void fill_pb_object(const nt::Line*, pbnavitia::Line*);
+        void fill_new_pb_object(const nt::Line*, pbnavitia::Line*);
         void fill_pb_object(const nt::Route*, pbnavitia::Route*);
+        void fill_new_pb_object(const nt::Route*, pbnavitia::Route*);
         void fill_pb_object(const nt::LineGroup*, pbnavitia::LineGroup*);
         void fill_pb_object(const nt::Calendar*, pbnavitia::Calendar*);
         void fill_pb_object(const nt::ValidityPattern*, pbnavitia::ValidityPattern*);
@@ -118,7 +118,7 @@ struct PT_Data : boost::noncopyable {
     void build_autocomplete(const navitia::georef::GeoRef&);
 
     /** Calcul le score des objectTC */
-    void compute_score_autocomplete(navitia::georef::GeoRef&);
+    void compute_score_autocomplete(navitia::georef::GeoRef&, bool with_geo_ref_scores = true);
 
     /** Construit l'indexe ProximityList */
     void build_proximity_list();
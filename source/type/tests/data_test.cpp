@@ -42,6 +42,8 @@ www.navitia.io
 
 // Data to test
 #include "type/data.h"
+#include "type/flat_nav.h"
+#include "type/meta_data.h"
 
 using namespace navitia;
 
@@ -87,3 +89,78 @@ BOOST_AUTO_TEST_CASE(load_disruptions_fail) {
     }
     BOOST_CHECK_EQUAL(failed, true);
 }
+
+BOOST_AUTO_TEST_CASE(flat_nav_sections) {
+    const std::string flat_file = "fake_data.nav.flat";
+    navitia::type::FlatNavWriter writer(42, 1234);
+    const std::vector<float> coords = {1.f, 2.f, 3.f, 4.f, 5.f, 6.f};
+    const std::vector<uint32_t> indexes = {7, 8, 9};
+    writer.add_section("coords", coords);
+    writer.add_section("indexes", indexes);
+    writer.save(flat_file);
+
+    navitia::type::FlatNav flat(flat_file);
+    BOOST_CHECK_EQUAL(flat.data_version(), 42);
+    BOOST_CHECK_EQUAL(flat.nav_id(), 1234);
+    BOOST_CHECK(flat.has_section("coords"));
+    const auto mapped_coords = flat.section<float>("coords");
+    BOOST_CHECK_EQUAL_COLLECTIONS(mapped_coords.begin(), mapped_coords.end(), coords.begin(), coords.end());
+    const auto mapped_indexes = flat.section<uint32_t>("indexes");
+    BOOST_CHECK_EQUAL_COLLECTIONS(mapped_indexes.begin(), mapped_indexes.end(), indexes.begin(), indexes.end());
+    // sections are aligned
+    BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(mapped_indexes.begin()) % 8, 0);
+
+    BOOST_CHECK(!flat.has_section("unknown"));
+    BOOST_CHECK(flat.section<float>("unknown").empty());
+    BOOST_CHECK_THROW(flat.section<double>("coords"), navitia::data::data_loading_error);
+
+    boost::filesystem::remove(flat_file);
+    BOOST_CHECK_THROW(navitia::type::FlatNav("wrong_path"), navitia::data::data_loading_error);
+}
+
+BOOST_AUTO_TEST_CASE(flat_nav_rewritten_while_mapped) {
+    const std::string flat_file = "fake_data.nav.flat";
+    const std::vector<float> coords = {1.f, 2.f, 3.f, 4.f, 5.f, 6.f};
+    navitia::type::FlatNavWriter writer(42, 1234);
+    writer.add_section("coords", coords);
+    writer.save(flat_file);
+    navitia::type::FlatNav flat(flat_file);
+
+    // a new data update writes a shorter file at the same place, as ed2nav does on the live target
+    const std::vector<float> new_coords = {7.f};
+    navitia::type::FlatNavWriter new_writer(42, 5678);
+    new_writer.add_section("coords", new_coords);
+    new_writer.save(flat_file);
+    BOOST_CHECK(!boost::filesystem::exists(flat_file + ".tmp"));
+
+    // the opened file is untouched
+    BOOST_CHECK_EQUAL(flat.nav_id(), 1234);
+    const auto mapped_coords = flat.section<float>("coords");
+    BOOST_CHECK_EQUAL_COLLECTIONS(mapped_coords.begin(), mapped_coords.end(), coords.begin(), coords.end());
+
+    navitia::type::FlatNav new_flat(flat_file);
+    BOOST_CHECK_EQUAL(new_flat.nav_id(), 5678);
+    const auto new_mapped_coords = new_flat.section<float>("coords");
+    BOOST_CHECK_EQUAL_COLLECTIONS(new_mapped_coords.begin(), new_mapped_coords.end(), new_coords.begin(),
+                                  new_coords.end());
+
+    boost::filesystem::remove(flat_file);
+}
+
+BOOST_AUTO_TEST_CASE(flat_nav_must_match_the_data) {
+    const std::string flat_file = "fake_data.nav.flat";
+    BOOST_CHECK_EQUAL(navitia::type::flat_nav_filename(fake_data_file), flat_file);
+
+    navitia::type::Data data(0);
+    data.meta->publication_date = boost::posix_time::from_iso_string("20190101T120000");
+    data.save_flat(flat_file);
+    data.load_flat(flat_file);
+    BOOST_CHECK(data.flat_nav);
+
+    // another publication of the data, the flat file is outdated
+    data.meta->publication_date = boost::posix_time::from_iso_string("20190102T120000");
+    data.load_flat(flat_file);
+    BOOST_CHECK(!data.flat_nav);
+
+    boost::filesystem::remove(flat_file);
+}
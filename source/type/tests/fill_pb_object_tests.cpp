@@ -277,3 +277,77 @@ BOOST_AUTO_TEST_CASE(fill_crowfly_section_test) {
     BOOST_CHECK_EQUAL(pt_journey->sections(0).street_network().duration(), 0);
     BOOST_CHECK_EQUAL(pt_journey->sections(0).street_network().mode(), pbnavitia::Walking);
 }
+
+BOOST_AUTO_TEST_CASE(pb_creator_response_reset_between_requests) {
+    ed::builder b("20120614");
+    b.sa("stop_area:A");
+    b.make();
+    auto* data_ptr = b.data.get();
+
+    navitia::PbCreator pb_creator(data_ptr, pt::not_a_date_time, null_time_period);
+    for (int i = 0; i < 3; ++i) {
+        pb_creator.init(data_ptr, pt::not_a_date_time, null_time_period);
+        BOOST_CHECK_EQUAL(pb_creator.get_response().places_size(), 0);
+        BOOST_CHECK(!pb_creator.has_error());
+
+        pb_creator.fill(b.data->pt_data->stop_areas.front(), pb_creator.add_places(), 1);
+        const auto& resp = pb_creator.get_response();
+        BOOST_REQUIRE_EQUAL(resp.places_size(), 1);
+        BOOST_CHECK_EQUAL(resp.places(0).uri(), "stop_area:A");
+        BOOST_CHECK_EQUAL(resp.places(0).stop_area().uri(), "stop_area:A");
+
+        // the response built on the arena can be copied and serialized as any message
+        const pbnavitia::Response copy = resp;
+        BOOST_CHECK_EQUAL(copy.ByteSize(), resp.ByteSize());
+        std::string serialized;
+        BOOST_REQUIRE(resp.SerializeToString(&serialized));
+        pbnavitia::Response parsed;
+        BOOST_REQUIRE(parsed.ParseFromString(serialized));
+        BOOST_CHECK_EQUAL(parsed.places(0).uri(), "stop_area:A");
+    }
+}
+
+BOOST_AUTO_TEST_CASE(pb_creator_fill_memo) {
+    ed::builder b("20120614");
+    b.vj("A")("stop1", 8000, 8050)("stop2", 8200, 8250);
+    b.vj("B")("stop1", 9000, 9050)("stop3", 9200, 9250);
+    b.make();
+    auto* data_ptr = b.data.get();
+    const nt::StopArea* sa = b.sas.find("stop1")->second;
+
+    navitia::PbCreator pb_creator(data_ptr, pt::not_a_date_time, null_time_period);
+    pbnavitia::StopArea first, second, third, other_depth;
+    pb_creator.fill(sa, &first, 2);
+    pb_creator.fill(sa, &second, 2);
+    // without impacts, the action period does not matter
+    pb_creator.action_period = pt::time_period("20120614T080000"_dt, "20120614T090000"_dt);
+    pb_creator.fill(sa, &third, 2);
+    pb_creator.fill(sa, &other_depth, 0);
+
+    // the first two fills are done in place, the third one is copied from the second one
+    BOOST_CHECK_EQUAL(first.SerializeAsString(), second.SerializeAsString());
+    BOOST_CHECK_EQUAL(first.SerializeAsString(), third.SerializeAsString());
+    BOOST_CHECK_EQUAL(third.uri(), "stop1");
+    BOOST_CHECK(!third.physical_modes().empty());
+    BOOST_CHECK_EQUAL(other_depth.physical_modes().size(), 0);
+    BOOST_CHECK_EQUAL(pb_creator.get_fill_stats().nb_memo_hits, 1);
+    BOOST_CHECK_EQUAL(pb_creator.get_fill_stats().nb_memo_misses, 3);
+
+    // the stop points of a route filled at depth 3 are also memoized
+    const auto* route = data_ptr->pt_data->routes.front();
+    pb_creator.fill(route, pb_creator.add_places(), 3);
+    pb_creator.fill(route, pb_creator.add_places(), 3);
+    const auto& resp = pb_creator.get_response();
+    BOOST_REQUIRE_EQUAL(resp.places_size(), 2);
+    BOOST_CHECK_EQUAL(resp.places(0).SerializeAsString(), resp.places(1).SerializeAsString());
+    BOOST_CHECK_EQUAL(resp.places(1).route().stop_points_size(), 2);
+    BOOST_CHECK_GT(pb_creator.get_fill_stats().fill_duration, 0);
+
+    // a new request starts with an empty memo
+    pb_creator.init(data_ptr, pt::not_a_date_time, null_time_period);
+    BOOST_CHECK_EQUAL(pb_creator.get_fill_stats().nb_memo_hits, 0);
+    pbnavitia::StopArea after_init;
+    pb_creator.fill(sa, &after_init, 2);
+    BOOST_CHECK_EQUAL(pb_creator.get_fill_stats().nb_memo_misses, 1);
+    BOOST_CHECK_EQUAL(after_init.SerializeAsString(), first.SerializeAsString());
+}
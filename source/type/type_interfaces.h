@@ -233,6 +233,9 @@ protected:
 public:
     void add_impact(const boost::shared_ptr<disruption::Impact>& i) { impacts.push_back(i); }
 
+    // the expired impacts are counted until clean_weak_impacts
+    bool has_impacts() const { return !impacts.empty(); }
+
     std::vector<boost::shared_ptr<disruption::Impact>> get_applicable_messages(
         const boost::posix_time::ptime& current_time,
         const boost::posix_time::time_period& action_period) const;